@@ -56,6 +56,7 @@ void apInit(void)
     is_update_fw = true;
   }
   logPrintf("\n");
+  bootTimeMark("mode");
 
   if (is_update_fw)
   {
@@ -72,6 +73,7 @@ void apInit(void)
       logPrintf("[OK]\n");
     else
       logPrintf("[E_] err : 0x%04X\n", err_code);    
+    bootTimeMark("update");
   }
 
   if (is_run_fw)
@@ -114,7 +116,7 @@ void apInit(void)
 void apMain(void)
 {
   cmdTaskInit();
-
+  bootTimeMark("ready");
 
   while(1)
   {
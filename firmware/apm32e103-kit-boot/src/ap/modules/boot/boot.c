@@ -354,6 +354,7 @@ uint16_t bootJumpFirm(void)
 
       resetSetBootMode(0);
 
+      bootTimeMarkJump();
       bspDeInit();
 
       (*jump_func)();
@@ -52,6 +52,7 @@ bool cmdTaskUpdate(void)
 
         rx_ret = true;
       }
+      cmdBootUpdate(&cmd[i]);
     }
   }
 
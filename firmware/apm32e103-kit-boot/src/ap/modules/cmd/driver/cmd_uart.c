@@ -13,6 +13,7 @@ static uint32_t available(void *args);
 static bool flush(void *args);
 static uint8_t read(void *args);
 static uint32_t write(void *args, uint8_t *p_data, uint32_t length);  
+static bool ioctl(void *args, uint32_t ctl, void *p_data, uint32_t length);
 
 
 
@@ -29,6 +30,7 @@ bool cmdUartInitDriver(cmd_driver_t *p_driver, uint8_t ch, uint32_t baud)
   p_driver->flush = flush;
   p_driver->read = read;
   p_driver->write= write;
+  p_driver->ioctl= ioctl;
 
   return true;
 }
@@ -74,3 +76,35 @@ uint32_t write(void *args, uint8_t *p_data, uint32_t length)
 
   return uartWrite(p_args->ch, p_data, length);
 }
+
+bool ioctl(void *args, uint32_t ctl, void *p_data, uint32_t length)
+{
+  cmd_uart_args_t *p_args = (cmd_uart_args_t *)args;
+  bool ret = false;
+
+
+  switch(ctl)
+  {
+    case CMD_IOCTL_SET_BAUD:
+      if (p_data == NULL || length < 4)
+        break;
+
+      // 보내던 응답이 모두 나간 다음에 통신 속도를 바꾼다.
+      //
+      uartWaitTxDone(p_args->ch, 100);
+
+      memcpy(&p_args->baud, p_data, 4);
+      ret = uartOpen(p_args->ch, p_args->baud);
+      break;
+
+    case CMD_IOCTL_GET_BAUD:
+      if (p_data == NULL || length < 4)
+        break;
+
+      memcpy(p_data, &p_args->baud, 4);
+      ret = true;
+      break;
+  }
+
+  return ret;
+}
@@ -54,6 +54,7 @@ bool cmdUdpInitDriver(cmd_driver_t *p_driver, const char *ip_addr, uint32_t port
   p_driver->flush     = flush;
   p_driver->read      = read;
   p_driver->write     = write;
+  p_driver->ioctl     = NULL;
 
   if (wiznetIsInit())
     is_init = true;
@@ -18,6 +18,12 @@
 #define BOOT_CMD_FW_JUMP                0x000C
 #define BOOT_CMD_FW_BEGIN               0x000D
 #define BOOT_CMD_FW_END                 0x000E
+#define BOOT_CMD_BOOT_TIME              0x0011
+#define BOOT_CMD_SET_BAUD               0x0013
+
+#define BOOT_BAUD_MIN                   9600
+#define BOOT_BAUD_MAX                   2000000
+#define BOOT_BAUD_CONFIRM_TIME          1000
 
 
 typedef struct
@@ -40,11 +46,22 @@ typedef struct
   uint32_t fw_size;
 } boot_begin_t;
 
+//-- 통신 속도 변경 후 새 속도에서 패킷을 받기 전까지는 확정하지 않는다.
+//
+typedef struct
+{
+  cmd_t   *p_cmd;
+  uint32_t baud_old;
+  uint32_t pre_time;
+} boot_baud_t;
+
 
 static boot_info_t    boot_info;
 static boot_version_t boot_version;
 static boot_begin_t   boot_begin;
 
+static boot_baud_t    boot_baud = {NULL, 0, 0};
+
 static bool is_begin = false;
 static uint32_t fw_receive_size = 0;
 static cmd_boot_info_t cmd_boot_info;
@@ -341,6 +358,35 @@ static void bootFirmEnd(cmd_t *p_cmd)
   cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, NULL, 0);
 }
 
+static void bootTime(cmd_t *p_cmd)
+{
+  uint8_t *p_data = p_cmd->packet.data;
+  uint32_t count;
+  uint32_t length;
+  boot_time_info_t info;
+
+
+  count  = bootTimeGetCount();
+  length = 4;
+  for (uint32_t i=0; i<count; i++)
+  {
+    if (length + sizeof(boot_time_info_t) > CMD_MAX_DATA_LENGTH)
+      break;
+
+    bootTimeGetInfo(i, &info);
+    memcpy(&p_data[length], &info, sizeof(boot_time_info_t));
+    length += sizeof(boot_time_info_t);
+  }
+  count = (length - 4) / sizeof(boot_time_info_t);
+
+  p_data[0] = (count >>  0) & 0xFF;
+  p_data[1] = (count >>  8) & 0xFF;
+  p_data[2] = (count >> 16) & 0xFF;
+  p_data[3] = (count >> 24) & 0xFF;
+
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, CMD_OK, p_data, length);
+}
+
 bool cmdBootInit(void)
 {
   cmd_boot_info.is_begin = false;
@@ -361,11 +407,83 @@ void cmdBootGetInfo(cmd_boot_info_t *p_info)
   *p_info = cmd_boot_info;
 }
 
+static void bootSetBaud(cmd_t *p_cmd)
+{
+  cmd_packet_t *p_packet = &p_cmd->packet;
+  cmd_driver_t *p_driver = p_cmd->p_driver;
+  uint16_t err_code = CMD_OK;
+  uint32_t baud = 0;
+  uint32_t baud_old = 0;
+
+
+  if (p_packet->length == 4)
+  {
+    memcpy(&baud, p_packet->data, 4);
+  }
+
+  if (p_driver->ioctl == NULL || p_driver->ioctl(p_driver->args, CMD_IOCTL_GET_BAUD, &baud_old, 4) != true)
+  {
+    err_code = ERR_BOOT_WRONG_CMD;
+  }
+  else if (baud < BOOT_BAUD_MIN || baud > BOOT_BAUD_MAX)
+  {
+    err_code = ERR_BOOT_WRONG_RANGE;
+  }
+
+  // 응답은 현재 속도로 보내고 전송이 끝나면 속도를 바꾼다.
+  //
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, NULL, 0);
+
+  if (err_code != CMD_OK || baud == baud_old)
+    return;
+
+  if (p_driver->ioctl(p_driver->args, CMD_IOCTL_SET_BAUD, &baud, 4) == true)
+  {
+    boot_baud.p_cmd    = p_cmd;
+    boot_baud.baud_old = baud_old;
+    boot_baud.pre_time = millis();
+  }
+}
+
+static void bootBaudUpdate(cmd_t *p_cmd)
+{
+  cmd_driver_t *p_driver = p_cmd->p_driver;
+
+  if (boot_baud.p_cmd != p_cmd)
+    return;
+
+  // 시간 안에 새 속도로 확인 패킷이 오지 않으면 이전 속도로 되돌린다.
+  //
+  if (millis()-boot_baud.pre_time >= BOOT_BAUD_CONFIRM_TIME)
+  {
+    p_driver->ioctl(p_driver->args, CMD_IOCTL_SET_BAUD, &boot_baud.baud_old, 4);
+    boot_baud.p_cmd = NULL;
+  }
+}
+
+void cmdBootUpdate(cmd_t *p_cmd)
+{
+  bootBaudUpdate(p_cmd);
+}
+
 bool cmdBootProcess(cmd_t *p_cmd)
 {
   bool ret = true;
 
 
+  // 변경한 속도로 패킷을 받았으면 속도 변경을 확정한다.
+  //
+  if (boot_baud.p_cmd == p_cmd)
+  {
+    boot_baud.p_cmd = NULL;
+  }
+
+  if (p_cmd->packet.type == PKT_TYPE_PING)
+  {
+    cmdSendType(p_cmd, PKT_TYPE_PING, NULL, 0);
+    return true;
+  }
+
   switch(p_cmd->packet.cmd)
   {
     case BOOT_CMD_INFO:
@@ -412,6 +530,14 @@ bool cmdBootProcess(cmd_t *p_cmd)
       bootFirmEnd(p_cmd);
       break;
 
+    case BOOT_CMD_BOOT_TIME:
+      bootTime(p_cmd);
+      break;
+
+    case BOOT_CMD_SET_BAUD:
+      bootSetBaud(p_cmd);
+      break;
+
     default:
       ret = false;
       break;  
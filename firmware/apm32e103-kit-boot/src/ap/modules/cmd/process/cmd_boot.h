@@ -16,6 +16,7 @@ typedef struct
 bool cmdBootInit(void);
 bool cmdBootIsBusy(void);
 bool cmdBootProcess(cmd_t *p_cmd);
+void cmdBootUpdate(cmd_t *p_cmd);
 void cmdBootGetInfo(cmd_boot_info_t *p_info);
 
 
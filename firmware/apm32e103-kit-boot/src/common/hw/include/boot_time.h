@@ -0,0 +1,43 @@
+#ifndef BOOT_TIME_H_
+#define BOOT_TIME_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_BOOT_TIME
+
+
+#define BOOT_TIME_MAX           HW_BOOT_TIME_MAX
+#define BOOT_TIME_NAME_MAX      11
+
+#define BOOT_TIME_IMAGE_BOOT    0
+#define BOOT_TIME_IMAGE_FW      1
+
+
+typedef struct
+{
+  char     name[BOOT_TIME_NAME_MAX];
+  uint8_t  image;
+  uint32_t time_us;
+} boot_time_info_t;
+
+
+bool     bootTimeInit(void);
+void     bootTimeMark(const char *p_name);
+void     bootTimeMarkJump(void);
+uint32_t bootTimeGetCycle(void);
+uint32_t bootTimeGetCount(void);
+bool     bootTimeGetInfo(uint32_t index, boot_time_info_t *p_info);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
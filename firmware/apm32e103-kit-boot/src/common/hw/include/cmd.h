@@ -17,6 +17,10 @@
 #define CMD_OK      0x0000
 
 
+#define CMD_IOCTL_SET_BAUD    0x0001    // p_data : uint32_t baud
+#define CMD_IOCTL_GET_BAUD    0x0002    // p_data : uint32_t baud
+
+
 
 typedef enum CmdType
 {
@@ -55,6 +59,7 @@ typedef struct cmd_driver_t_
   bool     (*flush)(void *args);
   uint8_t  (*read)(void *args);
   uint32_t (*write)(void *args, uint8_t *p_data, uint32_t length);  
+  bool     (*ioctl)(void *args, uint32_t ctl, void *p_data, uint32_t length);
 } cmd_driver_t;
 
 
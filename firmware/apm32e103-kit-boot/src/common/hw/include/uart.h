@@ -22,6 +22,7 @@ uint32_t uartAvailable(uint8_t ch);
 bool     uartFlush(uint8_t ch);
 uint8_t  uartRead(uint8_t ch);
 uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length);
+bool     uartWaitTxDone(uint8_t ch, uint32_t timeout);
 uint32_t uartPrintf(uint8_t ch, const char *fmt, ...);
 uint32_t uartVPrintf(uint8_t ch, const char *fmt, va_list arg);
 uint32_t uartGetBaud(uint8_t ch);
@@ -355,6 +355,34 @@ uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
   return ret;
 }
 
+bool uartWaitTxDone(uint8_t ch, uint32_t timeout)
+{
+  uint32_t pre_time;
+
+
+  if (ch >= UART_MAX_CH || uart_tbl[ch].is_open != true) return false;
+
+  switch(ch)
+  {
+    case _DEF_UART1:
+    case _DEF_UART3:
+      // 마지막 바이트가 shift register 에서 나갈때까지 기다린다.
+      //
+      pre_time = millis();
+      while(USART_ReadStatusFlag(uart_tbl[ch].p_hw->p_uart, USART_FLAG_TXC) != SET)
+      {
+        if (millis()-pre_time >= timeout)
+          return false;
+      }
+      break;
+
+    case _DEF_UART2:
+      break;
+  }
+
+  return true;
+}
+
 uint32_t uartPrintf(uint8_t ch, const char *fmt, ...)
 {
   char buf[256];
@@ -19,7 +19,9 @@ volatile const firm_ver_t firm_ver __attribute__((section(".version"))) =
 
 bool hwInit(void)
 {
+  bootTimeInit();
   bspInit();
+  bootTimeMark("bsp");
 
   #ifdef _USE_HW_CLI
   cliInit();
@@ -47,32 +49,45 @@ bool hwInit(void)
 
   logPrintf("\n");
 
+  bootTimeMark("log");
+
   rtcInit();
   resetInit();
   gpioInit();
   buttonInit();
+  bootTimeMark("gpio");
   i2cInit();
   eepromInit();
+  bootTimeMark("eeprom");
   spiInit();
   spiFlashInit();
+  bootTimeMark("spiFlash");
   sdInit();
+  bootTimeMark("sd");
   fatfsInit();
   flashInit();
+  bootTimeMark("fatfs");
 
   usbInit();
   usbBegin(USB_CDC_MODE);
   cdcInit();
+  bootTimeMark("usb");
 
   ws2812Init();
   lcdInit();
   lcdSetFps(20);
+  bootTimeMark("lcd");
   
   eventInit();
   wiznetInit();
+  bootTimeMark("wiznet");
   wiznetDHCP();
+  bootTimeMark("dhcp");
   wiznetSNTP();
+  bootTimeMark("sntp");
 
   loaderInit();
+  bootTimeMark("loader");
 
   return true;
 }
\ No newline at end of file
@@ -39,6 +39,7 @@ extern "C" {
 #include "loader.h"
 #include "reset.h"
 #include "cmd.h"
+#include "boot_time.h"
 #include "util.h"
 #include "qbuffer.h"
 
@@ -95,6 +95,10 @@
 #define _USE_HW_CMD
 #define      HW_CMD_MAX_DATA_LENGTH 2048
 
+#define _USE_HW_BOOT_TIME
+#define      HW_BOOT_TIME_MAX       48
+#define      HW_BOOT_TIME_IMAGE     0     // 0:BOOT, 1:FW
+
 
 #define FLASH_SIZE_TAG              0x400
 #define FLASH_SIZE_VEC              0x400
@@ -124,6 +128,7 @@
 #define _USE_CLI_HW_FLASH           0
 #define _USE_CLI_HW_LOADER          1
 #define _USE_CLI_HW_RESET           1
+#define _USE_CLI_HW_BOOT_TIME       1
 
 
 typedef enum
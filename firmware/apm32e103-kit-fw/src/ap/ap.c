@@ -6,7 +6,17 @@ void updateLED(void);
 void updateSD(void);
 void updateWiznet(void);
 void updateLCD(void);
+void updateIMU(void);
+void updateHDC(void);
 void updateCMD(void);
+void updateCLI(void);
+void updateInit(void);
+bool updateSplash(void);
+void updateUartRx(uint8_t ch, uint32_t length);
+
+
+static task_handle_t task_cmd = -1;
+static task_handle_t task_cli = -1;
 
 
 
@@ -15,51 +25,74 @@ void apInit(void)
 {
   cliOpen(HW_UART_CH_CLI, 115200);
   cliLogo();
-
-  for (int i = 0; i < 32; i += 1) 
-  {
-    lcdClearBuffer(black);
-    lcdPrintfResize(0, 40 - i, green, 16, "  -- BARAM --");
-    lcdDrawRect(0, 0, LCD_WIDTH, LCD_HEIGHT, white);
-    lcdUpdateDraw();
-    delay(10);
-  }  
-  delay(500);
-  lcdClear(black);
+  bootTimeMark("cli");
 }
 
 
 void apMain(void)
 {
   cmdTaskInit();
+  uiTaskInit();
+
+  //                 name       func          pri mode              period deadline(us)
+  task_cmd = taskAdd("cmd",     updateCMD,      0, TASK_MODE_LOOP,       0,  1000);
+  task_cli = taskAdd("cli",     updateCLI,      1, TASK_MODE_EVENT,      0,  5000);
+             taskAdd("init",    updateInit,     2, TASK_MODE_LOOP,       0,     0);
+             taskAdd("wiznet",  updateWiznet,   2, TASK_MODE_LOOP,       0,     0);
+             taskAdd("swtimer", swtimerUpdate,  2, TASK_MODE_LOOP,       0,     0);
+             taskAdd("i2c",     i2cUpdate,      2, TASK_MODE_LOOP,       0,     0);
+             taskAdd("imu",     updateIMU,      3, TASK_MODE_PERIOD, HW_IMU_UPDATE_MS, 5000);
+             taskAdd("hdc1080", updateHDC,      3, TASK_MODE_PERIOD,    10,  5000);
+             taskAdd("sd",      updateSD,       3, TASK_MODE_PERIOD,    10,  5000);
+             taskAdd("led",     updateLED,      4, TASK_MODE_PERIOD,   500,  5000);
+             taskAdd("lcd",     updateLCD,      5, TASK_MODE_PERIOD,    10, 20000);
+             taskAdd("log",     logUpdate,      6, TASK_MODE_LOOP,       0,     0);
+
+  uartSetRxCallback(HW_UART_CH_CLI, updateUartRx);
+  uartSetRxCallback(HW_UART_CH_EXT, updateUartRx);
+  taskSignal(task_cli);
+
+  bootTimeMark("ready");
 
   while(1)
   {
-    cliMain();
-
-    updateLED();
-    updateLCD();
-    updateSD();
-    updateWiznet();
-    updateCMD();
+    if (taskUpdate() != true)
+    {
+      taskIdle();
+    }
   }
 }
 
 void updateCMD(void)
 {
-  cmdTaskUpdate();
+  // 패킷을 처리했으면 다음 패킷을 바로 받도록 쉬지 않는다.
+  if (cmdTaskUpdate() == true)
+  {
+    taskSetBusy();
+  }
+}
+
+void updateUartRx(uint8_t ch, uint32_t length)
+{
+  if (ch == HW_UART_CH_CLI)
+    taskSignal(task_cli);
+  if (ch == HW_UART_CH_EXT)
+    taskSignal(task_cmd);
+}
+
+void updateCLI(void)
+{
+  cliMain();
+}
+
+void updateInit(void)
+{
+  initUpdate();
 }
 
 void updateLED(void)
 {
-  static uint32_t pre_time = 0;
-  
-  
-  if (millis() - pre_time >= 500)
-  {
-    pre_time = millis();
-    ledToggle(_DEF_LED1);
-  }
+  ledToggle(_DEF_LED1);
 }
 
 void updateSD(void)
@@ -85,153 +118,68 @@ void updateWiznet(void)
   wiznetUpdate();  
 }
 
-void updateLCD(void)
+bool updateSplash(void)
 {
-  int16_t         x_offset = 10;
-  static uint8_t  menu     = 0;
-  uint8_t         menu_max = 5;
-  uint8_t         menu_cur = 0;
-  cmd_boot_info_t cmd_boot_info;
+  static bool     is_done  = false;
+  static uint8_t  step     = 0;
+  static uint32_t pre_time = 0;
 
 
-  if (!lcdIsInit())
+  if (is_done)
   {
-    return;
+    return true;
   }
 
-  if (buttonGetPressed(_DEF_BUTTON1))
+  if (step < 32)
   {
-    delay(10);
-    while(buttonGetPressed(_DEF_BUTTON1));
-    
-    menu = (menu + 1) % menu_max;
-  }
+    if (millis() - pre_time >= 10)
+    {
+      pre_time = millis();
 
-  if (cmdBootIsBusy())
-  {
-    menu_cur = menu_max;
+      lcdClearBuffer(black);
+      lcdPrintfResize(0, 40 - step, green, 16, "  -- BARAM --");
+      lcdDrawRect(0, 0, LCD_WIDTH, LCD_HEIGHT, white);
+      lcdUpdateDraw();
+      step++;
+    }
   }
-  else
+  else if (millis() - pre_time >= 500)
   {
-    menu_cur = menu;
+    lcdClear(black);
+    is_done = true;
+    bootTimeMark("splash");
   }
 
-  if (lcdDrawAvailable())
-  {
-    lcdClearBuffer(black);
-
-    lcdDrawRect(0, 0, 4, 32, white);
-    for (int i=0; i<menu_max; i++)
-    {
-      if (i == menu)
-        lcdDrawFillRect(0, i*(32/menu_max), 4, (32/menu_max), white);
-    }
-
-
-    if (menu_cur == 0)
-    {
-      if (wiznetIsLink() == true)
-      {
-        if (wiznetIsGetIP() == true)
-        {
-          wiznet_info_t net_info;
-
-          wiznetGetInfo(&net_info);
-
-          lcdPrintf(x_offset,  0, white,
-                    "IP %d.%d.%d.%d", 
-                    net_info.ip[0], 
-                    net_info.ip[1],
-                    net_info.ip[2],
-                    net_info.ip[3]);
-          lcdPrintf(x_offset, 16, white,
-                    "DHCP : %s\n", wiznetIsGetIP() ? "True":"False");          
-        }
-        else
-        {
-          lcdPrintf(x_offset, 8, white, "Getting_IP..");        
-        }      
-      }
-      else
-      {
-        lcdPrintf(x_offset, 8, white, "Not Connected");        
-      }
-    }
-
-    if (menu_cur == 1)
-    {
-      rtc_time_t rtc_time;
-      rtc_date_t rtc_date;
-      const char *week_str[] = {"일", "월", "화", "수", "목", "금", "토"};
-
-      rtcGetTime(&rtc_time);
-      rtcGetDate(&rtc_date);
-
-      lcdPrintf(x_offset, 0, white,
-                "%02d-%02d-%02d (%s)",
-                rtc_date.year, rtc_date.month, rtc_date.day, week_str[rtc_date.week]);
-
-      lcdPrintf(x_offset, 16, white,
-                "%02d:%02d:%02d",
-                rtc_time.hours, rtc_time.minutes, rtc_time.seconds);
-    }
-
-    if (menu_cur == 2)
-    {
-      imu_info_t imu_info;
-
-      imuUpdate();
-
-      imuGetInfo(&imu_info);
-
-      lcdPrintf(x_offset,  0, white,
-                "R %-4d P %-4d", 
-                (int)imu_info.roll, 
-                (int)imu_info.pitch);
-      lcdPrintf(x_offset, 16, white,
-                "Y %-4d", 
-                (int)imu_info.yaw);
-    }     
-
-    if (menu_cur == 3)
-    {
-      static hdc1080_info_t hdc_info;
-
-      hdc1080GetInfo(&hdc_info);
-
-      lcdPrintf(x_offset, 0, white,
-                "온도 : %-3d", (int)hdc_info.temp);
-      lcdPrintf(x_offset, 16, white, 
-                "습도 : %-3d%%", (int)hdc_info.humidity);
-    }     
-
-    if (menu_cur == 4)
-    {
-      uint16_t adc_data;
-      uint16_t adc_vol;
-
-      adc_data = adcRead12(LIGHT_ADC);
-      adc_vol = (uint16_t)(adcReadVoltage(LIGHT_ADC) * 1000);
+  return is_done;
+}
 
-      lcdPrintf(x_offset, 0, white,
-                "ADC  : %04d", adc_data);
-      lcdPrintf(x_offset, 16, white, 
-                "전압 : %-4d mV", adc_vol);
-    }
+void updateLCD(void)
+{
+  if (!lcdIsInit())
+  {
+    return;
+  }
 
-    if (cmdBootIsBusy())
-    {
-      uint16_t percent;
+  if (!updateSplash())
+  {
+    return;
+  }
 
-      cmdBootGetInfo(&cmd_boot_info);
+  uiTaskUpdate();
+}
 
-      percent = cmd_boot_info.fw_receive_size * 100 / cmd_boot_info.fw_size;
-      lcdClearBuffer(black);
-      lcdPrintf(96, 0, white, "%3d%%", percent);
-      lcdDrawRect(0, 16, 128, 16, white);
-      lcdDrawFillRect(2, 19, percent * 124 / 100, 10, white);      
-    }
+void updateIMU(void)
+{
+  if (imuIsInit())
+  {
+    imuUpdate();
+  }
+}
 
-    lcdRequestDraw();
+void updateHDC(void)
+{
+  if (hdc1080IsInit())
+  {
+    hdc1080Update();
   }
-}
\ No newline at end of file
+}
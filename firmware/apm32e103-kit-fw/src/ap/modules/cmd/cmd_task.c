@@ -2,6 +2,7 @@
 #include "driver/cmd_uart.h"
 #include "driver/cmd_udp.h"
 #include "process/cmd_boot.h"
+#include "process/cmd_telem.h"
 
 
 
@@ -29,6 +30,9 @@ bool cmdTaskInit(void)
   cmdOpen(&cmd[2]);
 
   cmdBootInit();
+  cmdTelemInit();
+
+  MEM_BUF_ADD("cmd", cmd);
   
   return true;
 }
@@ -36,6 +40,22 @@ bool cmdTaskInit(void)
 bool cmdTaskUpdate(void)
 {
   bool rx_ret = false;
+  static uint32_t pre_time = 0;
+
+
+  // 늦게 초기화되는 드라이버(UDP)는 준비될 때까지 다시 연다.
+  //
+  if (millis()-pre_time >= 1000)
+  {
+    pre_time = millis();
+    for (int i=0; i<CMD_DRIVER_MAX_CH; i++)
+    {
+      if (cmd[i].is_init == true && cmd[i].is_open != true)
+      {
+        cmdOpen(&cmd[i]);
+      }
+    }
+  }
 
   for (int i=0; i<CMD_DRIVER_MAX_CH; i++)
   {
@@ -43,8 +63,10 @@ bool cmdTaskUpdate(void)
     {
       if (cmdReceivePacket(&cmd[i]) == true)
       {
-        bool ret = true;
-        ret &= cmdBootProcess(&cmd[i]);
+        bool ret = false;
+
+        if (ret != true) ret = cmdBootProcess(&cmd[i]);
+        if (ret != true) ret = cmdTelemProcess(&cmd[i]);
 
         if (ret != true)
         {
@@ -53,6 +75,8 @@ bool cmdTaskUpdate(void)
 
         rx_ret = true;
       }
+      cmdBootUpdate(&cmd[i]);
+      cmdTelemUpdate(&cmd[i]);
     }
   }
 
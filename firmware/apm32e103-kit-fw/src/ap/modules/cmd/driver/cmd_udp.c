@@ -3,8 +3,7 @@
 
 
 
-#define CMD_UDP_RX_LENGTH     8*1024
-#define CMD_UPD_RX_USE_Q      1
+#define CMD_UDP_RX_USE_PBUF   1     // 받은 datagram 을 공용 패킷 버퍼에 그대로 받는다.
 
 
 typedef struct
@@ -25,8 +24,8 @@ static bool is_init = false;
 static bool is_open = false;
 
 static uint8_t   socket_id = HW_WIZNET_SOCKET_CMD;
-static uint8_t   rx_buf[CMD_UDP_RX_LENGTH];
-static qbuffer_t rx_q;
+static pbuf_t   *rx_pbuf   = NULL;
+static uint32_t  rx_index  = 0;
 
 
 static uint8_t  dest_ip[4];
@@ -43,8 +42,6 @@ bool cmdUdpInitDriver(cmd_driver_t *p_driver, const char *ip_addr, uint32_t port
   cmd_udp_args_t *p_args = (cmd_udp_args_t *)p_driver->args;
 
 
-  qbufferCreate(&rx_q, rx_buf, CMD_UDP_RX_LENGTH);
-
   p_args->port  = port;
   strncpy(p_args->ip_addr, ip_addr, 32);
 
@@ -54,6 +51,7 @@ bool cmdUdpInitDriver(cmd_driver_t *p_driver, const char *ip_addr, uint32_t port
   p_driver->flush     = flush;
   p_driver->read      = read;
   p_driver->write     = write;
+  p_driver->ioctl     = NULL;
 
   if (wiznetIsInit())
     is_init = true;
@@ -69,6 +67,7 @@ bool open_(void *args)
   int8_t socket_ret;
   cmd_udp_args_t *p_args = (cmd_udp_args_t *)args;
 
+  is_init = wiznetIsInit();
   if (!is_init)
     return false;
 
@@ -78,7 +77,7 @@ bool open_(void *args)
     ret = true;
   }
 
-  logPrintf("[%s] cmdUdpOpen()\n", ret ? "OK":"E_");
+  logBinPrintf("[%s] cmdUdpOpen()\n", (uint32_t)(ret ? "OK":"E_"));
 
   is_open = ret;
   return ret;
@@ -90,38 +89,56 @@ bool close_(void *args)
 
   is_open = false;
 
+  #if CMD_UDP_RX_USE_PBUF
+  pbufFree(rx_pbuf);
+  rx_pbuf = NULL;
+  #endif
+
   return true;  
 }
 
 uint32_t available(void *args)
 {
-  #if CMD_UPD_RX_USE_Q
-  uint32_t       ret = 0;
-  uint32_t       buf_size = 0;
-  int32_t        recv_len;
-  static uint8_t buf[1024];
+  #if CMD_UDP_RX_USE_PBUF
+  uint32_t ret = 0;
+  int32_t  recv_len;
 
 
   if (!is_init)
     return 0;
 
-  if (getSn_SR(socket_id) == SOCK_UDP)
+  if (rx_pbuf != NULL && rx_index >= rx_pbuf->length)
   {
-    buf_size = getSn_RX_RSR(socket_id);
-    buf_size = constrain(buf_size, 0, 1024);
+    pbufFree(rx_pbuf);
+    rx_pbuf = NULL;
+  }
 
-    if (buf_size > 0)
+  // 버퍼를 못 받으면 데이터는 W5500 소켓 버퍼에 남겨둔다.
+  //
+  if (rx_pbuf == NULL && getSn_SR(socket_id) == SOCK_UDP && getSn_RX_RSR(socket_id) > 0)
+  {
+    rx_pbuf = pbufAlloc();
+    if (rx_pbuf != NULL)
     {
-      recv_len = recvfrom(socket_id, buf, buf_size, dest_ip,(uint16_t*)&dest_port);
+      recv_len = recvfrom(socket_id, rx_pbuf->p_buf, rx_pbuf->size, dest_ip,(uint16_t*)&dest_port);
       if (recv_len > 0)
       {
         dest_update = true;
-        qbufferWrite(&rx_q, buf, recv_len);
+        rx_pbuf->length = recv_len;
+        rx_index = 0;
+      }
+      else
+      {
+        pbufFree(rx_pbuf);
+        rx_pbuf = NULL;
       }
     }
   }
 
-  ret = qbufferAvailable(&rx_q);
+  if (rx_pbuf != NULL)
+  {
+    ret = rx_pbuf->length - rx_index;
+  }
   #else
   uint32_t ret = 0;
 
@@ -143,16 +160,18 @@ bool flush(void *args)
   {
     read(args);
   }
-  qbufferFlush(&rx_q);
   return true;
 }
 
 uint8_t read(void *args)
 {
-  #if CMD_UPD_RX_USE_Q
-  uint8_t  ret;
+  #if CMD_UDP_RX_USE_PBUF
+  uint8_t  ret = 0;
 
-  qbufferRead(&rx_q, &ret, 1);
+  if (rx_pbuf != NULL && rx_index < rx_pbuf->length)
+  {
+    ret = rx_pbuf->p_buf[rx_index++];
+  }
   #else
   uint8_t ret;
   int32_t recv_len;
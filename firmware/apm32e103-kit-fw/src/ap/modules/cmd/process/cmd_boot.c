@@ -18,6 +18,17 @@
 #define BOOT_CMD_FW_BEGIN               0x000D
 #define BOOT_CMD_FW_END                 0x000E
 #define BOOT_CMD_LED                    0x0010
+#define BOOT_CMD_BOOT_TIME              0x0011
+#define BOOT_CMD_LOG_BIN                0x0012
+#define BOOT_CMD_SET_BAUD               0x0013
+#define BOOT_CMD_CPU_LOAD               0x0014
+#define BOOT_CMD_MEM_INFO               0x0015
+
+#define BOOT_LOG_PACKET_MAX             512
+
+#define BOOT_BAUD_MIN                   9600
+#define BOOT_BAUD_MAX                   2000000
+#define BOOT_BAUD_CONFIRM_TIME          1000
 
 
 typedef struct
@@ -40,14 +51,28 @@ typedef struct
   uint32_t fw_size;
 } boot_begin_t;
 
+//-- 통신 속도 변경 후 새 속도에서 패킷을 받기 전까지는 확정하지 않는다.
+//
+typedef struct
+{
+  cmd_t   *p_cmd;
+  uint32_t baud_old;
+  uint32_t pre_time;
+} boot_baud_t;
+
 
 static boot_info_t    boot_info;
 static boot_version_t boot_version;
 static boot_begin_t   boot_begin;
 
+static boot_baud_t    boot_baud = {NULL, 0, 0};
+
 static bool is_begin = false;
 static uint32_t fw_receive_size = 0;
 static cmd_boot_info_t cmd_boot_info;
+#ifdef _USE_HW_LOG_BIN
+static cmd_t *p_log_cmd = NULL;
+#endif
 
 
 
@@ -221,7 +246,7 @@ static void bootFirmRead(cmd_t *p_cmd)
   length |= ((uint32_t)p_packet->data[6] << 16);
   length |= ((uint32_t)p_packet->data[7] << 24);
 
-  if ((addr+length) < FLASH_SIZE_FIRM)
+  if ((addr+length) < FLASH_SIZE_FIRM && length <= CMD_MAX_DATA_LENGTH)
   {    
     if (flashRead(FLASH_ADDR_UPDATE + addr, &p_packet->data[0], length) != true)
     {
@@ -367,8 +392,186 @@ static void bootLedToggle(cmd_t *p_cmd)
   cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, NULL, 0);
 }
 
+static void bootTime(cmd_t *p_cmd)
+{
+  uint8_t *p_data = p_cmd->packet.data;
+  uint32_t count;
+  uint32_t length;
+  boot_time_info_t info;
+
+
+  count  = bootTimeGetCount();
+  length = 4;
+  for (uint32_t i=0; i<count; i++)
+  {
+    if (length + sizeof(boot_time_info_t) > CMD_MAX_DATA_LENGTH)
+      break;
+
+    bootTimeGetInfo(i, &info);
+    memcpy(&p_data[length], &info, sizeof(boot_time_info_t));
+    length += sizeof(boot_time_info_t);
+  }
+  count = (length - 4) / sizeof(boot_time_info_t);
+
+  p_data[0] = (count >>  0) & 0xFF;
+  p_data[1] = (count >>  8) & 0xFF;
+  p_data[2] = (count >> 16) & 0xFF;
+  p_data[3] = (count >> 24) & 0xFF;
+
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, CMD_OK, p_data, length);
+}
+
+static void bootLogBin(cmd_t *p_cmd)
+{
+  uint16_t err_code = CMD_OK;
+
+#ifdef _USE_HW_LOG_BIN
+  bool is_enable;
+
+  is_enable = p_cmd->packet.length > 0 && p_cmd->packet.data[0] > 0;
+  if (is_enable)
+    p_log_cmd = p_cmd;
+  else if (p_log_cmd == p_cmd)
+    p_log_cmd = NULL;
+
+  logBinSetHost(p_log_cmd != NULL);
+#else
+  err_code = ERR_CMD_NO_CMD;
+#endif
+
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, NULL, 0);
+}
+
+static void bootCpuLoad(cmd_t *p_cmd)
+{
+  uint16_t err_code = CMD_OK;
+  uint32_t length = 0;
+
+#ifdef _USE_HW_TASK
+  task_load_t load;
+
+  taskGetLoad(&load);
+  memcpy(p_cmd->packet.data, &load, sizeof(task_load_t));
+  length = sizeof(task_load_t);
+#else
+  err_code = ERR_CMD_NO_CMD;
+#endif
+
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, p_cmd->packet.data, length);
+}
+
+static void bootMemInfo(cmd_t *p_cmd)
+{
+  uint16_t err_code = CMD_OK;
+  uint32_t length = 0;
+
+#ifdef _USE_HW_MEM
+  mem_info_t info;
+
+  memGetInfo(&info);
+  memcpy(p_cmd->packet.data, &info, sizeof(mem_info_t));
+  length = sizeof(mem_info_t);
+#else
+  err_code = ERR_CMD_NO_CMD;
+#endif
+
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, p_cmd->packet.data, length);
+}
+
+static void bootSetBaud(cmd_t *p_cmd)
+{
+  cmd_packet_t *p_packet = &p_cmd->packet;
+  cmd_driver_t *p_driver = p_cmd->p_driver;
+  uint16_t err_code = CMD_OK;
+  uint32_t baud = 0;
+  uint32_t baud_old = 0;
+
+
+  if (p_packet->length == 4)
+  {
+    memcpy(&baud, p_packet->data, 4);
+  }
+
+  if (p_driver->ioctl == NULL || p_driver->ioctl(p_driver->args, CMD_IOCTL_GET_BAUD, &baud_old, 4) != true)
+  {
+    err_code = ERR_BOOT_WRONG_CMD;
+  }
+  else if (baud < BOOT_BAUD_MIN || baud > BOOT_BAUD_MAX)
+  {
+    err_code = ERR_BOOT_WRONG_RANGE;
+  }
+
+  // 응답은 현재 속도로 보내고 전송이 끝나면 속도를 바꾼다.
+  //
+  cmdSendResp(p_cmd, p_cmd->packet.cmd, err_code, NULL, 0);
+
+  if (err_code != CMD_OK || baud == baud_old)
+    return;
+
+  if (p_driver->ioctl(p_driver->args, CMD_IOCTL_SET_BAUD, &baud, 4) == true)
+  {
+    boot_baud.p_cmd    = p_cmd;
+    boot_baud.baud_old = baud_old;
+    boot_baud.pre_time = millis();
+  }
+}
+
+static void bootBaudUpdate(cmd_t *p_cmd)
+{
+  cmd_driver_t *p_driver = p_cmd->p_driver;
+
+  if (boot_baud.p_cmd != p_cmd)
+    return;
+
+  // 시간 안에 새 속도로 확인 패킷이 오지 않으면 이전 속도로 되돌린다.
+  //
+  if (millis()-boot_baud.pre_time >= BOOT_BAUD_CONFIRM_TIME)
+  {
+    p_driver->ioctl(p_driver->args, CMD_IOCTL_SET_BAUD, &boot_baud.baud_old, 4);
+    boot_baud.p_cmd = NULL;
+  }
+}
+
+static void bootLogUpdate(cmd_t *p_cmd)
+{
+#ifdef _USE_HW_LOG_BIN
+  uint8_t  buf[BOOT_LOG_PACKET_MAX];
+  uint32_t length;
+  uint32_t rec_len;
+  uint32_t drop;
+  log_bin_t log;
+
+
+  if (p_cmd != p_log_cmd)
+    return;
+
+  // [drop count 4][fmt 4][time_us 4][argc 4][arg 4 x argc] ...
+  //
+  drop = logBinGetDrop();
+  memcpy(&buf[0], &drop, 4);
+  length = 4;
+
+  while(length + sizeof(log_bin_t) <= BOOT_LOG_PACKET_MAX)
+  {
+    if (logBinRead(&log) != true)
+      break;
+
+    rec_len = 12 + log.argc * 4;
+    memcpy(&buf[length], &log, rec_len);
+    length += rec_len;
+  }
+
+  if (length > 4)
+  {
+    cmdSendType(p_cmd, PKT_TYPE_LOG, buf, length);
+  }
+#endif
+}
+
 void cmdBootUpdate(cmd_t *p_cmd)
 {
+  bootBaudUpdate(p_cmd);
+  bootLogUpdate(p_cmd);
 }
 
 bool cmdBootProcess(cmd_t *p_cmd)
@@ -376,6 +579,19 @@ bool cmdBootProcess(cmd_t *p_cmd)
   bool ret = true;
 
 
+  // 변경한 속도로 패킷을 받았으면 속도 변경을 확정한다.
+  //
+  if (boot_baud.p_cmd == p_cmd)
+  {
+    boot_baud.p_cmd = NULL;
+  }
+
+  if (p_cmd->packet.type == PKT_TYPE_PING)
+  {
+    cmdSendType(p_cmd, PKT_TYPE_PING, NULL, 0);
+    return true;
+  }
+
   switch(p_cmd->packet.cmd)
   {
     case BOOT_CMD_INFO:
@@ -426,6 +642,26 @@ bool cmdBootProcess(cmd_t *p_cmd)
       bootLedToggle(p_cmd);
       break;
 
+    case BOOT_CMD_BOOT_TIME:
+      bootTime(p_cmd);
+      break;
+
+    case BOOT_CMD_LOG_BIN:
+      bootLogBin(p_cmd);
+      break;
+
+    case BOOT_CMD_SET_BAUD:
+      bootSetBaud(p_cmd);
+      break;
+
+    case BOOT_CMD_CPU_LOAD:
+      bootCpuLoad(p_cmd);
+      break;
+
+    case BOOT_CMD_MEM_INFO:
+      bootMemInfo(p_cmd);
+      break;
+
     default:
       ret = false;
       break;  
@@ -0,0 +1,352 @@
+#include "cmd_telem.h"
+
+
+#define TELEM_CMD_CONFIG                0x0100
+#define TELEM_EVT_DATA                  0x0100
+
+#define TELEM_PACKET_MAX                1024
+#define TELEM_HEAD_SIZE                 8         // seq 4, drop 4
+
+#define TELEM_TYPE_IMU                  0x01
+#define TELEM_TYPE_HDC                  0x02
+#define TELEM_TYPE_ADC                  0x03
+
+#define TELEM_REC_HEAD                  5         // type 1, time_us 4
+#define TELEM_REC_IMU                   18        // acc 3, gyro 3, roll/pitch/yaw x100 (int16)
+#define TELEM_REC_HDC                   4         // temp x100, humidity x100 (int16)
+#define TELEM_REC_ADC                   (1 + 2*ADC_MAX_CH)
+#define TELEM_REC_MAX                   (TELEM_REC_HEAD + TELEM_REC_IMU)
+
+#define TELEM_HDC_HZ_MAX                10
+#if defined(_USE_HW_ADC) && HW_ADC_SAMPLE_HZ > 0
+#define TELEM_ADC_HZ_MAX                (HW_ADC_SAMPLE_HZ >> ADC_OVERSAMPLE_BITS)
+#define TELEM_ADC_DEC_US                ((1000000 << ADC_OVERSAMPLE_BITS) / HW_ADC_SAMPLE_HZ)
+#define TELEM_ADC_Q_LEN                 32        // 2^n, 메인 루프가 늦어도 128ms 는 버틴다.
+#endif
+#define TELEM_FLUSH_MS_MIN              10
+#define TELEM_FLUSH_MS_MAX              1000
+#define TELEM_FLUSH_MS_DEF              100
+
+
+//-- 주기가 모두 0 이면 정지한다.
+//
+typedef struct
+{
+  uint16_t imu_hz;        // HW_IMU_ODR_HZ 이하, 남는 샘플은 솎아낸다.
+  uint16_t hdc_hz;
+  uint16_t adc_hz;        // ADC 블록의 평균 샘플 주기 이하
+  uint16_t flush_ms;      // 패킷이 덜 차도 이 시간이 지나면 보낸다.
+} telem_config_t;
+
+
+static void     telemConfig(cmd_t *p_cmd);
+static uint8_t *telemAlloc(uint8_t type, uint32_t time_us, uint32_t length);
+static void     telemFlush(cmd_t *p_cmd);
+static void     telemImuSample(imu_sample_t *p_sample);
+static void     telemHdcUpdate(void);
+static void     telemAdcUpdate(void);
+#ifdef TELEM_ADC_HZ_MAX
+static void     telemAdcBlock(adc_block_t *p_block);
+#endif
+
+
+static cmd_t         *p_telem_cmd = NULL;
+static telem_config_t telem_config;
+
+static uint8_t  tx_buf[TELEM_PACKET_MAX];
+static uint32_t tx_length = TELEM_HEAD_SIZE;
+static uint32_t tx_time;
+static uint32_t tx_seq  = 0;
+static uint32_t tx_drop = 0;
+
+static uint32_t imu_acc;
+static uint32_t hdc_pre_time;
+static uint32_t hdc_count;
+#ifdef TELEM_ADC_HZ_MAX
+//-- ADC 블록 콜백(인터럽트)이 넣고 메인 루프가 꺼내는 큐
+typedef struct
+{
+  uint32_t time_us;
+  uint16_t data[ADC_MAX_CH];
+} telem_adc_t;
+
+static telem_adc_t       adc_q[TELEM_ADC_Q_LEN];
+static volatile uint32_t adc_q_in;
+static volatile uint32_t adc_q_out;
+static volatile uint32_t adc_q_drop;
+static uint32_t          adc_q_drop_pre;
+static uint32_t          adc_acc;
+#endif
+
+
+
+
+bool cmdTelemInit(void)
+{
+  p_telem_cmd = NULL;
+  memset(&telem_config, 0, sizeof(telem_config));
+
+  MEM_BUF_ADD("telem", tx_buf);
+
+  return true;
+}
+
+void telemConfig(cmd_t *p_cmd)
+{
+  cmd_packet_t  *p_packet = &p_cmd->packet;
+  telem_config_t config;
+  bool is_enable;
+
+
+  memset(&config, 0, sizeof(config));
+  if (p_packet->length >= sizeof(config))
+  {
+    memcpy(&config, p_packet->data, sizeof(config));
+  }
+
+#ifdef _USE_HW_IMU
+  config.imu_hz = constrain(config.imu_hz, 0, HW_IMU_ODR_HZ);
+#else
+  config.imu_hz = 0;
+#endif
+#ifdef _USE_HW_HDC1080
+  config.hdc_hz = constrain(config.hdc_hz, 0, TELEM_HDC_HZ_MAX);
+#else
+  config.hdc_hz = 0;
+#endif
+#ifdef TELEM_ADC_HZ_MAX
+  config.adc_hz = constrain(config.adc_hz, 0, TELEM_ADC_HZ_MAX);
+#else
+  config.adc_hz = 0;
+#endif
+  if (config.flush_ms == 0)
+    config.flush_ms = TELEM_FLUSH_MS_DEF;
+  config.flush_ms = constrain(config.flush_ms, TELEM_FLUSH_MS_MIN, TELEM_FLUSH_MS_MAX);
+
+  is_enable = config.imu_hz > 0 || config.hdc_hz > 0 || config.adc_hz > 0;
+  if (is_enable)
+  {
+    if (p_telem_cmd != p_cmd)
+    {
+      tx_seq  = 0;
+      tx_drop = 0;
+    }
+    p_telem_cmd  = p_cmd;
+    telem_config = config;
+    tx_length    = TELEM_HEAD_SIZE;
+    imu_acc      = 0;
+    hdc_pre_time = millis() - 1000;
+    hdc_count    = 0;
+  }
+  else if (p_telem_cmd == p_cmd)
+  {
+    p_telem_cmd = NULL;
+    memset(&telem_config, 0, sizeof(telem_config));
+  }
+
+#ifdef _USE_HW_IMU
+  imuSetSampleCallback(telem_config.imu_hz > 0 ? telemImuSample : NULL);
+#endif
+#ifdef TELEM_ADC_HZ_MAX
+  // 콜백을 뗀 상태에서 큐를 비우고 다시 건다.
+  adcSetBlockCallback(NULL);
+  adc_q_out      = adc_q_in;
+  adc_q_drop_pre = adc_q_drop;
+  adc_acc        = 0;
+  adcSetBlockCallback(telem_config.adc_hz > 0 ? telemAdcBlock : NULL);
+#endif
+
+  cmdSendResp(p_cmd, p_packet->cmd, CMD_OK, (uint8_t *)&config, sizeof(config));
+}
+
+// 자리가 없으면 버리고 drop 으로 센다.
+//
+uint8_t *telemAlloc(uint8_t type, uint32_t time_us, uint32_t length)
+{
+  uint8_t *p_rec;
+
+
+  if (tx_length + TELEM_REC_HEAD + length > TELEM_PACKET_MAX)
+  {
+    tx_drop++;
+    return NULL;
+  }
+  if (tx_length == TELEM_HEAD_SIZE)
+  {
+    tx_time = millis();
+  }
+
+  p_rec = &tx_buf[tx_length];
+  p_rec[0] = type;
+  memcpy(&p_rec[1], &time_us, 4);
+  tx_length += TELEM_REC_HEAD + length;
+
+  return &p_rec[TELEM_REC_HEAD];
+}
+
+// [seq 4][drop 4][type 1][time_us 4][data] ...
+//   전송에 실패해도 seq 는 증가하므로 받는 쪽에서 빠진 패킷을 알 수 있다.
+//   time_us 는 모든 레코드가 micros() 기준이다.
+//     IMU : 샘플 시각. 간격은 센서 클럭이고 읽을 때마다 micros() 에 다시 맞춘다.
+//     HDC : 드라이버가 측정 결과를 받은 시각
+//     ADC : 평균한 샘플의 마지막 스캔 시각 (ADC 블록 시각에서 역산)
+//
+void telemFlush(cmd_t *p_cmd)
+{
+  if (tx_length == TELEM_HEAD_SIZE)
+    return;
+  if (TELEM_PACKET_MAX - tx_length >= TELEM_REC_MAX && millis()-tx_time < telem_config.flush_ms)
+    return;
+
+  memcpy(&tx_buf[0], &tx_seq,  4);
+  memcpy(&tx_buf[4], &tx_drop, 4);
+
+  cmdSend(p_cmd, PKT_TYPE_EVENT, TELEM_EVT_DATA, CMD_OK, tx_buf, tx_length);
+  tx_seq++;
+  tx_length = TELEM_HEAD_SIZE;
+}
+
+void telemImuSample(imu_sample_t *p_sample)
+{
+  uint8_t *p_data;
+
+
+  // ODR 보다 낮은 주기는 일정한 간격으로 솎아낸다.
+  imu_acc += telem_config.imu_hz;
+  if (imu_acc < HW_IMU_ODR_HZ)
+    return;
+  imu_acc -= HW_IMU_ODR_HZ;
+
+  p_data = telemAlloc(TELEM_TYPE_IMU, p_sample->timestamp, TELEM_REC_IMU);
+  if (p_data == NULL)
+    return;
+
+  memcpy(&p_data[0],  p_sample->a_raw, 6);
+  memcpy(&p_data[6],  p_sample->g_raw, 6);
+  memcpy(&p_data[12], &p_sample->roll_x100,  2);
+  memcpy(&p_data[14], &p_sample->pitch_x100, 2);
+  memcpy(&p_data[16], &p_sample->yaw_x100,   2);
+}
+
+void telemHdcUpdate(void)
+{
+#ifdef _USE_HW_HDC1080
+  hdc1080_info_t info;
+  uint8_t *p_data;
+
+
+  if (telem_config.hdc_hz == 0)
+    return;
+
+  // 측정은 드라이버가 하고, 여기서는 설정 주기마다 새 결과만 보낸다.
+  if (millis()-hdc_pre_time < 1000/telem_config.hdc_hz)
+    return;
+  if (hdc1080GetInfo(&info) != true || info.count == hdc_count)
+    return;
+  hdc_pre_time = millis();
+  hdc_count    = info.count;
+
+  p_data = telemAlloc(TELEM_TYPE_HDC, info.time_us, TELEM_REC_HDC);
+  if (p_data == NULL)
+    return;
+
+  memcpy(&p_data[0], &info.temp_x100,     2);
+  memcpy(&p_data[2], &info.humidity_x100, 2);
+#endif
+}
+
+#ifdef TELEM_ADC_HZ_MAX
+// ADC 블록마다 인터럽트에서 호출된다. 평균한 샘플을 설정 주기로 솎아서 큐에 넣는다.
+//   블록 시각은 마지막 스캔이므로 앞쪽 샘플은 평균 주기만큼씩 앞당긴다.
+//
+void telemAdcBlock(adc_block_t *p_block)
+{
+  telem_adc_t *p_q;
+  const uint16_t *p_dec;
+
+
+  for (int d=0; d<p_block->dec_count; d++)
+  {
+    adc_acc += telem_config.adc_hz;
+    if (adc_acc < TELEM_ADC_HZ_MAX)
+      continue;
+    adc_acc -= TELEM_ADC_HZ_MAX;
+
+    if (adc_q_in - adc_q_out >= TELEM_ADC_Q_LEN)
+    {
+      adc_q_drop++;
+      continue;
+    }
+
+    p_q   = &adc_q[adc_q_in % TELEM_ADC_Q_LEN];
+    p_dec = &p_block->p_dec[d * ADC_MAX_CH];
+    p_q->time_us = p_block->timestamp - (p_block->dec_count - 1 - d) * TELEM_ADC_DEC_US;
+    for (int ch=0; ch<ADC_MAX_CH; ch++)
+      p_q->data[ch] = p_dec[ch] >> 4;     // 12bit 로 맞춘다.
+    adc_q_in++;
+  }
+}
+#endif
+
+void telemAdcUpdate(void)
+{
+#ifdef TELEM_ADC_HZ_MAX
+  telem_adc_t *p_q;
+  uint8_t *p_data;
+  uint32_t drop;
+
+
+  drop = adc_q_drop;
+  tx_drop += drop - adc_q_drop_pre;
+  adc_q_drop_pre = drop;
+
+  // 한번에 여러 개를 꺼내므로 패킷이 차면 중간에 보낸다.
+  while (adc_q_out != adc_q_in)
+  {
+    telemFlush(p_telem_cmd);
+
+    p_q    = &adc_q[adc_q_out % TELEM_ADC_Q_LEN];
+    p_data = telemAlloc(TELEM_TYPE_ADC, p_q->time_us, TELEM_REC_ADC);
+    if (p_data != NULL)
+    {
+      p_data[0] = ADC_MAX_CH;
+      memcpy(&p_data[1], p_q->data, 2*ADC_MAX_CH);
+    }
+    adc_q_out++;
+  }
+#endif
+}
+
+void cmdTelemUpdate(cmd_t *p_cmd)
+{
+  if (p_cmd != p_telem_cmd)
+    return;
+
+  telemHdcUpdate();
+  telemAdcUpdate();
+  telemFlush(p_cmd);
+}
+
+bool cmdTelemProcess(cmd_t *p_cmd)
+{
+  bool ret = true;
+
+
+  if (p_cmd->packet.type != PKT_TYPE_CMD)
+  {
+    return false;
+  }
+
+  switch(p_cmd->packet.cmd)
+  {
+    case TELEM_CMD_CONFIG:
+      telemConfig(p_cmd);
+      break;
+
+    default:
+      ret = false;
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,12 @@
+#ifndef CMD_TELEM_H_
+#define CMD_TELEM_H_
+
+
+#include "ap_def.h"
+
+
+bool cmdTelemInit(void);
+bool cmdTelemProcess(cmd_t *p_cmd);
+void cmdTelemUpdate(cmd_t *p_cmd);
+
+#endif
@@ -7,5 +7,6 @@
 
 #include "cmd/cmd_task.h"
 #include "cmd/process/cmd_boot.h"
+#include "ui/ui_task.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "ui_task.h"
+#include "ui_widget.h"
+#include "cmd/process/cmd_boot.h"
+
+
+
+#define UI_MENU_MAX           5
+#define UI_SCREEN_BOOT        UI_MENU_MAX
+#define UI_SCREEN_MAX         (UI_MENU_MAX + 1)
+#define UI_SCREEN_NONE        0xFF
+
+#define UI_X                  10
+#define UI_W                  (LCD_WIDTH - UI_X)
+
+
+//-- 화면마다 데이터를 한번 읽어오는 update 와 위젯 목록을 가진다.
+//   위젯은 update 에서 읽은 값을 글자나 막대로 바꾸기만 한다.
+//
+typedef struct
+{
+  void        (*update)(void);
+  ui_widget_t  *p_widget;
+  uint32_t      count;
+} ui_screen_t;
+
+
+static void uiDrawMenu(uint8_t index);
+
+static void updateNet(void);
+static void textNetLine0(char *p_str, uint32_t length);
+static void textNetLine1(char *p_str, uint32_t length);
+static void updateTime(void);
+static void textDate(char *p_str, uint32_t length);
+static void textTime(char *p_str, uint32_t length);
+static void updateImu(void);
+static void textImuRP(char *p_str, uint32_t length);
+static void textImuY(char *p_str, uint32_t length);
+static void updateHdc(void);
+static void textTemp(char *p_str, uint32_t length);
+static void textHumidity(char *p_str, uint32_t length);
+static void updateAdc(void);
+static void textAdc(char *p_str, uint32_t length);
+static void textVoltage(char *p_str, uint32_t length);
+static int32_t valueAdc(void);
+static void updateBoot(void);
+static void textBoot(char *p_str, uint32_t length);
+static int32_t valueBoot(void);
+
+
+static uint8_t menu       = 0;
+static uint8_t screen_cur = UI_SCREEN_NONE;
+
+static bool           net_link;
+static bool           net_get_ip;
+static wiznet_info_t  net_info;
+static rtc_time_t     rtc_time;
+static rtc_date_t     rtc_date;
+static imu_info_t     imu_info;
+static hdc1080_info_t hdc_info;
+static int32_t        adc_data;
+static int32_t        adc_vol;
+static int32_t        boot_percent;
+
+static ui_widget_t widget_net[] =
+{
+  UI_LABEL(UI_X,  0, UI_W, 16, textNetLine0),
+  UI_LABEL(UI_X, 16, UI_W, 16, textNetLine1),
+};
+
+static ui_widget_t widget_time[] =
+{
+  UI_LABEL(UI_X,  0, UI_W, 16, textDate),
+  UI_LABEL(UI_X, 16, UI_W, 16, textTime),
+};
+
+static ui_widget_t widget_imu[] =
+{
+  UI_LABEL(UI_X,  0, UI_W, 16, textImuRP),
+  UI_LABEL(UI_X, 16, UI_W, 16, textImuY),
+};
+
+static ui_widget_t widget_hdc[] =
+{
+  UI_LABEL(UI_X,  0, UI_W, 16, textTemp),
+  UI_LABEL(UI_X, 16, UI_W, 16, textHumidity),
+};
+
+static ui_widget_t widget_adc[] =
+{
+  UI_LABEL(UI_X,  0, 90,   16, textAdc),
+  UI_BAR  (100,   4, 26,    8, 0, 4095, valueAdc),
+  UI_LABEL(UI_X, 16, UI_W, 16, textVoltage),
+};
+
+static ui_widget_t widget_boot[] =
+{
+  UI_LABEL   (96,  0,  32, 16, textBoot),
+  UI_PROGRESS( 0, 16, 128, 16, 0, 100, valueBoot),
+};
+
+static ui_screen_t screen_tbl[UI_SCREEN_MAX] =
+{
+  {updateNet,  widget_net,  sizeof(widget_net)/sizeof(ui_widget_t)},
+  {updateTime, widget_time, sizeof(widget_time)/sizeof(ui_widget_t)},
+  {updateImu,  widget_imu,  sizeof(widget_imu)/sizeof(ui_widget_t)},
+  {updateHdc,  widget_hdc,  sizeof(widget_hdc)/sizeof(ui_widget_t)},
+  {updateAdc,  widget_adc,  sizeof(widget_adc)/sizeof(ui_widget_t)},
+  {updateBoot, widget_boot, sizeof(widget_boot)/sizeof(ui_widget_t)},
+};
+
+
+
+
+bool uiTaskInit(void)
+{
+  menu       = 0;
+  screen_cur = UI_SCREEN_NONE;
+
+  return true;
+}
+
+bool uiTaskUpdate(void)
+{
+  bool         is_changed = false;
+  uint8_t      screen;
+  ui_screen_t *p_screen;
+
+
+  if (buttonGetPressed(_DEF_BUTTON1))
+  {
+    delay(10);
+    while(buttonGetPressed(_DEF_BUTTON1));
+
+    menu = (menu + 1) % UI_MENU_MAX;
+  }
+
+  if (cmdBootIsBusy())
+    screen = UI_SCREEN_BOOT;
+  else
+    screen = menu;
+
+  if (lcdDrawAvailable() != true)
+  {
+    return false;
+  }
+  p_screen = &screen_tbl[screen];
+
+  // 화면이 바뀔 때만 전체를 지우고 모든 위젯을 다시 그린다.
+  //
+  if (screen != screen_cur)
+  {
+    screen_cur = screen;
+
+    lcdClearBuffer(black);
+    if (screen < UI_MENU_MAX)
+    {
+      uiDrawMenu(menu);
+    }
+    uiWidgetInvalidate(p_screen->p_widget, p_screen->count);
+    is_changed = true;
+  }
+
+  p_screen->update();
+  is_changed |= uiWidgetUpdate(p_screen->p_widget, p_screen->count);
+
+  // 바뀐 것이 없으면 전송하지 않는다.
+  if (is_changed)
+  {
+    lcdRequestDraw();
+  }
+
+  return is_changed;
+}
+
+void uiDrawMenu(uint8_t index)
+{
+  lcdDrawRect(0, 0, 4, 32, white);
+  lcdDrawFillRect(0, index*(32/UI_MENU_MAX), 4, (32/UI_MENU_MAX), white);
+}
+
+void updateNet(void)
+{
+  net_link   = wiznetIsLink();
+  net_get_ip = wiznetIsGetIP();
+  wiznetGetInfo(&net_info);
+}
+
+void textNetLine0(char *p_str, uint32_t length)
+{
+  if (net_link != true)
+    snprintf(p_str, length, "Not Connected");
+  else if (net_get_ip != true)
+    snprintf(p_str, length, "Getting_IP..");
+  else
+    snprintf(p_str, length, "IP %d.%d.%d.%d", net_info.ip[0], net_info.ip[1], net_info.ip[2], net_info.ip[3]);
+}
+
+void textNetLine1(char *p_str, uint32_t length)
+{
+  if (net_link == true && net_get_ip == true)
+    snprintf(p_str, length, "DHCP : True");
+}
+
+void updateTime(void)
+{
+  rtcGetTime(&rtc_time);
+  rtcGetDate(&rtc_date);
+}
+
+void textDate(char *p_str, uint32_t length)
+{
+  const char *week_str[] = {"일", "월", "화", "수", "목", "금", "토"};
+
+  snprintf(p_str, length, "%02d-%02d-%02d (%s)",
+           rtc_date.year, rtc_date.month, rtc_date.day, week_str[rtc_date.week]);
+}
+
+void textTime(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "%02d:%02d:%02d", rtc_time.hours, rtc_time.minutes, rtc_time.seconds);
+}
+
+void updateImu(void)
+{
+  imuGetInfo(&imu_info);
+}
+
+void textImuRP(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "R %-4d P %-4d", (int)imu_info.roll, (int)imu_info.pitch);
+}
+
+void textImuY(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "Y %-4d", (int)imu_info.yaw);
+}
+
+void updateHdc(void)
+{
+  hdc1080GetInfo(&hdc_info);
+}
+
+void textTemp(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "온도 : %-3d", (int)hdc_info.temp);
+}
+
+void textHumidity(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "습도 : %-3d%%", (int)hdc_info.humidity);
+}
+
+void updateAdc(void)
+{
+  adc_data = adcRead12(LIGHT_ADC);
+  adc_vol  = (int32_t)(adcReadVoltage(LIGHT_ADC) * 1000);
+}
+
+void textAdc(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "ADC  : %04d", (int)adc_data);
+}
+
+void textVoltage(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "전압 : %-4d mV", (int)adc_vol);
+}
+
+int32_t valueAdc(void)
+{
+  return adc_data;
+}
+
+void updateBoot(void)
+{
+  cmd_boot_info_t cmd_boot_info;
+
+  cmdBootGetInfo(&cmd_boot_info);
+
+  if (cmd_boot_info.fw_size > 0)
+    boot_percent = cmd_boot_info.fw_receive_size * 100 / cmd_boot_info.fw_size;
+  else
+    boot_percent = 0;
+}
+
+void textBoot(char *p_str, uint32_t length)
+{
+  snprintf(p_str, length, "%3d%%", (int)boot_percent);
+}
+
+int32_t valueBoot(void)
+{
+  return boot_percent;
+}
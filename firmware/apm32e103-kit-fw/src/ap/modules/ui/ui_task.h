@@ -0,0 +1,11 @@
+#ifndef UI_TASK_H_
+#define UI_TASK_H_
+
+
+#include "ap_def.h"
+
+
+bool uiTaskInit(void);
+bool uiTaskUpdate(void);
+
+#endif
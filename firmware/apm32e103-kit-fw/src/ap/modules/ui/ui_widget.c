@@ -0,0 +1,119 @@
+#include "ui_widget.h"
+
+
+
+#define UI_BG_COLOR           black
+
+
+static bool uiDrawLabel(ui_widget_t *p_widget);
+static bool uiDrawBar(ui_widget_t *p_widget, int16_t x, int16_t y, int16_t w, int16_t h);
+static bool uiDrawProgress(ui_widget_t *p_widget);
+
+
+
+
+
+void uiWidgetInvalidate(ui_widget_t *p_widget, uint32_t count)
+{
+  for (int i=0; i<count; i++)
+  {
+    p_widget[i].is_valid = false;
+  }
+}
+
+bool uiWidgetUpdate(ui_widget_t *p_widget, uint32_t count)
+{
+  bool ret = false;
+
+
+  for (int i=0; i<count; i++)
+  {
+    switch(p_widget[i].type)
+    {
+      case UI_WIDGET_LABEL:
+        ret |= uiDrawLabel(&p_widget[i]);
+        break;
+
+      case UI_WIDGET_BAR:
+        ret |= uiDrawBar(&p_widget[i], p_widget[i].x, p_widget[i].y, p_widget[i].w, p_widget[i].h);
+        break;
+
+      case UI_WIDGET_PROGRESS:
+        ret |= uiDrawProgress(&p_widget[i]);
+        break;
+    }
+  }
+
+  return ret;
+}
+
+bool uiDrawLabel(ui_widget_t *p_widget)
+{
+  char text[UI_WIDGET_TEXT_MAX];
+
+
+  text[0] = 0;
+  if (p_widget->getText != NULL)
+  {
+    p_widget->getText(text, sizeof(text));
+  }
+
+  if (p_widget->is_valid == true && strcmp(text, p_widget->last_text) == 0)
+  {
+    return false;
+  }
+
+  lcdDrawFillRect(p_widget->x, p_widget->y, p_widget->w, p_widget->h, UI_BG_COLOR);
+  lcdPrintf(p_widget->x, p_widget->y, p_widget->color, "%s", text);
+
+  strcpy(p_widget->last_text, text);
+  p_widget->is_valid = true;
+
+  return true;
+}
+
+bool uiDrawBar(ui_widget_t *p_widget, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  int32_t value = p_widget->min;
+  int16_t fill;
+
+
+  if (p_widget->getValue != NULL)
+  {
+    value = p_widget->getValue();
+  }
+  value = constrain(value, p_widget->min, p_widget->max);
+
+  // 값이 바뀌어도 채워지는 픽셀 수가 같으면 그리지 않는다.
+  //
+  if (p_widget->max > p_widget->min)
+    fill = (value - p_widget->min) * w / (p_widget->max - p_widget->min);
+  else
+    fill = 0;
+
+  if (p_widget->is_valid == true && fill == p_widget->last_fill)
+  {
+    return false;
+  }
+
+  lcdDrawFillRect(x, y, fill, h, p_widget->color);
+  lcdDrawFillRect(x + fill, y, w - fill, h, UI_BG_COLOR);
+
+  p_widget->last_fill = fill;
+  p_widget->is_valid  = true;
+
+  return true;
+}
+
+bool uiDrawProgress(ui_widget_t *p_widget)
+{
+  // 테두리는 다시 그릴 때만 그리고 안쪽 막대만 값에 따라 바꾼다.
+  //
+  if (p_widget->is_valid != true)
+  {
+    lcdDrawFillRect(p_widget->x, p_widget->y, p_widget->w, p_widget->h, UI_BG_COLOR);
+    lcdDrawRect(p_widget->x, p_widget->y, p_widget->w, p_widget->h, p_widget->color);
+  }
+
+  return uiDrawBar(p_widget, p_widget->x + 2, p_widget->y + 3, p_widget->w - 4, p_widget->h - 6);
+}
@@ -0,0 +1,55 @@
+#ifndef UI_WIDGET_H_
+#define UI_WIDGET_H_
+
+
+#include "ap_def.h"
+
+
+#define UI_WIDGET_TEXT_MAX    24
+
+
+typedef enum
+{
+  UI_WIDGET_LABEL,
+  UI_WIDGET_BAR,
+  UI_WIDGET_PROGRESS,
+} UiWidgetType_t;
+
+
+//-- 위젯은 데이터 소스 함수를 가지고 있고, 마지막으로 그린 값과 다를 때만
+//   자기 영역을 다시 그린다.
+//
+typedef struct
+{
+  UiWidgetType_t type;
+  int16_t  x;
+  int16_t  y;
+  int16_t  w;
+  int16_t  h;
+  uint16_t color;
+  int32_t  min;
+  int32_t  max;
+
+  void    (*getText)(char *p_str, uint32_t length);    // LABEL
+  int32_t (*getValue)(void);                          // BAR, PROGRESS
+
+  bool     is_valid;
+  int16_t  last_fill;
+  char     last_text[UI_WIDGET_TEXT_MAX];
+} ui_widget_t;
+
+
+#define UI_LABEL(x_, y_, w_, h_, func)                  \
+  {.type = UI_WIDGET_LABEL, .x = x_, .y = y_, .w = w_, .h = h_, .color = white, .getText = func}
+
+#define UI_BAR(x_, y_, w_, h_, min_, max_, func)        \
+  {.type = UI_WIDGET_BAR, .x = x_, .y = y_, .w = w_, .h = h_, .color = white, .min = min_, .max = max_, .getValue = func}
+
+#define UI_PROGRESS(x_, y_, w_, h_, min_, max_, func)   \
+  {.type = UI_WIDGET_PROGRESS, .x = x_, .y = y_, .w = w_, .h = h_, .color = white, .min = min_, .max = max_, .getValue = func}
+
+
+void uiWidgetInvalidate(ui_widget_t *p_widget, uint32_t count);
+bool uiWidgetUpdate(ui_widget_t *p_widget, uint32_t count);
+
+#endif
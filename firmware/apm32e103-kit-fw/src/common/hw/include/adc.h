@@ -10,7 +10,23 @@
 #ifdef _USE_HW_ADC
 
 
-#define ADC_MAX_CH    HW_ADC_MAX_CH
+#define ADC_MAX_CH            HW_ADC_MAX_CH
+#define ADC_BLOCK_LEN         HW_ADC_BLOCK_LEN
+#define ADC_OVERSAMPLE_BITS   HW_ADC_OVERSAMPLE_BITS
+#define ADC_DEC_LEN           (ADC_BLOCK_LEN >> ADC_OVERSAMPLE_BITS)
+
+
+//-- DMA 반 버퍼가 찰 때마다 인터럽트에서 넘겨주는 블록
+//   다음 반 버퍼가 찰 때까지만 유효하다.
+//
+typedef struct
+{
+  uint32_t        timestamp;    // 마지막 스캔 시간 (us)
+  uint32_t        count;        // 스캔 수
+  const uint16_t *p_raw;        // [count][ADC_MAX_CH], 12bit
+  uint32_t        dec_count;    // count >> ADC_OVERSAMPLE_BITS
+  const uint16_t *p_dec;        // [dec_count][ADC_MAX_CH], 16bit
+} adc_block_t;
 
 
 bool    adcInit(void);
@@ -23,6 +39,7 @@ int32_t adcRead16(uint8_t ch);
 uint8_t adcGetRes(uint8_t ch);
 float   adcReadVoltage(uint8_t ch);
 float   adcConvVoltage(uint8_t ch, uint32_t adc_value);
+bool    adcSetBlockCallback(void (*p_func)(adc_block_t *p_block));
 
 
 #endif
@@ -6,6 +6,7 @@
 #endif
 
 #include "hw_def.h"
+#include "pbuf.h"
 
 
 #ifdef _USE_HW_CMD
@@ -17,6 +18,10 @@
 #define CMD_OK      0x0000
 
 
+#define CMD_IOCTL_SET_BAUD    0x0001    // p_data : uint32_t baud
+#define CMD_IOCTL_GET_BAUD    0x0002    // p_data : uint32_t baud
+
+
 
 typedef enum CmdType
 {
@@ -38,7 +43,12 @@ typedef struct
   uint16_t  length;
   uint8_t   check_sum;
   uint8_t   check_sum_recv;
+#ifdef _USE_HW_PBUF
+  pbuf_t   *p_pbuf;           // 수신중이거나 처리중인 패킷만 버퍼를 가진다.
+  uint8_t  *buffer;
+#else
   uint8_t   buffer[CMD_MAX_DATA_LENGTH + 10];
+#endif
   uint8_t  *data;
 } cmd_packet_t;
 
@@ -55,6 +65,7 @@ typedef struct cmd_driver_t_
   bool     (*flush)(void *args);
   uint8_t  (*read)(void *args);
   uint32_t (*write)(void *args, uint8_t *p_data, uint32_t length);  
+  bool     (*ioctl)(void *args, uint32_t ctl, void *p_data, uint32_t length);
 } cmd_driver_t;
 
 
@@ -70,6 +81,12 @@ typedef struct
   cmd_driver_t *p_driver;
 
   cmd_packet_t  packet;
+
+#ifdef _USE_HW_PBUF
+  uint32_t  rx_drop_cnt;      // pbuf 가 없어서 버린 수신 패킷
+  uint32_t  tx_drop_cnt;      // pbuf 가 없어서 보내지 못한 패킷
+  uint32_t  drop_log_time;
+#endif
 } cmd_t;
 
 
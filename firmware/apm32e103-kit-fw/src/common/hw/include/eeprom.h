@@ -19,6 +19,8 @@ bool     eepromReadByte(uint32_t addr, uint8_t *p_data);
 bool     eepromWriteByte(uint32_t addr, uint8_t data_in);
 bool     eepromRead(uint32_t addr, uint8_t *p_data, uint32_t length);
 bool     eepromWrite(uint32_t addr, uint8_t *p_data, uint32_t length);
+bool     eepromWriteAsync(uint32_t addr, uint8_t *p_data, uint32_t length);
+bool     eepromIsBusy(void);
 uint32_t eepromGetLength(void);
 bool     eepromFormat(void);
 
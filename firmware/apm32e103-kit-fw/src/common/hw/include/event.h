@@ -20,13 +20,15 @@ typedef bool (*event_func_t)(event_t *);
 
 
 #define eventPub(event_code, event_data)  eventPubFunc(#event_code, event_code, event_data)
-#define eventSub(sub_func)                eventSubFunc(#sub_func, sub_func)
+#define eventSub(event_code, sub_func)    eventSubFunc(#sub_func, event_code, sub_func)
 
 
 bool eventInit(void);
 bool eventUpdate(void);
-bool eventSubFunc(const char *p_name, event_func_t sub_func);
-bool eventPubFunc(const char *p_name, EventCode_t event_code, uint32_t event_data);
+bool eventSubFunc(const char *p_name, EventCode_t event_code, event_func_t sub_func);
+bool eventPubFunc(const char *p_name, EventCode_t event_code, uint32_t event_data);  // ISR 에서 호출 가능
+void eventSetLog(EventCode_t event_code, bool enable);                              // EVENT_MAX 이면 전체
+uint32_t eventGetOverflow(void);
 
 #endif
 
@@ -18,11 +18,15 @@ typedef struct
 
   int16_t temp_x100;
   int16_t humidity_x100;
+
+  uint32_t count;             // 측정 횟수, 새 측정인지 구분한다.
+  uint32_t time_us;           // 측정 결과를 받은 시각 (micros)
 } hdc1080_info_t;
 
 
 bool hdc1080Init(void);
 bool hdc1080IsInit(void);
+bool hdc1080Update(void);
 bool hdc1080GetInfo(hdc1080_info_t *p_info);
 
 #endif
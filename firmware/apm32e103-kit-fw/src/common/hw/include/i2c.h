@@ -12,6 +12,47 @@
 #define I2C_MAX_CH       HW_I2C_MAX_CH
 
 
+#define I2C_PRIO_HIGH    0
+#define I2C_PRIO_NORMAL  1
+#define I2C_PRIO_LOW     2
+#define I2C_PRIO_MAX     3
+
+
+typedef enum
+{
+  I2C_XFER_IDLE,
+  I2C_XFER_QUEUED,
+  I2C_XFER_ACTIVE,
+  I2C_XFER_DONE,
+} I2cXferState_t;
+
+typedef struct i2c_xfer_t_ i2c_xfer_t;
+
+//-- 큐에 넣는 전송 단위. 완료될 때까지 호출한 쪽이 메모리를 유지해야 하며
+//   func 는 인터럽트 안에서 호출된다.
+//
+struct i2c_xfer_t_
+{
+  uint8_t   dev_addr;
+  bool      is_read;
+  uint8_t   reg_size;         // 0, 1, 2 byte
+  uint8_t   prio;             // I2C_PRIO_xx
+  uint16_t  reg_addr;
+  uint16_t  length;
+  uint8_t  *p_data;
+  uint32_t  timeout;          // ms
+  bool      is_probe;         // ACK 확인용, NACK 를 에러로 세지 않는다
+
+  void    (*func)(i2c_xfer_t *p_xfer, bool ret);
+  void     *arg;
+
+  volatile I2cXferState_t state;
+  bool        ret;
+  uint32_t    submit_us;
+  i2c_xfer_t *p_next;
+};
+
+
 bool i2cInit(void);
 bool i2cIsInit(void);
 bool i2cBegin(uint8_t ch, uint32_t freq_khz);
@@ -30,6 +71,11 @@ bool i2cWriteA16Bytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t
 bool i2cReadData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout);
 bool i2cWriteData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout);
 
+bool i2cSubmit(uint8_t ch, i2c_xfer_t *p_xfer);
+bool i2cSetPriority(uint8_t ch, uint8_t dev_addr, uint8_t prio);
+bool i2cIsBusy(uint8_t ch);
+void i2cUpdate(void);
+
 
 void     i2cSetTimeout(uint8_t ch, uint32_t timeout);
 uint32_t i2cGetTimeout(uint8_t ch);
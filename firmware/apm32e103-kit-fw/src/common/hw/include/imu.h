@@ -30,11 +30,23 @@ typedef struct
   int16_t g_raw[3];
 } imu_info_t;
 
+typedef struct
+{
+  uint32_t timestamp;     // us, micros() 기준 (간격은 센서 클럭)
+  int16_t  a_raw[3];
+  int16_t  g_raw[3];
+
+  int16_t  roll_x100;
+  int16_t  pitch_x100;
+  int16_t  yaw_x100;
+} imu_sample_t;
+
 bool imuInit(void);
 bool imuIsInit(void);
 bool imuBegin(void);
 bool imuUpdate(void);
 bool imuGetInfo(imu_info_t *p_info);
+bool imuSetSampleCallback(void (*p_func)(imu_sample_t *p_sample));
 
 
 #ifdef __cplusplus
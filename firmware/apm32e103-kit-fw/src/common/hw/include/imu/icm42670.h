@@ -11,6 +11,8 @@
 #ifdef _USE_HW_ICM42670
 
 
+#define ICM42670_FIFO_READ_MAX    16      // 한번에 읽는 최대 샘플 수
+
 
 typedef struct
 {
@@ -24,7 +26,7 @@ typedef struct
 
   int16_t temp;
 
-  uint32_t timestamp;
+  uint32_t timestamp;     // us, micros() 기준. FIFO 샘플 간격은 센서 클럭
   uint16_t acc_scale;
   uint16_t gyro_scale;
 } icm42670_info_t;
@@ -32,6 +34,8 @@ typedef struct
 
 bool icm42670Init(void);
 bool icm42670GetInfo(icm42670_info_t *p_info);
+uint32_t icm42670ReadFifo(icm42670_info_t *p_info, uint32_t max_count);
+bool icm42670StartFifo(void);
 
 
 #endif
@@ -234,6 +234,36 @@
 #define ICM42670_FIFO_BYPASS_BITS                 0x01 // ICM42670_REG_FIFO_CONFIG1<0>
 #define ICM42670_FIFO_BYPASS_SHIFT                0    // ICM42670_REG_FIFO_CONFIG1<0>
 
+#define ICM42670_TMST_RES_BITS                    0x08 // ICM42670_REG_TMST_CONFIG1<3>
+#define ICM42670_TMST_RES_SHIFT                   3    // ICM42670_REG_TMST_CONFIG1<3>
+#define ICM42670_TMST_DELTA_EN_BITS               0x04 // ICM42670_REG_TMST_CONFIG1<2>
+#define ICM42670_TMST_DELTA_EN_SHIFT              2    // ICM42670_REG_TMST_CONFIG1<2>
+#define ICM42670_TMST_FSYNC_EN_BITS               0x02 // ICM42670_REG_TMST_CONFIG1<1>
+#define ICM42670_TMST_FSYNC_EN_SHIFT              1    // ICM42670_REG_TMST_CONFIG1<1>
+#define ICM42670_TMST_EN_BITS                     0x01 // ICM42670_REG_TMST_CONFIG1<0>
+#define ICM42670_TMST_EN_SHIFT                    0    // ICM42670_REG_TMST_CONFIG1<0>
+
+#define ICM42670_FIFO_WM_GT_TH_BITS               0x20 // ICM42670_REG_FIFO_CONFIG5<5>
+#define ICM42670_FIFO_WM_GT_TH_SHIFT              5    // ICM42670_REG_FIFO_CONFIG5<5>
+#define ICM42670_FIFO_HIRES_EN_BITS               0x08 // ICM42670_REG_FIFO_CONFIG5<3>
+#define ICM42670_FIFO_HIRES_EN_SHIFT              3    // ICM42670_REG_FIFO_CONFIG5<3>
+#define ICM42670_FIFO_TMST_FSYNC_EN_BITS          0x04 // ICM42670_REG_FIFO_CONFIG5<2>
+#define ICM42670_FIFO_TMST_FSYNC_EN_SHIFT         2    // ICM42670_REG_FIFO_CONFIG5<2>
+#define ICM42670_FIFO_GYRO_EN_BITS                0x02 // ICM42670_REG_FIFO_CONFIG5<1>
+#define ICM42670_FIFO_GYRO_EN_SHIFT               1    // ICM42670_REG_FIFO_CONFIG5<1>
+#define ICM42670_FIFO_ACCEL_EN_BITS               0x01 // ICM42670_REG_FIFO_CONFIG5<0>
+#define ICM42670_FIFO_ACCEL_EN_SHIFT              0    // ICM42670_REG_FIFO_CONFIG5<0>
+
+  // FIFO packet header
+#define ICM42670_FIFO_HEADER_MSG_BITS             0x80 // FIFO 가 비었음
+#define ICM42670_FIFO_HEADER_ACCEL_BITS           0x40
+#define ICM42670_FIFO_HEADER_GYRO_BITS            0x20
+#define ICM42670_FIFO_HEADER_20_BITS              0x10
+#define ICM42670_FIFO_HEADER_TMST_BITS            0x0C // 0b10 : ODR timestamp
+#define ICM42670_FIFO_HEADER_TMST_ODR             0x08
+#define ICM42670_FIFO_PACKET_SIZE                 16   // header, accel, gyro, temp, timestamp
+#define ICM42670_FIFO_SIZE                        2304
+
 #define ICM42670_ST_INT1_EN_BITS                  0x80 // ICM42670_REG_INT_SOURCE0<7>
 #define ICM42670_ST_INT1_EN_SHIFT                 7    // ICM42670_REG_INT_SOURCE0<7>
 #define ICM42670_FSYNC_INT1_EN_BITS               0x40 // ICM42670_REG_INT_SOURCE0<6>
@@ -0,0 +1,57 @@
+#ifndef INIT_H_
+#define INIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_INIT
+
+
+#define INIT_MAX              HW_INIT_MAX
+
+#define INIT_BIT(id)          (1UL<<(id))
+
+
+typedef enum
+{
+  INIT_MODE_NOW,              // apMain() 전에 완료
+  INIT_MODE_LATER,            // 메인 루프에서 initUpdate()로 완료
+} InitMode_t;
+
+typedef enum
+{
+  INIT_STATE_WAIT,
+  INIT_STATE_BUSY,
+  INIT_STATE_OK,
+  INIT_STATE_FAIL,
+  INIT_STATE_SKIP,            // 의존 항목이 실패해서 실행하지 않음
+} InitState_t;
+
+typedef struct
+{
+  const char *name;
+  InitMode_t  mode;
+  uint32_t    depend;         // 먼저 완료되어야 하는 항목, INIT_BIT(id)
+  bool      (*init)(void);    // 한번 호출, 끝날 때까지 메인 루프를 잡고 있는다
+  bool      (*update)(void);  // NULL 이 아니면 true 를 반환할 때까지 호출
+} init_tbl_t;
+
+
+bool        initBegin(const init_tbl_t *p_tbl, uint32_t count);
+bool        initUpdate(void);
+bool        initIsDone(uint32_t id);
+bool        initIsAllDone(void);
+InitState_t initGetState(uint32_t id);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
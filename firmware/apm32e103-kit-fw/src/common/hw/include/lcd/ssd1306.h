@@ -19,6 +19,13 @@
 bool ssd1306Init(void);
 bool ssd1306InitDriver(lcd_driver_t *p_driver);
 
+void     ssd1306DrawPixel(int16_t x, int16_t y, uint16_t color);
+uint16_t ssd1306ReadPixel(int16_t x, int16_t y);
+void     ssd1306DrawSpan(int16_t x, int16_t y, int16_t w, uint16_t color);
+void     ssd1306FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void     ssd1306Fill(uint16_t color);
+uint32_t ssd1306GetTxBytes(void);
+
 #endif
 
 
@@ -15,6 +15,36 @@ extern "C" {
 #define LOG_BOOT_BUF_MAX  HW_LOG_BOOT_BUF_MAX
 #define LOG_LIST_BUF_MAX  HW_LOG_LIST_BUF_MAX
 
+#ifdef _USE_HW_LOG_BIN
+#define LOG_BIN_Q_MAX     HW_LOG_BIN_Q_MAX
+#define LOG_BIN_ARG_MAX   HW_LOG_BIN_ARG_MAX
+
+
+//-- 포맷 문자열의 플래시 주소와 인자만 기록하고 문자열 변환은 나중에 한다.
+//   인자는 uint32_t 로 저장되므로 정수와 상수 문자열(%s) 만 사용할 수 있다.
+//
+#define logBinPrintf(fmt, ...)                                                    \
+  do {                                                                            \
+    static const char log_bin_fmt[] = fmt;                                        \
+    const uint32_t log_bin_arg[] = {0, ##__VA_ARGS__};                            \
+    logBinWrite(log_bin_fmt, sizeof(log_bin_arg)/sizeof(uint32_t) - 1, &log_bin_arg[1]); \
+  } while(0)
+
+
+typedef struct
+{
+  uint32_t fmt;                       // 포맷 문자열 주소
+  uint32_t time_us;
+  uint32_t argc;
+  uint32_t arg[LOG_BIN_ARG_MAX];
+} log_bin_t;
+
+bool     logBinWrite(const char *fmt, uint32_t argc, const uint32_t *p_arg);   // ISR 에서 호출 가능
+bool     logBinRead(log_bin_t *p_log);
+void     logBinSetHost(bool enable);
+uint32_t logBinGetDrop(void);
+#endif
+
 
 bool logInit(void);
 void logEnable(void);
@@ -22,6 +52,7 @@ void logDisable(void);
 bool logOpen(uint8_t ch, uint32_t baud);
 void logBoot(uint8_t enable);
 void logPrintf(const char *fmt, ...);
+void logUpdate(void);
 
 #endif
 
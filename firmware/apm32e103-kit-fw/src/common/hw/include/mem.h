@@ -0,0 +1,63 @@
+#ifndef MEM_H_
+#define MEM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_MEM
+
+
+#define MEM_BUF_MAX           HW_MEM_BUF_MAX
+
+
+typedef struct
+{
+  const char *name;
+  void       *p_buf;
+  uint32_t    size;
+} mem_buf_t;
+
+typedef struct
+{
+  uint32_t ram_size;
+  uint32_t flash_size;      // 펌웨어 이미지 크기
+  uint32_t data_size;
+  uint32_t bss_size;
+  uint32_t noinit_size;
+  uint32_t buf_size;        // 등록된 정적 버퍼 합계
+
+  uint32_t heap_size;       // sbrk 로 늘어난 크기
+  uint32_t heap_used;       // malloc 으로 사용중인 크기
+
+  uint32_t stack_used;      // 스택 최대 사용량(high-water mark)
+  uint32_t stack_free;      // 힙 끝부터 스택 최대 사용 위치까지 남은 크기
+} mem_info_t;
+
+
+//-- 모듈의 정적 버퍼를 등록한다. _USE_HW_MEM 이 없으면 아무 것도 하지 않는다.
+//
+#define MEM_BUF_ADD(name, buf)    memAddBuf(name, (void *)(buf), sizeof(buf))
+
+
+bool     memInit(void);
+bool     memAddBuf(const char *name, void *p_buf, uint32_t size);
+uint32_t memGetBufCount(void);
+bool     memGetBuf(uint32_t index, mem_buf_t *p_buf);
+bool     memGetInfo(mem_info_t *p_info);
+
+#else
+
+#define MEM_BUF_ADD(name, buf)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
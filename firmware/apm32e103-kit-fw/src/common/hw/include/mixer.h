@@ -21,6 +21,8 @@ extern "C" {
 
 #define MIXER_MAX_CH        HW_MIXER_MAX_CH
 #define MIXER_MAX_BUF_LEN   HW_MIXER_MAX_BUF_LEN
+#define MIXER_BLOCK_LEN     64        // mixerRead 에서 한번에 더하는 샘플 수
+#define MIXER_GAIN_UNITY    (1 << 15) // Q15 1.0
 
 
 
@@ -35,6 +37,7 @@ typedef struct
 typedef struct
 {
   int32_t volume;
+  int32_t gain;       // volume 을 Q15 로 바꾼 값
   mixer_buf_t buf[MIXER_MAX_CH];
 } mixer_t;
 
@@ -0,0 +1,43 @@
+#ifndef MPOOL_H_
+#define MPOOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_MPOOL
+
+
+#define MPOOL_DEBUG           HW_MPOOL_DEBUG
+
+
+typedef struct
+{
+  const char *name;
+  uint16_t    block_size;
+  uint16_t    block_cnt;
+  uint16_t    used;
+  uint16_t    used_max;
+  uint32_t    alloc_cnt;
+  uint32_t    fail_cnt;
+  uint32_t    err_cnt;        // 잘못된 주소 또는 이중 해제
+} mpool_info_t;
+
+
+bool     mpoolInit(void);
+void    *mpoolAlloc(size_t size);
+void     mpoolFree(void *p_mem);
+uint32_t mpoolGetCount(void);
+bool     mpoolGetInfo(uint32_t index, mpool_info_t *p_info);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef PBUF_H_
+#define PBUF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_PBUF
+
+
+#define PBUF_MAX              HW_PBUF_MAX
+#define PBUF_LENGTH           HW_PBUF_LENGTH
+
+
+typedef struct
+{
+  uint8_t  *p_buf;
+  uint16_t  size;
+  uint16_t  length;           // 사용하는 쪽에서 채운 데이터 길이
+  uint8_t   ref;
+} pbuf_t;
+
+
+bool     pbufInit(void);
+pbuf_t  *pbufAlloc(void);
+pbuf_t  *pbufRef(pbuf_t *p_pbuf);
+void     pbufFree(pbuf_t *p_pbuf);
+uint32_t pbufGetFree(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PERF_H_
+#define PERF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_PERF
+
+#ifndef HW_PERF_HOST
+#define HW_PERF_HOST          0
+#endif
+
+#if HW_PERF_HOST == 1
+#include <time.h>
+#endif
+
+
+#define PERF_BIN_MAX          HW_PERF_BIN_MAX
+#define PERF_BIN_SHIFT        HW_PERF_BIN_SHIFT   // 첫번째 구간은 2^(SHIFT+1) cycle 미만
+
+
+typedef struct perf_t_ perf_t;
+
+typedef struct perf_t_
+{
+  const char *name;
+  bool        is_reg;
+  perf_t     *next;
+
+  uint32_t    count;
+  uint32_t    min;
+  uint32_t    max;
+  uint64_t    sum;
+  uint32_t    bin[PERF_BIN_MAX];
+} perf_t;
+
+typedef struct
+{
+  perf_t   *p_perf;
+  uint32_t  start;
+} perf_scope_t;
+
+
+//-- 함수 시작에 PERF_SCOPE("name") 을 넣으면 범위를 벗어날 때 자동으로 측정이 끝난다.
+//
+#define PERF_SCOPE(scope_name)                                                      \
+  static perf_t perf_scope_data = {.name = scope_name};                             \
+  perf_scope_t  perf_scope __attribute__((cleanup(perfScopeEnd), unused))           \
+                = perfScopeBegin(&perf_scope_data)
+
+
+bool     perfInit(void);
+void     perfAdd(perf_t *p_perf, uint32_t cycle);
+void     perfClear(void);
+perf_t  *perfGetList(void);
+uint32_t perfGetBinCycle(uint8_t bin);
+
+
+//-- 타겟은 DWT cycle, PC(HW_PERF_HOST)는 clock_gettime 의 ns 를 cycle 대신 쓴다.
+//
+static inline __attribute__((always_inline)) uint32_t perfGetCycle(void)
+{
+#if HW_PERF_HOST == 1
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#else
+  return DWT->CYCCNT;
+#endif
+}
+
+static inline __attribute__((always_inline)) perf_scope_t perfScopeBegin(perf_t *p_perf)
+{
+  perf_scope_t scope;
+
+  scope.p_perf = p_perf;
+  scope.start  = perfGetCycle();
+  return scope;
+}
+
+static inline __attribute__((always_inline)) void perfScopeEnd(perf_scope_t *p_scope)
+{
+  perfAdd(p_scope->p_perf, perfGetCycle() - p_scope->start);
+}
+
+#else
+
+#define PERF_SCOPE(scope_name)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,7 +10,7 @@ extern "C" {
 
 #ifdef _USE_HW_SWTIMER
 
-#define _HW_DEF_SW_TIMER_MAX        HW_SWTIMER_MAX_CH
+#define _HW_DEF_SW_TIMER_MAX        HW_SWTIMER_MAX_CH    // 최대 32
 
 
 typedef enum
@@ -30,10 +30,13 @@ void swtimerSet  (swtimer_handle_t handle, uint32_t period_ms, SwtimerMode_t mod
 void swtimerStart(swtimer_handle_t handle);
 void swtimerStop (swtimer_handle_t handle);
 void swtimerReset(swtimer_handle_t handle);
+void swtimerSetDefer(swtimer_handle_t handle, bool enable);
 void swtimerISR(void);
+void swtimerUpdate(void);
 
 
 swtimer_handle_t swtimerGetHandle(void);
+bool swtimerReleaseHandle(swtimer_handle_t handle);
 uint32_t swtimerGetCounter(void);
 
 #endif
@@ -0,0 +1,72 @@
+#ifndef TASK_H_
+#define TASK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "hw_def.h"
+
+
+#ifdef _USE_HW_TASK
+
+
+#define TASK_MAX_CH           HW_TASK_MAX_CH
+
+
+typedef enum
+{
+  TASK_MODE_LOOP,             // 매 라운드마다 실행
+  TASK_MODE_PERIOD,           // period_ms 마다 실행
+  TASK_MODE_EVENT,            // taskSignal() 호출시 실행
+} TaskMode_t;
+
+
+typedef int8_t task_handle_t;
+
+typedef struct
+{
+  const char *name;
+  TaskMode_t  mode;
+  uint8_t     priority;       // 0 이 가장 높음
+  uint32_t    period_ms;
+  uint32_t    deadline_us;
+
+  uint32_t    run_cnt;
+  uint32_t    overrun_cnt;    // 주기를 놓친 횟수 (PERIOD)
+  uint32_t    miss_cnt;       // deadline 을 넘긴 횟수
+  uint32_t    exe_min;
+  uint32_t    exe_avg;
+  uint32_t    exe_max;
+} task_info_t;
+
+typedef struct
+{
+  uint16_t    load;           // 최근 1초 CPU 사용률, 0.1% 단위
+  uint16_t    load_max;
+  uint32_t    busy_us;
+  uint32_t    idle_us;
+  uint32_t    sleep_cnt;      // WFI 진입 횟수
+} task_load_t;
+
+
+bool          taskInit(void);
+task_handle_t taskAdd(const char *name, void (*func)(void), uint8_t priority, TaskMode_t mode, uint32_t period_ms, uint32_t deadline_us);
+void          taskSignal(task_handle_t handle);
+void          taskSetBusy(void);
+bool          taskUpdate(void);
+void          taskIdle(void);
+void          taskSetSleep(bool enable);
+bool          taskGetLoad(task_load_t *p_load);
+uint32_t      taskGetCount(void);
+bool          taskGetInfo(task_handle_t handle, task_info_t *p_info);
+void          taskClearInfo(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,9 +22,14 @@ uint32_t uartAvailable(uint8_t ch);
 bool     uartFlush(uint8_t ch);
 uint8_t  uartRead(uint8_t ch);
 uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length);
+uint32_t uartWriteAsync(uint8_t ch, uint8_t *p_data, uint32_t length);
+uint32_t uartTxFree(uint8_t ch);
+bool     uartWaitTxDone(uint8_t ch, uint32_t timeout);
 uint32_t uartPrintf(uint8_t ch, const char *fmt, ...);
 uint32_t uartVPrintf(uint8_t ch, const char *fmt, va_list arg);
 uint32_t uartGetBaud(uint8_t ch);
+void     uartSetRxCallback(uint8_t ch, void (*func)(uint8_t ch, uint32_t length));   // ISR 에서 호출됨
+uint32_t uartGetRxOverrun(uint8_t ch);
 uint32_t uartGetRxCnt(uint8_t ch);
 uint32_t uartGetTxCnt(uint8_t ch);
 
@@ -219,7 +219,7 @@ bool cliMain(void)
     return false;
   }
 
-  if (uartAvailable(cli_node.ch) > 0)
+  while (uartAvailable(cli_node.ch) > 0)
   {
     cliUpdate(&cli_node, uartRead(cli_node.ch));
   }
@@ -742,6 +742,8 @@ bool cliAdd(const char *cmd_str, void (*p_func)(cli_args_t *))
 
   if (p_cli->cmd_count >= CLI_CMD_LIST_MAX)
   {
+    // 명령이 조용히 빠지지 않도록 남긴다. HW_CLI_CMD_LIST_MAX 를 늘린다.
+    logPrintf("[E_] cliAdd() %s : cmd list full (%d)\n", cmd_str, CLI_CMD_LIST_MAX);
     return false;
   }
 
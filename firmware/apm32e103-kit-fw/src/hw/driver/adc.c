@@ -5,10 +5,17 @@
 #ifdef _USE_HW_ADC
 #include "cli.h"
 #include "cli_gui.h"
+#include "perf.h"
 
 
 #define NAME_DEF(x)  x, #x
 
+#if ADC_OVERSAMPLE_BITS > 4 || (ADC_BLOCK_LEN % (1 << ADC_OVERSAMPLE_BITS)) != 0
+#error "ADC_BLOCK_LEN must be a multiple of 2^ADC_OVERSAMPLE_BITS (bits <= 4)"
+#endif
+
+#define ADC_DMA_LEN   (2 * ADC_BLOCK_LEN * ADC_MAX_CH)
+
 #ifdef _USE_HW_RTOS
 #define lock()      xSemaphoreTake(mutex_lock, portMAX_DELAY);
 #define unLock()    xSemaphoreGive(mutex_lock);
@@ -35,6 +42,10 @@ typedef struct
 static void cliAdc(cli_args_t *args);
 #endif
 static bool adcInitHw(void);
+#if HW_ADC_SAMPLE_HZ > 0
+static void adcInitTimer(void);
+#endif
+static void adcProcessBlock(const uint16_t *p_raw);
 
 
 
@@ -43,14 +54,25 @@ static SemaphoreHandle_t mutex_lock;
 #endif
 static bool is_init = false;
 
-static uint16_t adc_data_buf[ADC_MAX_CH];
+static volatile uint16_t adc_data_buf[ADC_MAX_CH];     // 오버샘플링한 16bit 값
 static int32_t adc_cali = 4095/4;
 
+static uint16_t adc_dma_buf[ADC_DMA_LEN];
+static uint16_t adc_dec_buf[ADC_DEC_LEN * ADC_MAX_CH];
+static adc_block_t adc_block;
+static void (*block_func)(adc_block_t *p_block) = NULL;
+
+static volatile uint32_t block_cnt     = 0;
+static volatile uint32_t block_overrun = 0;
+static volatile uint32_t block_cycle   = 0;
+
 static ADC_Config_T  adc1_cfg;  
 
 static adc_tbl_t adc_tbl[ADC_MAX_CH] = 
   {
-    {ADC1, &adc1_cfg, ADC_CHANNEL_8, 1, DMA1_Channel1, NAME_DEF(LIGHT_ADC)},
+    {ADC1, &adc1_cfg, ADC_CHANNEL_8,  1, DMA1_Channel1, NAME_DEF(LIGHT_ADC)},
+    {ADC1, &adc1_cfg, ADC_CHANNEL_16, 2, DMA1_Channel1, NAME_DEF(TEMP_ADC)},
+    {ADC1, &adc1_cfg, ADC_CHANNEL_17, 3, DMA1_Channel1, NAME_DEF(VREF_ADC)},
   };
 
 
@@ -68,17 +90,29 @@ bool adcInit(void)
 
   ADC_Reset(ADC1);
 
+  // 채널 전체를 스캔해서 DMA 원형 버퍼에 쌓는다.
+  // HW_ADC_SAMPLE_HZ 가 있으면 TMR2 CC2 마다 한번 스캔한다.
+  //
   ADC_ConfigStructInit(&adc1_cfg);
   adc1_cfg.mode              = ADC_MODE_INDEPENDENT;
-  adc1_cfg.scanConvMode      = DISABLE;
+  adc1_cfg.scanConvMode      = ENABLE;
+#if HW_ADC_SAMPLE_HZ > 0
+  adc1_cfg.continuosConvMode = DISABLE;
+  adc1_cfg.externalTrigConv  = ADC_EXT_TRIG_CONV_TMR2_CC2;
+#else
   adc1_cfg.continuosConvMode = ENABLE;
   adc1_cfg.externalTrigConv  = ADC_EXT_TRIG_CONV_None;
+#endif
   adc1_cfg.dataAlign         = ADC_DATA_ALIGN_RIGHT;
-  adc1_cfg.nbrOfChannel      = 1;
+  adc1_cfg.nbrOfChannel      = ADC_MAX_CH;
   ADC_Config(ADC1, &adc1_cfg);
 
   /* ADC channel Convert configuration */
-  ADC_ConfigRegularChannel(ADC1, ADC_CHANNEL_8, 1, ADC_SAMPLETIME_239CYCLES5);
+  for (int i=0; i<ADC_MAX_CH; i++)
+  {
+    ADC_ConfigRegularChannel(ADC1, adc_tbl[i].channel, adc_tbl[i].rank, ADC_SAMPLETIME_239CYCLES5);
+  }
+  ADC_EnableTempSensorVrefint(ADC1);
 
   /* Enable ADC DMA */
   ADC_EnableDMA(ADC1);
@@ -93,8 +127,13 @@ bool adcInit(void)
   ADC_StartCalibration(ADC1);
   while (ADC_ReadCalibrationStartFlag(ADC1));
 
+#if HW_ADC_SAMPLE_HZ > 0
+  ADC_EnableExternalTrigConv(ADC1);
+  adcInitTimer();
+#else
   /* Start ADC1 Software Conversion */
   ADC_EnableSoftwareStartConv(ADC1);
+#endif
 
 
   is_init = ret;
@@ -136,11 +175,11 @@ bool adcInitHw(void)
 
   /* DMA config */
   dmaConfig.peripheralBaseAddr = ((uint32_t)ADC1_BASE + 0x4C);
-  dmaConfig.memoryBaseAddr     = (uint32_t)adc_data_buf;
+  dmaConfig.memoryBaseAddr     = (uint32_t)adc_dma_buf;
   dmaConfig.dir                = DMA_DIR_PERIPHERAL_SRC;
-  dmaConfig.bufferSize         = ADC_MAX_CH;
+  dmaConfig.bufferSize         = ADC_DMA_LEN;
   dmaConfig.peripheralInc      = DMA_PERIPHERAL_INC_DISABLE;
-  dmaConfig.memoryInc          = DMA_MEMORY_INC_DISABLE;
+  dmaConfig.memoryInc          = DMA_MEMORY_INC_ENABLE;
   dmaConfig.peripheralDataSize = DMA_PERIPHERAL_DATA_SIZE_HALFWORD;
   dmaConfig.memoryDataSize     = DMA_MEMORY_DATA_SIZE_HALFWORD;
   dmaConfig.loopMode           = DMA_MODE_CIRCULAR;
@@ -150,12 +189,56 @@ bool adcInitHw(void)
   /* Enable DMA channel */
   DMA_Config(DMA1_Channel1, &dmaConfig);
 
+  /* 반 버퍼, 전체 버퍼 인터럽트 */
+  DMA_EnableInterrupt(DMA1_Channel1, DMA_INT_HT | DMA_INT_TC);
+  NVIC_EnableIRQRequest(DMA1_Channel1_IRQn, 2, 0);
+
   /* Enable DMA */
   DMA_Enable(DMA1_Channel1);
 
   return true;
 }
 
+#if HW_ADC_SAMPLE_HZ > 0
+void adcInitTimer(void)
+{
+  TMR_BaseConfig_T TMR_TimeBaseStruct;
+  TMR_OCConfig_T   OCcongigStruct;
+
+
+  RCM_EnableAPB1PeriphClock(RCM_APB1_PERIPH_TMR2);
+
+  TMR_Reset(TMR2);
+
+  // 1MHz 로 세어서 HW_ADC_SAMPLE_HZ 마다 CC2 이벤트를 만든다.
+  //
+  TMR_TimeBaseStruct.clockDivision = TMR_CLOCK_DIV_1;
+  TMR_TimeBaseStruct.countMode     = TMR_COUNTER_MODE_UP;
+  TMR_TimeBaseStruct.division      = SystemCoreClock/1000000 - 1;
+  TMR_TimeBaseStruct.period        = 1000000/HW_ADC_SAMPLE_HZ - 1;
+  TMR_ConfigTimeBase(TMR2, &TMR_TimeBaseStruct);
+
+  OCcongigStruct.idleState    = TMR_OC_IDLE_STATE_RESET;
+  OCcongigStruct.mode         = TMR_OC_MODE_PWM1;
+  OCcongigStruct.nIdleState   = TMR_OC_NIDLE_STATE_RESET;
+  OCcongigStruct.nPolarity    = TMR_OC_NPOLARITY_HIGH;
+  OCcongigStruct.outputNState = TMR_OC_NSTATE_DISABLE;
+  OCcongigStruct.outputState  = TMR_OC_STATE_ENABLE;
+  OCcongigStruct.polarity     = TMR_OC_POLARITY_LOW;
+  OCcongigStruct.pulse        = 1000000/HW_ADC_SAMPLE_HZ/2;
+  TMR_ConfigOC2(TMR2, &OCcongigStruct);
+
+  TMR_EnableAutoReload(TMR2);
+  TMR_Enable(TMR2);
+}
+#endif
+
+bool adcSetBlockCallback(void (*p_func)(adc_block_t *p_block))
+{
+  block_func = p_func;
+  return true;
+}
+
 bool adcIsInit(void)
 {
   return is_init;
@@ -163,7 +246,7 @@ bool adcIsInit(void)
 
 int32_t adcRead(uint8_t ch)
 {
-  return adc_data_buf[ch];
+  return adc_data_buf[ch] >> 4;
 }
 
 int32_t adcRead8(uint8_t ch)
@@ -183,7 +266,7 @@ int32_t adcRead12(uint8_t ch)
 
 int32_t adcRead16(uint8_t ch)
 {
-  return adcRead(ch)<<4;  
+  return adc_data_buf[ch];
 }
 
 uint8_t adcGetRes(uint8_t ch)
@@ -212,6 +295,80 @@ float adcConvVoltage(uint8_t ch, uint32_t adc_value)
 }
 
 
+// 반 버퍼 하나를 2^ADC_OVERSAMPLE_BITS 개씩 더해서 16bit 로 줄인다.
+//   12bit 샘플 16개의 합이 16bit 를 넘지 않으므로 나누지 않고 비트만 맞춘다.
+//
+void adcProcessBlock(const uint16_t *p_raw)
+{
+#ifdef _USE_HW_PERF
+  uint32_t pre_cycle = perfGetCycle();
+#endif
+  uint32_t sum[ADC_MAX_CH];
+  uint16_t *p_dec = adc_dec_buf;
+  const uint16_t *p_src = p_raw;
+
+
+  for (int d=0; d<ADC_DEC_LEN; d++)
+  {
+    for (int ch=0; ch<ADC_MAX_CH; ch++)
+      sum[ch] = 0;
+
+    for (int i=0; i<(1 << ADC_OVERSAMPLE_BITS); i++)
+    {
+      for (int ch=0; ch<ADC_MAX_CH; ch++)
+        sum[ch] += p_src[ch];
+      p_src += ADC_MAX_CH;
+    }
+
+    for (int ch=0; ch<ADC_MAX_CH; ch++)
+      p_dec[ch] = (uint16_t)(sum[ch] << (4 - ADC_OVERSAMPLE_BITS));
+    p_dec += ADC_MAX_CH;
+  }
+
+  p_dec -= ADC_MAX_CH;
+  for (int ch=0; ch<ADC_MAX_CH; ch++)
+  {
+    adc_data_buf[ch] = p_dec[ch];
+  }
+
+  if (block_func != NULL)
+  {
+    adc_block.timestamp = micros();
+    adc_block.count     = ADC_BLOCK_LEN;
+    adc_block.p_raw     = p_raw;
+    adc_block.dec_count = ADC_DEC_LEN;
+    adc_block.p_dec     = adc_dec_buf;
+    block_func(&adc_block);
+  }
+
+  block_cnt++;
+#ifdef _USE_HW_PERF
+  block_cycle = perfGetCycle() - pre_cycle;
+#endif
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+  bool is_ht = DMA_ReadIntFlag(DMA1_INT_FLAG_HT1);
+  bool is_tc = DMA_ReadIntFlag(DMA1_INT_FLAG_TC1);
+
+
+  DMA_ClearIntFlag(DMA1_INT_FLAG_HT1 | DMA1_INT_FLAG_TC1);
+
+  // 둘 다 있으면 처리가 늦어 반 버퍼 하나를 놓친 것이다.
+  if (is_ht && is_tc)
+  {
+    block_overrun++;
+    is_ht = false;
+  }
+
+  if (is_ht)
+    adcProcessBlock(&adc_dma_buf[0]);
+  if (is_tc)
+    adcProcessBlock(&adc_dma_buf[ADC_DMA_LEN/2]);
+}
+
+
 #if CLI_USE(HW_ADC)
 void cliAdc(cli_args_t *args)
 {
@@ -222,6 +379,12 @@ void cliAdc(cli_args_t *args)
   {
     cliPrintf("adc init : %d\n", is_init);
     cliPrintf("adc res  : %d\n", adcGetRes(0));
+    cliPrintf("adc rate : %d Hz, %s\n", HW_ADC_SAMPLE_HZ, HW_ADC_SAMPLE_HZ > 0 ? "TMR2":"continuous");
+    cliPrintf("adc os   : x%d\n", 1 << ADC_OVERSAMPLE_BITS);
+    cliPrintf("block    : %d scan, %d cnt, %d overrun\n", ADC_BLOCK_LEN, block_cnt, block_overrun);
+#ifdef _USE_HW_PERF
+    cliPrintf("block    : %d cycle, %d us\n", block_cycle, block_cycle / (SystemCoreClock / 1000000));
+#endif
     for (int i=0; i<ADC_MAX_CH; i++)
     {
       cliPrintf("%02d. %-32s : %04d\n", i, adc_tbl[i].p_name, adcRead(i));
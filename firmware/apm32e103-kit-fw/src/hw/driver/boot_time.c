@@ -0,0 +1,173 @@
+#include "boot_time.h"
+
+
+#ifdef _USE_HW_BOOT_TIME
+#include "cli.h"
+
+
+#define BOOT_TIME_MAGIC       0x424F4F54    // "BOOT"
+
+
+typedef struct
+{
+  char     name[BOOT_TIME_NAME_MAX];
+  uint8_t  image;
+  uint32_t cycle;
+} boot_time_stage_t;
+
+//-- 부트로더와 펌웨어가 같은 .noinit 영역을 공유하므로 두 이미지의 구조가 같아야 한다.
+//
+typedef struct
+{
+  uint32_t magic;
+  uint16_t count;
+  uint16_t is_jump;
+  boot_time_stage_t stage[BOOT_TIME_MAX];
+} boot_time_tbl_t;
+
+
+#if CLI_USE(HW_BOOT_TIME)
+static void cliCmd(cli_args_t *args);
+#endif
+
+static bool is_init = false;
+
+__attribute__((section(".noinit")))
+static boot_time_tbl_t boot_time_tbl;
+
+
+
+
+
+bool bootTimeInit(void)
+{
+  boot_time_tbl_t *p_tbl = &boot_time_tbl;
+  bool is_clear = true;
+
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+#if HW_BOOT_TIME_IMAGE == BOOT_TIME_IMAGE_FW
+  // 부트로더에서 점프해 온 경우 카운터와 기록을 이어서 사용한다.
+  //
+  if (p_tbl->magic == BOOT_TIME_MAGIC && p_tbl->is_jump == true && p_tbl->count <= BOOT_TIME_MAX)
+  {
+    is_clear = false;
+  }
+#endif
+
+  if (is_clear)
+  {
+    DWT->CYCCNT    = 0;
+    p_tbl->magic   = BOOT_TIME_MAGIC;
+    p_tbl->count   = 0;
+  }
+  p_tbl->is_jump = false;
+
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  is_init = true;
+
+  bootTimeMark("start");
+
+#if CLI_USE(HW_BOOT_TIME)
+  cliAdd("boot", cliCmd);
+#endif
+  return true;
+}
+
+void bootTimeMark(const char *p_name)
+{
+  boot_time_tbl_t *p_tbl = &boot_time_tbl;
+  boot_time_stage_t *p_stage;
+
+
+  if (is_init != true || p_tbl->count >= BOOT_TIME_MAX)
+    return;
+
+  p_stage = &p_tbl->stage[p_tbl->count];
+  p_stage->cycle = DWT->CYCCNT;
+  p_stage->image = HW_BOOT_TIME_IMAGE;
+  strncpy(p_stage->name, p_name, BOOT_TIME_NAME_MAX - 1);
+  p_stage->name[BOOT_TIME_NAME_MAX - 1] = 0;
+
+  p_tbl->count++;
+}
+
+void bootTimeMarkJump(void)
+{
+  bootTimeMark("jump");
+  boot_time_tbl.is_jump = true;
+}
+
+uint32_t bootTimeGetCycle(void)
+{
+  return DWT->CYCCNT;
+}
+
+uint32_t bootTimeGetCount(void)
+{
+  if (is_init != true)
+    return 0;
+
+  return boot_time_tbl.count;
+}
+
+bool bootTimeGetInfo(uint32_t index, boot_time_info_t *p_info)
+{
+  boot_time_stage_t *p_stage;
+  uint32_t cycle_per_us;
+
+
+  if (index >= bootTimeGetCount())
+    return false;
+
+  p_stage = &boot_time_tbl.stage[index];
+  cycle_per_us = SystemCoreClock / 1000000;
+
+  memcpy(p_info->name, p_stage->name, BOOT_TIME_NAME_MAX);
+  p_info->image   = p_stage->image;
+  p_info->time_us = p_stage->cycle / cycle_per_us;
+
+  return true;
+}
+
+
+#if CLI_USE(HW_BOOT_TIME)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "time"))
+  {
+    boot_time_info_t info;
+    uint32_t pre_us = 0;
+
+    cliPrintf("idx img  name        time(ms)    delta(ms)\n");
+    for (int i=0; i<bootTimeGetCount(); i++)
+    {
+      uint32_t delta_us;
+
+      bootTimeGetInfo(i, &info);
+      delta_us = info.time_us - pre_us;
+      pre_us   = info.time_us;
+
+      cliPrintf("%3d %s  %-10s %5d.%03d   %5d.%03d\n",
+                i,
+                info.image == BOOT_TIME_IMAGE_BOOT ? "BOOT":"FW  ",
+                info.name,
+                info.time_us/1000, info.time_us%1000,
+                delta_us/1000, delta_us%1000);
+    }
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("boot time\n");
+  }
+}
+#endif
+
+#endif
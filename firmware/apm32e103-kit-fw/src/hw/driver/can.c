@@ -1,4 +1,5 @@
 #include "can.h"
+#include "perf.h"
 
 
 #ifdef _USE_HW_CAN
@@ -604,6 +605,7 @@ bool canUpdate(void)
 
 void canRxFifoCallback(uint8_t ch)
 {
+  PERF_SCOPE("canRxFifoCallback");
   can_msg_t *rx_buf;
   CAN_RxMessage_T rx_header;
 
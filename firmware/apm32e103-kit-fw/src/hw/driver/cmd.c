@@ -1,4 +1,5 @@
 #include "cmd.h"
+#include "perf.h"
 #ifdef _USE_HW_CLI
 #include "cli.h"
 #endif
@@ -25,6 +26,18 @@
 #define CMD_STATE_WAIT_DATA       9
 #define CMD_STATE_WAIT_CHECKSUM   10
 
+#define CMD_HEADER_LENGTH         9
+#define CMD_RX_TIMEOUT_MS         100       // 바이트 사이 간격이 넘으면 받던 패킷을 버린다.
+
+#ifdef _USE_HW_PBUF
+#if PBUF_LENGTH < CMD_MAX_DATA_LENGTH + 10
+#error "HW_PBUF_LENGTH must be CMD_MAX_DATA_LENGTH + 10 or more"
+#endif
+
+static bool cmdBufAlloc(cmd_t *p_cmd);
+static void cmdBufFree(cmd_t *p_cmd);
+static void cmdBufDrop(cmd_t *p_cmd, uint32_t *p_cnt);
+#endif
 
 
 
@@ -35,11 +48,60 @@ void cmdInit(cmd_t *p_cmd, cmd_driver_t *p_driver)
   p_cmd->p_driver = p_driver;
   p_cmd->state    = CMD_STATE_WAIT_STX0;
 
-  p_cmd->packet.data = &p_cmd->packet.buffer[CMD_STATE_WAIT_DATA];
+#ifdef _USE_HW_PBUF
+  p_cmd->packet.p_pbuf = NULL;
+  p_cmd->packet.buffer = NULL;
+  p_cmd->packet.data   = NULL;
+  p_cmd->rx_drop_cnt   = 0;
+  p_cmd->tx_drop_cnt   = 0;
+  p_cmd->drop_log_time = 0;
+#else
+  p_cmd->packet.data = &p_cmd->packet.buffer[CMD_HEADER_LENGTH];
+#endif
 
   p_cmd->is_init = true;
 }
 
+#ifdef _USE_HW_PBUF
+bool cmdBufAlloc(cmd_t *p_cmd)
+{
+  if (p_cmd->packet.p_pbuf == NULL)
+  {
+    p_cmd->packet.p_pbuf = pbufAlloc();
+    if (p_cmd->packet.p_pbuf == NULL)
+      return false;
+
+    p_cmd->packet.buffer = p_cmd->packet.p_pbuf->p_buf;
+    p_cmd->packet.data   = &p_cmd->packet.buffer[CMD_HEADER_LENGTH];
+  }
+  return true;
+}
+
+void cmdBufFree(cmd_t *p_cmd)
+{
+  if (p_cmd->packet.p_pbuf != NULL)
+  {
+    pbufFree(p_cmd->packet.p_pbuf);
+    p_cmd->packet.p_pbuf = NULL;
+    p_cmd->packet.buffer = NULL;
+    p_cmd->packet.data   = NULL;
+  }
+}
+
+// 계속 실패해도 로그는 채널마다 1초에 한번만 남긴다.
+//
+void cmdBufDrop(cmd_t *p_cmd, uint32_t *p_cnt)
+{
+  (*p_cnt)++;
+
+  if (millis()-p_cmd->drop_log_time >= 1000)
+  {
+    p_cmd->drop_log_time = millis();
+    logPrintf("[E_] cmd no pbuf : rx drop %d, tx drop %d\n", p_cmd->rx_drop_cnt, p_cmd->tx_drop_cnt);
+  }
+}
+#endif
+
 bool cmdOpen(cmd_t *p_cmd)
 {
   cmd_driver_t *p_driver = p_cmd->p_driver;
@@ -72,11 +134,15 @@ bool cmdClose(cmd_t *p_cmd)
 
   ret = p_driver->close(p_driver->args);
   p_cmd->is_open = false;
+#ifdef _USE_HW_PBUF
+  cmdBufFree(p_cmd);
+#endif
   return ret;
 }
 
 bool cmdReceivePacket(cmd_t *p_cmd)
 {
+  PERF_SCOPE("cmdReceivePacket");
   bool ret = false;
   uint8_t rx_data;
   cmd_driver_t *p_driver = p_cmd->p_driver;
@@ -84,12 +150,27 @@ bool cmdReceivePacket(cmd_t *p_cmd)
 
   if (p_cmd->is_open != true) return false;
 
+  // 받다가 멈춘 패킷은 다음 바이트를 기다리지 않고 여기서 버린다.
+  //
+  if (p_cmd->state != CMD_STATE_WAIT_STX0 && millis()-p_cmd->pre_time >= CMD_RX_TIMEOUT_MS)
+  {
+    p_cmd->state = CMD_STATE_WAIT_STX0;
+  }
+
+#ifdef _USE_HW_PBUF
+  // 앞에서 받은 패킷의 처리가 끝났거나 버려졌으므로 버퍼를 풀로 돌려준다.
+  //
+  if (p_cmd->state == CMD_STATE_WAIT_STX0)
+  {
+    cmdBufFree(p_cmd);
+  }
+#endif
 
   while(ret != true && p_driver->available(p_driver->args) > 0)
   {
     rx_data = p_driver->read(p_driver->args);
 
-    if (millis()-p_cmd->pre_time >= 100)
+    if (millis()-p_cmd->pre_time >= CMD_RX_TIMEOUT_MS)
     {
       p_cmd->state = CMD_STATE_WAIT_STX0;
     }
@@ -98,6 +179,14 @@ bool cmdReceivePacket(cmd_t *p_cmd)
     switch(p_cmd->state)
     {
       case CMD_STATE_WAIT_STX0:
+#ifdef _USE_HW_PBUF
+        // 버퍼가 없으면 이 패킷은 버린다.
+        if (rx_data == CMD_STX0 && cmdBufAlloc(p_cmd) != true)
+        {
+          cmdBufDrop(p_cmd, &p_cmd->rx_drop_cnt);
+          break;
+        }
+#endif
         if (rx_data == CMD_STX0)
         {
           p_cmd->packet.check_sum = 0;
@@ -210,36 +299,67 @@ bool cmdSend(cmd_t *p_cmd, CmdType_t type, uint16_t cmd, uint16_t err_code, uint
   cmd_driver_t *p_driver = p_cmd->p_driver;
   uint32_t data_len;
   uint32_t wr_len;
+  uint8_t *p_buf;
+#ifdef _USE_HW_PBUF
+  pbuf_t  *p_pbuf;
+#endif
 
   if (p_cmd->is_open != true) return false;
 
   data_len = length;
+  if (data_len > CMD_MAX_DATA_LENGTH) return false;
+
+#ifdef _USE_HW_PBUF
+  // 받은 패킷의 데이터로 응답하면 같은 버퍼에 헤더만 붙여서 보낸다.
+  //
+  if (p_cmd->packet.p_pbuf != NULL && p_data == p_cmd->packet.data)
+    p_pbuf = pbufRef(p_cmd->packet.p_pbuf);
+  else
+    p_pbuf = pbufAlloc();
+
+  if (p_pbuf == NULL)
+  {
+    cmdBufDrop(p_cmd, &p_cmd->tx_drop_cnt);
+    return false;
+  }
+  p_buf = p_pbuf->p_buf;
+#else
+  p_buf = p_cmd->packet.buffer;
+#endif
 
   index = 0;
-  p_cmd->packet.buffer[index++] = CMD_STX0;
-  p_cmd->packet.buffer[index++] = CMD_STX1;
-  p_cmd->packet.buffer[index++] = type;
-  p_cmd->packet.buffer[index++] = (cmd >> 0) & 0xFF;
-  p_cmd->packet.buffer[index++] = (cmd >> 8) & 0xFF;
-  p_cmd->packet.buffer[index++] = (err_code >> 0) & 0xFF;
-  p_cmd->packet.buffer[index++] = (err_code >> 8) & 0xFF;
-  p_cmd->packet.buffer[index++] = (data_len >> 0) & 0xFF;
-  p_cmd->packet.buffer[index++] = (data_len >> 8) & 0xFF;
-
-  for (int i=0; i<data_len; i++)
+  p_buf[index++] = CMD_STX0;
+  p_buf[index++] = CMD_STX1;
+  p_buf[index++] = type;
+  p_buf[index++] = (cmd >> 0) & 0xFF;
+  p_buf[index++] = (cmd >> 8) & 0xFF;
+  p_buf[index++] = (err_code >> 0) & 0xFF;
+  p_buf[index++] = (err_code >> 8) & 0xFF;
+  p_buf[index++] = (data_len >> 0) & 0xFF;
+  p_buf[index++] = (data_len >> 8) & 0xFF;
+
+  if (p_data != &p_buf[index])
   {
-    p_cmd->packet.buffer[index++] = p_data[i];
+    for (int i=0; i<data_len; i++)
+    {
+      p_buf[index + i] = p_data[i];
+    }
   }
+  index += data_len;
 
   uint8_t check_sum = 0;
   for (int i=0; i<index; i++)
   {
-    check_sum += p_cmd->packet.buffer[i];
+    check_sum += p_buf[i];
   }
   check_sum = (~check_sum) + 1;
-  p_cmd->packet.buffer[index++] = check_sum;
+  p_buf[index++] = check_sum;
 
-  wr_len = p_driver->write(p_driver->args, p_cmd->packet.buffer, index);
+  wr_len = p_driver->write(p_driver->args, p_buf, index);
+
+#ifdef _USE_HW_PBUF
+  pbufFree(p_pbuf);
+#endif
 
   if (wr_len == index)
   {
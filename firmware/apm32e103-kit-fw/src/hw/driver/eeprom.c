@@ -1,6 +1,7 @@
 #include "eeprom.h"
 #include "i2c.h"
 #include "cli.h"
+#include "swtimer.h"
 
 
 #ifdef _USE_HW_EEPROM
@@ -13,12 +14,50 @@ void cliEeprom(cli_args_t *args);
 
 
 #define EEPROM_MAX_SIZE   HW_EEPROM_MAX_SIZE
+#define EEPROM_PAGE_SIZE  HW_EEPROM_PAGE_SIZE
+
+
+#define EEPROM_WRITE_TIMEOUT  100    // ms, 페이지 쓰기 사이클 최대 대기
+#define EEPROM_POLL_MS        1      // ACK polling 간격, 다음 tick 에서 다시 확인한다.
+
+
+typedef enum
+{
+  EEPROM_WR_IDLE,
+  EEPROM_WR_PAGE,
+  EEPROM_WR_POLL,
+} EepromWrState_t;
+
+//-- 페이지 쓰기와 ACK polling 을 I2C 완료 콜백과 swtimer 에서 이어서 진행한다.
+//   메인 루프는 기다리는 동안 다른 일을 할 수 있고 폴링에 CPU 를 쓰지 않는다.
+//
+typedef struct
+{
+  volatile EepromWrState_t state;
+  volatile bool ret;
+
+  uint32_t   addr;
+  uint8_t   *p_data;
+  uint32_t   length;
+  uint32_t   index;
+  uint32_t   wr_len;
+  uint32_t   pre_time;
+  i2c_xfer_t xfer;
+} eeprom_wr_t;
 
 
 static bool is_init = false;
 static uint8_t i2c_ch = _DEF_I2C1;
 static uint8_t i2c_addr = 0x50;
+static eeprom_wr_t eep_wr;
+static swtimer_handle_t poll_timer = -1;
+
 
+static bool eepromWritePage(void);
+static bool eepromWritePoll(void);
+static void eepromWriteDone(bool ret);
+static void eepromWriteISR(i2c_xfer_t *p_xfer, bool ret);
+static void eepromPollISR(void *arg);
 
 
 
@@ -29,6 +68,11 @@ bool eepromInit()
 
   ret = i2cBegin(i2c_ch, 100);
 
+  // 같은 버스의 IMU 읽기가 먼저 처리되도록 한다.
+  i2cSetPriority(i2c_ch, i2c_addr, I2C_PRIO_LOW);
+
+  poll_timer = swtimerGetHandle();
+  swtimerSet(poll_timer, EEPROM_POLL_MS, ONE_TIME, eepromPollISR, NULL);
 
   if (ret == true)
   {
@@ -91,66 +135,169 @@ bool eepromReadByte(uint32_t addr, uint8_t *p_data)
 
 bool eepromWriteByte(uint32_t addr, uint8_t data_in)
 {
-  uint32_t pre_time;
-  bool ret;
+  return eepromWrite(addr, &data_in, 1);
+}
 
-  if (addr >= EEPROM_MAX_SIZE)
+bool eepromRead(uint32_t addr, uint8_t *p_data, uint32_t length)
+{
+  if (addr + length > EEPROM_MAX_SIZE)
   {
     return false;
   }
+  if (length == 0)
+  {
+    return true;
+  }
+
+  return i2cReadA16Bytes(i2c_ch, i2c_addr, addr, p_data, length, 10 + length/8);
+}
 
-  ret = i2cWriteA16Bytes(i2c_ch, i2c_addr, addr, &data_in, 1, 10);
+// 완료까지 기다리는 쓰기. 기다리지 않으려면 eepromWriteAsync() 후에
+// eepromIsBusy() 로 확인하며, 그동안 p_data 를 유지해야 한다.
+//
+bool eepromWrite(uint32_t addr, uint8_t *p_data, uint32_t length)
+{
+  bool ret;
 
 
-  pre_time = millis();
-  while(millis()-pre_time < 100)
+  ret = eepromWriteAsync(addr, p_data, length);
+  if (ret == true)
   {
-
-    ret = i2cIsDeviceReady(i2c_ch, i2c_addr);
-    if (ret == true)
+    while(eepromIsBusy() == true)
     {
-      break;
+      i2cUpdate();
     }
-    delay(1);
+    ret = eep_wr.ret;
   }
 
   return ret;
 }
 
-bool eepromRead(uint32_t addr, uint8_t *p_data, uint32_t length)
+bool eepromWriteAsync(uint32_t addr, uint8_t *p_data, uint32_t length)
 {
-  bool ret = true;
-  uint32_t i;
+  if (addr + length > EEPROM_MAX_SIZE || eep_wr.state != EEPROM_WR_IDLE)
+  {
+    return false;
+  }
+  if (length == 0)
+  {
+    eep_wr.ret = true;
+    return true;
+  }
 
+  eep_wr.addr   = addr;
+  eep_wr.p_data = p_data;
+  eep_wr.length = length;
+  eep_wr.index  = 0;
+  eep_wr.ret    = false;
 
-  for (i=0; i<length; i++)
+  eep_wr.xfer.dev_addr = i2c_addr;
+  eep_wr.xfer.prio     = I2C_PRIO_LOW;
+  eep_wr.xfer.func     = eepromWriteISR;
+  eep_wr.xfer.arg      = NULL;
+
+  eep_wr.state = EEPROM_WR_PAGE;
+  if (eepromWritePage() != true)
   {
-    ret = eepromReadByte(addr + i, &p_data[i]);
-    if (ret != true)
-    {
-      break;
-    }
+    eep_wr.state = EEPROM_WR_IDLE;
+    return false;
   }
 
-  return ret;
+  return true;
 }
 
-bool eepromWrite(uint32_t addr, uint8_t *p_data, uint32_t length)
+bool eepromIsBusy(void)
 {
-  bool ret = false;
-  uint32_t i;
+  return eep_wr.state != EEPROM_WR_IDLE;
+}
+
+bool eepromWritePage(void)
+{
+  uint32_t addr = eep_wr.addr + eep_wr.index;
+
+  // 페이지 경계를 넘지 않게 나누어 쓴다.
+  //
+  eep_wr.wr_len = EEPROM_PAGE_SIZE - (addr % EEPROM_PAGE_SIZE);
+  if (eep_wr.wr_len > eep_wr.length - eep_wr.index)
+    eep_wr.wr_len = eep_wr.length - eep_wr.index;
+
+  eep_wr.xfer.is_read  = false;
+  eep_wr.xfer.is_probe = false;
+  eep_wr.xfer.reg_size = 2;
+  eep_wr.xfer.reg_addr = addr;
+  eep_wr.xfer.p_data   = &eep_wr.p_data[eep_wr.index];
+  eep_wr.xfer.length   = eep_wr.wr_len;
+  eep_wr.xfer.timeout  = 10;
+
+  return i2cSubmit(i2c_ch, &eep_wr.xfer);
+}
+
+bool eepromWritePoll(void)
+{
+  // 쓰기 사이클이 끝날 때까지 ACK 가 없으므로 NACK 는 에러로 세지 않는다.
+  //
+  eep_wr.xfer.is_read  = false;
+  eep_wr.xfer.is_probe = true;
+  eep_wr.xfer.reg_size = 0;
+  eep_wr.xfer.reg_addr = 0;
+  eep_wr.xfer.p_data   = NULL;
+  eep_wr.xfer.length   = 0;
+  eep_wr.xfer.timeout  = 10;
+
+  return i2cSubmit(i2c_ch, &eep_wr.xfer);
+}
 
+void eepromWriteDone(bool ret)
+{
+  eep_wr.ret   = ret;
+  eep_wr.state = EEPROM_WR_IDLE;
+}
 
-  for (i=0; i<length; i++)
+void eepromWriteISR(i2c_xfer_t *p_xfer, bool ret)
+{
+  if (eep_wr.state == EEPROM_WR_PAGE)
+  {
+    if (ret != true)
+    {
+      eepromWriteDone(false);
+      return;
+    }
+    eep_wr.index   += eep_wr.wr_len;
+    eep_wr.pre_time = millis();
+    eep_wr.state    = EEPROM_WR_POLL;
+    if (eepromWritePoll() != true)
+      eepromWriteDone(false);
+  }
+  else if (eep_wr.state == EEPROM_WR_POLL)
   {
-    ret = eepromWriteByte(addr + i, p_data[i]);
-    if (ret == false)
+    if (ret != true)
+    {
+      // 쓰기 사이클(약 5ms) 동안 버스를 probe 로 채우지 않도록 tick 마다 다시 확인한다.
+      if (millis()-eep_wr.pre_time >= EEPROM_WRITE_TIMEOUT)
+        eepromWriteDone(false);
+      else if (poll_timer >= 0)
+        swtimerStart(poll_timer);
+      else if (eepromWritePoll() != true)
+        eepromWriteDone(false);
+      return;
+    }
+    if (eep_wr.index >= eep_wr.length)
     {
-      break;
+      eepromWriteDone(true);
+      return;
     }
+    eep_wr.state = EEPROM_WR_PAGE;
+    if (eepromWritePage() != true)
+      eepromWriteDone(false);
   }
+}
 
-  return ret;
+void eepromPollISR(void *arg)
+{
+  if (eep_wr.state == EEPROM_WR_POLL && eepromWritePoll() != true)
+  {
+    eepromWriteDone(false);
+  }
 }
 
 uint32_t eepromGetLength(void)
@@ -1,33 +1,66 @@
 #include "event.h"
+#include "mem.h"
 
 
 #ifdef _USE_HW_EVENT
-#include "qbuffer.h"
 #include "cli.h"
+#include "log.h"
 
 #define EVENT_Q_MAX       HW_EVENT_Q_MAX
+#define EVENT_Q_MASK      (EVENT_Q_MAX - 1)
 #define EVENT_NODE_MAX    HW_EVENT_NODE_MAX
+#define EVENT_NODE_NONE   -1
+
+#if (EVENT_Q_MAX & EVENT_Q_MASK) != 0
+#error "HW_EVENT_Q_MAX must be a power of 2"
+#endif
 
 
+//-- 구독 노드는 이벤트 코드별 연결 리스트로 묶여 있어서
+//   발행된 이벤트는 해당 코드를 구독한 함수에만 전달된다.
+//
 typedef struct
 {
-  int32_t count;
-  event_func_t event_func[EVENT_NODE_MAX];
-  const char *func_name;
+  event_func_t event_func;
+  const char  *func_name;
+  EventCode_t  code;
+  int16_t      next;
 } event_node_t;
 
+typedef struct
+{
+  int16_t           head;
+  bool              is_log;
+  const char       *p_name;
+  volatile uint32_t pub_cnt;    // ISR 에서도 발행하므로 eventInc() 로 올린다.
+  volatile uint32_t drop_cnt;
+} event_code_t;
+
+//-- 여러 생산자(ISR 포함), 단일 소비자(eventUpdate) 큐
+//   seq 값으로 슬롯의 상태를 구분하고 쓰기 위치는 LDREX/STREX 로 예약한다.
+//
+typedef struct
+{
+  volatile uint32_t seq;
+  event_t           event;
+} event_slot_t;
+
 
 static bool eventGet(event_t *p_event);
-static bool eventAvailble(void);
+static bool eventCas(volatile uint32_t *p_addr, uint32_t expected, uint32_t desired);
+static void eventInc(volatile uint32_t *p_addr);
 #if CLI_USE(HW_EVENT)
 static void cliEvent(cli_args_t *args);
 #endif
 
 static bool is_init = false;
-static bool is_log = true;
-static qbuffer_t event_q;
-static event_t event_buf[EVENT_Q_MAX];
-static event_node_t event_node;
+static volatile uint32_t q_in  = 0;
+static uint32_t          q_out = 0;
+static volatile uint32_t q_overflow = 0;
+static event_slot_t event_q[EVENT_Q_MAX];
+static uint32_t     node_count = 0;
+static event_node_t event_node[EVENT_NODE_MAX];
+static event_code_t event_code_tbl[EVENT_MAX];
 
 
 
@@ -35,107 +68,201 @@ static event_node_t event_node;
 
 bool eventInit(void)
 {
-  event_node.count = 0;
+  for (int i=0; i<EVENT_Q_MAX; i++)
+  {
+    event_q[i].seq = i;
+  }
+  q_in       = 0;
+  q_out      = 0;
+  q_overflow = 0;
+  MEM_BUF_ADD("event q", event_q);
+
+  node_count = 0;
   for (int i=0; i<EVENT_NODE_MAX; i++)
   {
-    event_node.event_func[i] = NULL;
+    event_node[i].event_func = NULL;
+    event_node[i].func_name  = NULL;
+    event_node[i].next       = EVENT_NODE_NONE;
   }
-  is_init = qbufferCreateBySize(&event_q, (uint8_t *)event_buf, sizeof(event_t), EVENT_Q_MAX);
+  for (int i=0; i<EVENT_MAX; i++)
+  {
+    event_code_tbl[i].head     = EVENT_NODE_NONE;
+    event_code_tbl[i].is_log   = true;
+    event_code_tbl[i].p_name   = NULL;
+    event_code_tbl[i].pub_cnt  = 0;
+    event_code_tbl[i].drop_cnt = 0;
+  }
+  is_init = true;
 
 #if CLI_USE(HW_EVENT)
   cliAdd("event", cliEvent);
-#endif  
+#endif
   return is_init;
 }
 
-bool eventSubFunc(const char *p_name, event_func_t sub_func)
+bool eventSubFunc(const char *p_name, EventCode_t event_code, event_func_t sub_func)
 {
-  bool ret;
+  event_node_t *p_node;
+  int16_t *p_next;
 
-  if (event_node.count < EVENT_NODE_MAX)
-  {
-    event_node.event_func[event_node.count] = sub_func;
-    event_node.func_name = p_name;
-    event_node.count++;
-    ret = true;
-  }
-  else
+
+  if (event_code >= EVENT_MAX || sub_func == NULL)
+    return false;
+
+  if (node_count >= EVENT_NODE_MAX)
+    return false;
+
+  p_node = &event_node[node_count];
+  p_node->event_func = sub_func;
+  p_node->func_name  = p_name;
+  p_node->code       = event_code;
+  p_node->next       = EVENT_NODE_NONE;
+
+  // 구독한 순서대로 호출되도록 리스트 끝에 붙인다.
+  p_next = &event_code_tbl[event_code].head;
+  while (*p_next != EVENT_NODE_NONE)
   {
-    ret = false;
+    p_next = &event_node[*p_next].next;
   }
+  *p_next = node_count;
+  node_count++;
 
-  return ret;  
+  return true;
 }
 
-bool eventAvailble(void)
+bool eventCas(volatile uint32_t *p_addr, uint32_t expected, uint32_t desired)
 {
-  if (is_init != true)
+  if (__LDREXW(p_addr) != expected)
+  {
+    __CLREX();
     return false;
+  }
+  return __STREXW(desired, p_addr) == 0;
+}
 
-  if (qbufferAvailable(&event_q) > 0)
-    return true;
-  else
-    return false;
+void eventInc(volatile uint32_t *p_addr)
+{
+  uint32_t value;
+
+  do
+  {
+    value = __LDREXW(p_addr);
+  } while (__STREXW(value + 1, p_addr) != 0);
 }
 
 bool eventPubFunc(const char *p_name, EventCode_t event_code, uint32_t event_data)
 {
-  bool ret;
-  event_t event_msg;
+  event_code_t *p_code;
+  event_slot_t *p_slot;
+  uint32_t pos;
+  int32_t  diff;
 
-  if (is_init != true)
+
+  if (is_init != true || event_code >= EVENT_MAX)
     return false;
 
-  event_msg.code = event_code;
-  event_msg.data = event_data;
-  event_msg.p_name = p_name;
-  ret = qbufferWrite(&event_q, (uint8_t *)&event_msg, 1);
+  p_code = &event_code_tbl[event_code];
+  p_code->p_name = p_name;
+  eventInc(&p_code->pub_cnt);
 
-  return ret;
+  pos = q_in;
+  while(1)
+  {
+    p_slot = &event_q[pos & EVENT_Q_MASK];
+    diff = (int32_t)(p_slot->seq - pos);
+
+    if (diff == 0)
+    {
+      if (eventCas(&q_in, pos, pos + 1))
+        break;
+      pos = q_in;
+    }
+    else if (diff < 0)
+    {
+      eventInc(&p_code->drop_cnt);
+      eventInc(&q_overflow);
+      return false;
+    }
+    else
+    {
+      pos = q_in;
+    }
+  }
+
+  p_slot->event.code   = event_code;
+  p_slot->event.data   = event_data;
+  p_slot->event.p_name = p_name;
+  __DMB();
+  p_slot->seq = pos + 1;
+
+  return true;
 }
 
 bool eventGet(event_t *p_event)
 {
-  bool ret;
+  event_slot_t *p_slot;
 
-  if (is_init != true)
+
+  p_slot = &event_q[q_out & EVENT_Q_MASK];
+  if (p_slot->seq != q_out + 1)
     return false;
 
-  ret = qbufferRead(&event_q, (uint8_t *)p_event, 1);
+  __DMB();
+  *p_event = p_slot->event;
+  __DMB();
+  p_slot->seq = q_out + EVENT_Q_MAX;
+  q_out++;
 
-  return ret;
+  return true;
 }
 
 bool eventUpdate(void)
 {
+  event_t evt;
+
 
   if (is_init != true)
     return false;
 
-
-  while(eventAvailble())
+  while(eventGet(&evt) == true)
   {
-    event_t evt;
+    int16_t node;
 
-    if (eventGet(&evt) == true)
+    if (event_code_tbl[evt.code].is_log == true)
     {
-      if (is_log == true)
-      {
-        logPrintf("[  ] Event %s:%d\n", evt.p_name, evt.data);
-      }
+      logBinPrintf("[  ] Event %s:%d\n", (uint32_t)evt.p_name, evt.data);
+    }
 
-      for (int i=0; i<event_node.count; i++)
-      {
-        if (event_node.event_func[i] != NULL)
-        {
-          event_node.event_func[i](&evt);
-        }
-      }
+    node = event_code_tbl[evt.code].head;
+    while (node != EVENT_NODE_NONE)
+    {
+      event_node[node].event_func(&evt);
+      node = event_node[node].next;
     }
   }
 
   return true;
-}  
+}
+
+void eventSetLog(EventCode_t event_code, bool enable)
+{
+  if (event_code >= EVENT_MAX)
+  {
+    for (int i=0; i<EVENT_MAX; i++)
+    {
+      event_code_tbl[i].is_log = enable;
+    }
+  }
+  else
+  {
+    event_code_tbl[event_code].is_log = enable;
+  }
+}
+
+uint32_t eventGetOverflow(void)
+{
+  return q_overflow;
+}
 
 #if CLI_USE(HW_EVENT)
 void cliEvent(cli_args_t *args)
@@ -145,34 +272,52 @@ void cliEvent(cli_args_t *args)
 
   if (args->argc == 1 && args->isStr(0, "info"))
   {
-    cliPrintf("init : %s\n", is_init ? "True":"False");
-    cliPrintf("log  : %s\n", is_log  ? "On":"Off");
-    cliPrintf("node : %d\n", event_node.count);
-    for (int i=0; i<event_node.count; i++)
+    cliPrintf("init     : %s\n", is_init ? "True":"False");
+    cliPrintf("queue    : %d/%d\n", q_in - q_out, EVENT_Q_MAX);
+    cliPrintf("overflow : %d\n", q_overflow);
+    cliPrintf("node     : %d/%d\n", node_count, EVENT_NODE_MAX);
+    cliPrintf("\n");
+    cliPrintf("code log       pub     drop  name\n");
+    for (int i=0; i<EVENT_MAX; i++)
     {
-      cliPrintf("       %d - %s\n",i, event_node.func_name);
+      cliPrintf("%4d %s %8d %8d  %s\n",
+                i,
+                event_code_tbl[i].is_log ? "On ":"Off",
+                event_code_tbl[i].pub_cnt,
+                event_code_tbl[i].drop_cnt,
+                event_code_tbl[i].p_name != NULL ? event_code_tbl[i].p_name:"");
+
+      for (int16_t node = event_code_tbl[i].head; node != EVENT_NODE_NONE; node = event_node[node].next)
+      {
+        cliPrintf("                              - %s\n", event_node[node].func_name);
+      }
     }
     ret = true;
   }
 
-  if (args->argc == 2 && args->isStr(0, "log"))
-  { 
-    if (args->isStr(1, "on"))
+  if (args->argc >= 2 && args->isStr(0, "log"))
+  {
+    EventCode_t code = EVENT_MAX;
+    bool is_log;
+
+    is_log = args->isStr(1, "on");
+    if (args->argc == 3)
     {
-      is_log = true;
+      code = (EventCode_t)args->getData(2);
     }
-    else
+    eventSetLog(code, is_log);
+
+    for (int i=0; i<EVENT_MAX; i++)
     {
-      is_log = false;
+      cliPrintf("%4d log : %s\n", i, event_code_tbl[i].is_log ? "On":"Off");
     }
-    cliPrintf("log  : %s\n", is_log  ? "On":"Off");
     ret = true;
   }
 
   if (ret == false)
   {
     cliPrintf("event info\n");
-    cliPrintf("event log on:off\n");
+    cliPrintf("event log on:off [code]\n");
   }
 }
 #endif
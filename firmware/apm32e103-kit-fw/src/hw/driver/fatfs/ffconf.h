@@ -308,6 +308,14 @@
 
 #if _USE_LFN == 3
 
+#include "hw_def.h"
+
+#ifdef _USE_HW_MPOOL
+#include "mpool.h"
+#define ff_malloc mpoolAlloc
+#define ff_free   mpoolFree
+#endif
+
 #if !defined(ff_malloc) || !defined(ff_free)
 #include <stdlib.h>
 #endif
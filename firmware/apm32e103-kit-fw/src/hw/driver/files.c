@@ -3,39 +3,22 @@
 
 #ifdef _USE_HW_FATFS
 #include "ff_gen_drv.h"
+#include "mpool.h"
 
 
-static bool     is_used[8] = {0, };
-static FIL      fil_buf[8];
+//-- FIL 은 mpool 에서 할당한다.
+//
+_Static_assert(sizeof(FIL) <= HW_MPOOL_M_SIZE, "HW_MPOOL_M_SIZE is smaller than FIL");
 
 
 void *ob_malloc(size_t size)
 {
-  void *ret = NULL;
-
-  for (int i=0; i<8; i++)
-  {
-    if (is_used[i] == false)
-    {
-      is_used[i] = true;
-      ret = (void *)&fil_buf[i];
-      break;
-    }
-  }
-
-  return ret;
+  return mpoolAlloc(size);
 }
 
 void ob_free(void *addr)
 {
-  for (int i=0; i<8; i++)
-  {
-    if (is_used[i] == true && addr == (void *)&fil_buf[i])
-    {
-      is_used[i] = false;
-      break;
-    }
-  }
+  mpoolFree(addr);
 }
 
 FILE *ob_fopen(const char *filename, const char *mode)
@@ -22,17 +22,42 @@ uint16_t hanCnvCodeWan2Johab(uint16_t WanCode);
 
 uint16_t hanFontLoad(char *HanCode, han_font_t *FontPtr )
 {
+  uint32_t code;
+
   // 버퍼 초기화
   memset(FontPtr->FontBuffer, 0x00, 32);
 
 
-  FontPtr->Code_Type = PHAN_NULL_CODE;
+  FontPtr->Code_Type = hanFontGetCode(HanCode, &code, &FontPtr->Size_Char);
+
+  switch(FontPtr->Code_Type)
+  {
+    case PHAN_HANGUL_CODE:
+      if (FontPtr->Size_Char == 3)
+        hanUniFontLoad(HanCode, FontPtr);
+      else
+        hanWanFontLoad(HanCode, FontPtr );
+      break;
+
+    case PHAN_ENG_CODE:
+      hanEngFontLoad(HanCode, FontPtr);
+      break;
+  }
+
+  return FontPtr->Code_Type;
+}
+
+//-- 폰트를 만들지 않고 글자 종류와 바이트 수, 글자 코드만 구한다.
+//   코드는 UTF-8 한글은 유니코드, 완성형은 PHAN_WAN_FLAG 를 더한 값, 영문은 ASCII 이다.
+//
+uint16_t hanFontGetCode(char *HanCode, uint32_t *p_code, uint16_t *p_size)
+{
   // 한글코드인지 감별
   //
   if( !HanCode[0] || HanCode[0] == 0x0A )   // 문자열 마지막
   {
-    FontPtr->Code_Type = PHAN_END_CODE;
-    FontPtr->Size_Char = 1;
+    *p_code = 0;
+    *p_size = 1;
     return PHAN_END_CODE;
   }
   else if( HanCode[0] & 0x80 )              // 한글 코드인경우
@@ -43,29 +68,22 @@ uint16_t hanFontLoad(char *HanCode, han_font_t *FontPtr )
 
     if (utf8_code >= 0xEAB080 && utf8_code <= 0xED9FB0)
     {
-      FontPtr->Code_Type = PHAN_HANGUL_CODE;
-      FontPtr->Size_Char = 3;
-      hanUniFontLoad(HanCode, FontPtr);
+      *p_code = (uint8_t)(HanCode[0] & 0x0f) << 12 | (uint8_t)(HanCode[1] & 0x3f) << 6 | (uint8_t)(HanCode[2] & 0x3f);
+      *p_size = 3;
     }
     else
     {
-      FontPtr->Code_Type = PHAN_HANGUL_CODE;
-      FontPtr->Size_Char = 2;
-      hanWanFontLoad(HanCode, FontPtr );
+      *p_code = PHAN_WAN_FLAG | ((uint8_t)HanCode[0]<<8) | (uint8_t)HanCode[1];
+      *p_size = 2;
     }
     return PHAN_HANGUL_CODE;
   }
   else                                      // 영문 코드
   {
-    FontPtr->Code_Type = PHAN_ENG_CODE;
-    FontPtr->Size_Char = 1;
-    hanEngFontLoad(HanCode, FontPtr);
+    *p_code = (uint8_t)HanCode[0];
+    *p_size = 1;
     return PHAN_ENG_CODE;
   }
-
-
-  return FontPtr->Code_Type;
-
 }
 
 void hanWanFontLoad(char *HanCode, han_font_t *FontPtr )   /* 한글 일반 폰트 생성 */
@@ -19,6 +19,8 @@
 #define PHAN_SPEC_CODE    3
 #define PHAN_END_CODE     4
 
+#define PHAN_WAN_FLAG     0x10000   // 완성형 코드는 유니코드와 겹치지 않게 표시
+
 
 
 
@@ -35,6 +37,7 @@ typedef struct
 
 
 uint16_t hanFontLoad(char *HanCode, han_font_t *FontPtr);
+uint16_t hanFontGetCode(char *HanCode, uint32_t *p_code, uint16_t *p_size);
 
 
 #endif /* SRC_HW_DRIVER_HANGUL_HAN_H_ */
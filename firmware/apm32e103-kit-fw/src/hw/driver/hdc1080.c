@@ -15,6 +15,9 @@
 #define REG_ADDR_MENUF_ID    0xFE
 #define REG_ADDR_DEVICE_ID   0xFF
 
+#define HDC1080_PERIOD_MS    HW_HDC1080_PERIOD_MS
+#define HDC1080_CONV_MS      20
+
 
 #if CLI_USE(HW_HDC1080)
 static void cliCmd(cli_args_t *args);
@@ -27,6 +30,10 @@ static bool is_init = false;
 static uint8_t i2c_ch = _DEF_I2C1;
 static uint8_t i2c_addr = 0x40;
 
+static uint8_t  meas_state = 0;
+static uint32_t meas_pre_time = 0;
+static hdc1080_info_t meas_info;
+
 
 
 
@@ -45,12 +52,19 @@ bool hdc1080Init(void)
   {
     ret = i2cIsDeviceReady(i2c_ch, i2c_addr);
   }
+  if (ret)
+  {
+    i2cSetPriority(i2c_ch, i2c_addr, I2C_PRIO_NORMAL);
+  }
 
   if (ret)
   {
     ret = hdc1080InitRegs();
   }
 
+  memset(&meas_info, 0, sizeof(meas_info));
+  meas_state    = 0;
+  meas_pre_time = millis() - HDC1080_PERIOD_MS;
   is_init = ret;
 
   logPrintf("[%s] hdc1080Init()\n", ret ? "OK":"NG");
@@ -66,6 +80,11 @@ bool hdc1080Init(void)
   return ret;
 }
 
+bool hdc1080IsInit(void)
+{
+  return is_init;
+}
+
 bool hdc1080InitRegs(void)
 { 
   bool ret = true;
@@ -140,34 +159,41 @@ bool regWrite(uint16_t addr, uint16_t data)
   return ret;
 }
 
-bool hdc1080GetInfo(hdc1080_info_t *p_info)
+//-- 측정은 이 함수 하나가 주기마다 진행하고 결과를 보관한다.
+//   (trigger -> 변환 대기 -> 읽기) 순서를 여러 곳에서 나눠 부르지 않도록 한다.
+//
+bool hdc1080Update(void)
 {
-  bool ret = true;  
   bool is_measured = false;
   uint16_t reg_temp;
   uint16_t reg_humidity;
-  static uint8_t state = 0;
-  static uint32_t pre_time = 0;
 
 
-  switch(state)
+  if (!is_init)
+    return false;
+
+  switch(meas_state)
   {
     case 0:
-      hdc1080Trigger();
-      state = 1;
-      pre_time = millis();
-      break;    
-  
+      if (millis()-meas_pre_time >= HDC1080_PERIOD_MS)
+      {
+        meas_pre_time = millis();
+        if (hdc1080Trigger())
+        {
+          meas_state = 1;
+        }
+      }
+      break;
+
     case 1:
-      if (millis()-pre_time >= 20)
+      if (millis()-meas_pre_time >= HDC1080_CONV_MS)
       {
-        state = 2;
+        meas_state = 2;
       }
       break;
 
     case 2:
-      ret &= regReadMeasure(&reg_temp, &reg_humidity);
-      if (ret)
+      if (regReadMeasure(&reg_temp, &reg_humidity))
       {
         int32_t temp;
         int32_t humidity;
@@ -176,20 +202,33 @@ bool hdc1080GetInfo(hdc1080_info_t *p_info)
         temp     -= (40 * 100);
         humidity  = ((reg_humidity * 100) * 100) / 65536;
 
-        p_info->temp          = temp / 100;
-        p_info->temp_x100     = temp;
-        p_info->humidity      = humidity / 100;
-        p_info->humidity_x100 = humidity;
+        meas_info.temp          = temp / 100;
+        meas_info.temp_x100     = temp;
+        meas_info.humidity      = humidity / 100;
+        meas_info.humidity_x100 = humidity;
+        meas_info.time_us       = micros();
+        meas_info.count++;
 
         is_measured = true;
       }
-      state = 0;
+      meas_state = 0;
       break;
   }
 
   return is_measured;
 }
 
+// 마지막 측정 결과를 돌려준다. 아직 측정한 적이 없으면 false
+//
+bool hdc1080GetInfo(hdc1080_info_t *p_info)
+{
+  if (!is_init || meas_info.count == 0)
+    return false;
+
+  *p_info = meas_info;
+  return true;
+}
+
 
 #if CLI_USE(HW_HDC1080)
 void cliCmd(cli_args_t *args)
@@ -225,9 +264,10 @@ void cliCmd(cli_args_t *args)
     hdc1080_info_t info;
 
 
+    // CLI 가 도는 동안은 메인 루프의 측정 task 가 멈추므로 여기서 진행한다.
     while(cliKeepLoop())
     {
-      if (hdc1080GetInfo(&info))
+      if (hdc1080Update() && hdc1080GetInfo(&info))
       {
         cliPrintf("temp     : %d.%d  ", info.temp_x100/100, info.temp_x100%100);
         cliPrintf("humidity : %d.%d%%\n", info.humidity_x100/100, info.humidity_x100%100);
@@ -6,7 +6,7 @@
 
 #ifdef _USE_HW_I2C
 #include "cli.h"
-#include "hal/hal_i2c.h"
+#include "task.h"
 
 
 #ifdef _USE_HW_RTOS
@@ -18,7 +18,72 @@
 #endif
 
 
+//-- 모든 전송은 버스별 큐에 들어가 인터럽트로 하나씩 처리된다.
+//   큐는 우선 순위 순으로 정렬되고 같은 우선 순위는 요청 순서를 따른다.
+//   블럭킹 함수도 큐에 넣고 완료를 기다린다.
+//
+#define I2C_DEV_MAX           HW_I2C_DEV_MAX
+
+#define I2C_STS1_START        (1<<0)
+#define I2C_STS1_ADDR         (1<<1)
+#define I2C_STS1_BTC          (1<<2)
+#define I2C_STS1_RXBNE        (1<<6)
+#define I2C_STS1_TXBE         (1<<7)
+#define I2C_STS1_BERR         (1<<8)
+#define I2C_STS1_AL           (1<<9)
+
+#define I2C_STOP_TIMEOUT_US   1000      // STOP 이 이보다 오래 남아 있으면 버스를 복구한다.
+
+
+typedef enum
+{
+  I2C_PHASE_TX,
+  I2C_PHASE_RX_ADDR,
+  I2C_PHASE_RX,
+} I2cPhase_t;
+
+typedef struct
+{
+  uint8_t  dev_addr;
+  uint8_t  prio;
+  uint32_t count;
+  uint32_t err_cnt;
+  uint32_t wait_max;          // 큐에서 기다린 시간(us)
+  uint32_t time_sum;          // 요청부터 완료까지 걸린 시간(us)
+  uint32_t time_max;
+} i2c_dev_t;
+
+typedef struct
+{
+  i2c_xfer_t    *p_head;
+  i2c_xfer_t    *p_cur;
+  I2cPhase_t     phase;
+  uint32_t       tx_index;
+  uint32_t       tx_total;
+  uint32_t       rx_index;
+  uint32_t       start_us;
+  uint32_t       pre_time;
+
+  volatile bool  req_recovery;
+  uint32_t       recovery_cnt;
+
+  volatile bool  start_pending;     // STOP 이 끝나면 i2cUpdate() 에서 다음 전송을 시작한다.
+  uint32_t       stop_pre_us;
+  uint32_t       defer_cnt;
+
+  uint32_t       dev_cnt;
+  i2c_dev_t      dev[I2C_DEV_MAX];
+} i2c_bus_t;
+
+
 static void delayUs(uint32_t us);
+static i2c_dev_t *i2cGetDev(uint8_t ch, uint8_t dev_addr, bool add);
+static bool i2cTransfer(uint8_t ch, uint16_t dev_addr, bool is_read, uint8_t reg_size, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout, bool is_probe);
+static void i2cStartNext(uint8_t ch);
+static void i2cFinish(uint8_t ch, bool ret);
+static uint8_t i2cGetTxByte(i2c_bus_t *p_bus);
+static void i2cEvtISR(uint8_t ch);
+static void i2cErrISR(uint8_t ch);
 #if CLI_USE(HW_I2C)
 static void cliI2C(cli_args_t *args);
 #endif
@@ -48,14 +113,19 @@ typedef struct
 
   GPIO_T *sda_port;
   int     sda_pin;
+
+  IRQn_Type evt_irq;
+  IRQn_Type err_irq;
 } i2c_tbl_t;
 
 static i2c_tbl_t i2c_tbl[I2C_MAX_CH] =
 {
-  {I2C1, &hi2c1, GPIOB, GPIO_PIN_6 , GPIOB, GPIO_PIN_7 },
-  {I2C2, &hi2c2, GPIOB, GPIO_PIN_10, GPIOB, GPIO_PIN_11},
+  {I2C1, &hi2c1, GPIOB, GPIO_PIN_6 , GPIOB, GPIO_PIN_7 , I2C1_EV_IRQn, I2C1_ER_IRQn},
+  {I2C2, &hi2c2, GPIOB, GPIO_PIN_10, GPIOB, GPIO_PIN_11, I2C2_EV_IRQn, I2C2_ER_IRQn},
 };
 
+static i2c_bus_t i2c_bus[I2C_MAX_CH];
+
 
 
 
@@ -73,6 +143,14 @@ bool i2cInit(void)
     i2c_timeout[i] = 10;
     i2c_errcount[i] = 0;
     is_begin[i] = false;
+
+    i2c_bus[i].p_head       = NULL;
+    i2c_bus[i].p_cur        = NULL;
+    i2c_bus[i].req_recovery = false;
+    i2c_bus[i].recovery_cnt = 0;
+    i2c_bus[i].start_pending = false;
+    i2c_bus[i].defer_cnt    = 0;
+    i2c_bus[i].dev_cnt      = 0;
   }
 
   logPrintf("[OK] i2cInit()\n");
@@ -134,13 +212,11 @@ bool i2cBegin(uint8_t ch, uint32_t freq_khz)
       I2C_Reset(i2c_tbl[ch].p_i2c);
       I2C_Config(i2c_tbl[ch].p_i2c, p_handle);
 
-      /* NVIC coniguration */
-      // NVIC_EnableIRQRequest(I2C1_EV_IRQn, 1, 0);
-      /* Enable the I2C1 Interrupt */
-      // I2C_EnableInterrupt(i2c_tbl[ch].p_i2c, I2C_INT_EVT);
-
       I2C_Enable(i2c_tbl[ch].p_i2c);
 
+      NVIC_EnableIRQRequest(i2c_tbl[ch].evt_irq, 1, 0);
+      NVIC_EnableIRQRequest(i2c_tbl[ch].err_irq, 1, 0);
+
       ret = true;
       is_begin[ch] = true;
       break;
@@ -177,6 +253,9 @@ bool i2cBegin(uint8_t ch, uint32_t freq_khz)
 
       I2C_Enable(i2c_tbl[ch].p_i2c);
 
+      NVIC_EnableIRQRequest(i2c_tbl[ch].evt_irq, 1, 0);
+      NVIC_EnableIRQRequest(i2c_tbl[ch].err_irq, 1, 0);
+
       ret = true;
       is_begin[ch] = true;
       break;
@@ -190,260 +269,617 @@ bool i2cIsBegin(uint8_t ch)
   return is_begin[ch];
 }
 
-void i2cReset(uint8_t ch)
+i2c_dev_t *i2cGetDev(uint8_t ch, uint8_t dev_addr, bool add)
 {
-  GPIO_Config_T  GPIO_InitStruct;
-  i2c_tbl_t *p_pin = &i2c_tbl[ch];
-
-  lock();
-  GPIO_InitStruct.pin       = p_pin->scl_pin;
-  GPIO_InitStruct.mode      = GPIO_MODE_OUT_OD;
-  GPIO_InitStruct.speed     = GPIO_SPEED_10MHz;
-  GPIO_Config(p_pin->scl_port, &GPIO_InitStruct);
-
-  GPIO_InitStruct.pin       = p_pin->sda_pin;
-  GPIO_InitStruct.mode      = GPIO_MODE_OUT_OD;
-  GPIO_Config(p_pin->sda_port, &GPIO_InitStruct);
-
+  i2c_bus_t *p_bus = &i2c_bus[ch];
+  i2c_dev_t *p_dev = NULL;
+  uint32_t primask;
 
-  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
-  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_HIGH);
-  delayUs(5);
 
-  for (int i = 0; i < 9; i++)
+  primask = __get_PRIMASK();
+  __disable_irq();
+  for (int i=0; i<p_bus->dev_cnt; i++)
   {
-
-    GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_LOW);
-    delayUs(5);
-    GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
-    delayUs(5);
+    if (p_bus->dev[i].dev_addr == dev_addr)
+    {
+      p_dev = &p_bus->dev[i];
+      break;
+    }
   }
+  if (p_dev == NULL && add == true && p_bus->dev_cnt < I2C_DEV_MAX)
+  {
+    p_dev = &p_bus->dev[p_bus->dev_cnt++];
+    p_dev->dev_addr = dev_addr;
+    p_dev->prio     = I2C_PRIO_NORMAL;
+    p_dev->count    = 0;
+    p_dev->err_cnt  = 0;
+    p_dev->wait_max = 0;
+    p_dev->time_sum = 0;
+    p_dev->time_max = 0;
+  }
+  __set_PRIMASK(primask);
 
-  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_LOW);
-  delayUs(5);
-  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_LOW);
-  delayUs(5);
-
-  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
-  delayUs(5);
-  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_HIGH);
-  unLock();
+  return p_dev;
 }
 
-bool i2cIsDeviceReady(uint8_t ch, uint8_t dev_addr)
+bool i2cSetPriority(uint8_t ch, uint8_t dev_addr, uint8_t prio)
 {
-  bool ret = false;
+  i2c_dev_t *p_dev;
 
-  lock();
-  if (HAL_I2C_IsDeviceReady(i2c_tbl[ch].p_i2c, dev_addr << 1, 10, 10) == HAL_OK)
+  if (ch >= I2C_MAX_CH || prio >= I2C_PRIO_MAX)
   {
-    __enable_irq();
-    ret = true;
+    return false;
   }
-  unLock();
 
-  return ret;
+  p_dev = i2cGetDev(ch, dev_addr, true);
+  if (p_dev == NULL)
+  {
+    return false;
+  }
+  p_dev->prio = prio;
+
+  return true;
 }
 
-bool i2cRecovery(uint8_t ch)
+bool i2cSubmit(uint8_t ch, i2c_xfer_t *p_xfer)
 {
-  bool ret;
+  i2c_bus_t   *p_bus;
+  i2c_xfer_t **pp_next;
+  uint32_t     primask;
 
-  i2cReset(ch);
 
-  ret = i2cBegin(ch, i2c_freq[ch]);
+  if (ch >= I2C_MAX_CH || p_xfer == NULL || is_begin[ch] != true)
+  {
+    return false;
+  }
+  if (p_xfer->state == I2C_XFER_QUEUED || p_xfer->state == I2C_XFER_ACTIVE)
+  {
+    return false;
+  }
+  if (p_xfer->reg_size > 2 || (p_xfer->length > 0 && p_xfer->p_data == NULL))
+  {
+    return false;
+  }
+  p_bus = &i2c_bus[ch];
+
+  if (p_xfer->prio >= I2C_PRIO_MAX)
+    p_xfer->prio = I2C_PRIO_LOW;
+  p_xfer->ret       = false;
+  p_xfer->submit_us = micros();
+  p_xfer->p_next    = NULL;
+  p_xfer->state     = I2C_XFER_QUEUED;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  pp_next = &p_bus->p_head;
+  while (*pp_next != NULL && (*pp_next)->prio <= p_xfer->prio)
+  {
+    pp_next = &(*pp_next)->p_next;
+  }
+  p_xfer->p_next = *pp_next;
+  *pp_next = p_xfer;
 
-  return ret;
+  if (p_bus->p_cur == NULL && p_bus->req_recovery != true)
+  {
+    i2cStartNext(ch);
+  }
+  __set_PRIMASK(primask);
+
+  return true;
 }
 
-bool i2cReadByte (uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t timeout)
+bool i2cIsBusy(uint8_t ch)
 {
-  return i2cReadBytes(ch, dev_addr, reg_addr, p_data, 1, timeout);
+  i2cUpdate();
+
+  return i2c_bus[ch].p_cur != NULL || i2c_bus[ch].p_head != NULL;
 }
 
-bool i2cReadBytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+void i2cUpdate(void)
 {
-  #if 1
-  bool ret;
-  HAL_StatusTypeDef i2c_ret;
+  i2c_bus_t *p_bus;
+  uint32_t   primask;
+  bool       is_pending = false;
 
-  if (ch >= I2C_MAX_CH)
+
+  for (int ch=0; ch<I2C_MAX_CH; ch++)
   {
-    return false;
-  }
+    p_bus = &i2c_bus[ch];
 
-  lock();
-  i2c_ret = HAL_I2C_Mem_Read(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), reg_addr, I2C_MEMADD_SIZE_8BIT, p_data, length, timeout);
-  unLock();
+    // 인터럽트에서 미룬 전송을 STOP 이 끝났으면 시작한다.
+    //
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (p_bus->start_pending == true && p_bus->p_cur == NULL && p_bus->req_recovery != true)
+    {
+      if (i2c_tbl[ch].p_i2c->CTRL1_B.STOP && micros()-p_bus->stop_pre_us >= I2C_STOP_TIMEOUT_US)
+      {
+        p_bus->start_pending = false;
+        p_bus->req_recovery  = true;
+      }
+      else
+      {
+        i2cStartNext(ch);
+      }
+    }
+    is_pending |= p_bus->start_pending;
+    __set_PRIMASK(primask);
+
+    // 인터럽트가 멈춘 전송은 실패로 끝내고 버스를 복구한다.
+    //
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (p_bus->p_cur != NULL && millis()-p_bus->pre_time >= p_bus->p_cur->timeout)
+    {
+      p_bus->req_recovery = true;
+      i2cFinish(ch, false);
+    }
+    __set_PRIMASK(primask);
 
-  if( i2c_ret == HAL_OK )
-  {
-    ret = true;
+    if (p_bus->req_recovery == true)
+    {
+      i2cRecovery(ch);
+      p_bus->recovery_cnt++;
+
+      primask = __get_PRIMASK();
+      __disable_irq();
+      p_bus->req_recovery = false;
+      if (p_bus->p_cur == NULL)
+      {
+        i2cStartNext(ch);
+      }
+      __set_PRIMASK(primask);
+    }
   }
-  else
+
+  // STOP 은 수 us 안에 끝나므로 잠들지 않고 다음 라운드에서 바로 확인한다.
+#ifdef _USE_HW_TASK
+  if (is_pending == true)
   {
-    ret = false;
+    taskSetBusy();
   }
-
-  return ret;
-  #else
-  return false;
-  #endif
+#endif
 }
 
-bool i2cReadA16Bytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+void i2cStartNext(uint8_t ch)
 {
-  #if 1
-  bool ret;
-  HAL_StatusTypeDef i2c_ret;
+  I2C_T      *p_i2c = i2c_tbl[ch].p_i2c;
+  i2c_bus_t  *p_bus = &i2c_bus[ch];
+  i2c_xfer_t *p_xfer;
 
-  if (ch >= I2C_MAX_CH)
+
+  p_xfer = p_bus->p_head;
+  if (p_xfer == NULL)
   {
-    return false;
+    p_bus->start_pending = false;
+    return;
   }
 
-  lock();
-  i2c_ret = HAL_I2C_Mem_Read(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), reg_addr, I2C_MEMADD_SIZE_16BIT, p_data, length, timeout);
-  unLock();
-
-  if( i2c_ret == HAL_OK )
+  // 이전 전송의 STOP 이 나간 후에 START 해야 한다. 완료 인터럽트에서 불리므로
+  // 여기서 기다리지 않고 i2cUpdate() 로 미룬다.
+  //
+  if (p_i2c->CTRL1_B.STOP)
   {
-    ret = true;
+    if (p_bus->start_pending != true)
+    {
+      p_bus->start_pending = true;
+      p_bus->stop_pre_us   = micros();
+      p_bus->defer_cnt++;
+    }
+    return;
   }
+  p_bus->start_pending = false;
+
+  p_bus->p_head = p_xfer->p_next;
+  p_bus->p_cur  = p_xfer;
+
+  p_xfer->state   = I2C_XFER_ACTIVE;
+  p_bus->start_us = micros();
+  p_bus->pre_time = millis();
+  p_bus->tx_index = 0;
+  p_bus->tx_total = p_xfer->reg_size + (p_xfer->is_read ? 0 : p_xfer->length);
+  p_bus->rx_index = 0;
+  if (p_xfer->is_read && p_xfer->reg_size == 0)
+    p_bus->phase = I2C_PHASE_RX_ADDR;
   else
-  {
-    ret = false;
-  }
+    p_bus->phase = I2C_PHASE_TX;
 
-  return ret;
-  #else
-  return false;
-  #endif
+  I2C_EnableAcknowledge(p_i2c);
+  I2C_EnableInterrupt(p_i2c, I2C_INT_EVT | I2C_INT_ERR);
+  I2C_EnableGenerateStart(p_i2c);
 }
 
-bool i2cReadData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+void i2cFinish(uint8_t ch, bool ret)
 {
-  #if 1
-  bool ret;
-  HAL_StatusTypeDef i2c_ret;
+  I2C_T      *p_i2c = i2c_tbl[ch].p_i2c;
+  i2c_bus_t  *p_bus = &i2c_bus[ch];
+  i2c_xfer_t *p_xfer;
+  i2c_dev_t  *p_dev;
+  uint32_t    wait_us;
+  uint32_t    time_us;
 
-  if (ch >= I2C_MAX_CH)
+
+  p_xfer = p_bus->p_cur;
+  if (p_xfer == NULL)
   {
-    return false;
+    return;
   }
 
-  lock();
-  i2c_ret = HAL_I2C_Master_Receive(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), p_data, length, timeout);
-  unLock();
-
-  if( i2c_ret == HAL_OK )
+  I2C_DisableInterrupt(p_i2c, I2C_INT_EVT | I2C_INT_BUF | I2C_INT_ERR);
+  p_i2c->CTRL1_B.ACKPOS = 0;
+  I2C_EnableAcknowledge(p_i2c);
+  p_bus->p_cur = NULL;
+
+  wait_us = p_bus->start_us - p_xfer->submit_us;
+  time_us = micros() - p_xfer->submit_us;
+  // 장치 등록은 i2cSetPriority() 에서만 하고, 스캔 같은 probe 로는 표가 차지 않게 한다.
+  // probe 의 NACK 는 장치가 없거나 바쁘다는 정상 응답이므로 에러로 세지 않는다.
+  //
+  p_dev   = i2cGetDev(ch, p_xfer->dev_addr, false);
+  if (p_dev != NULL)
   {
-    ret = true;
+    p_dev->count++;
+    p_dev->time_sum += time_us;
+    if (wait_us > p_dev->wait_max)
+      p_dev->wait_max = wait_us;
+    if (time_us > p_dev->time_max)
+      p_dev->time_max = time_us;
+    if (ret != true && p_xfer->is_probe != true)
+      p_dev->err_cnt++;
   }
-  else
+  if (ret != true && p_xfer->is_probe != true)
   {
-    ret = false;
+    i2c_errcount[ch]++;
   }
 
-  return ret;
-  #else
-  return false;
-  #endif
+  p_xfer->ret   = ret;
+  p_xfer->state = I2C_XFER_DONE;
+  if (p_xfer->func != NULL)
+  {
+    p_xfer->func(p_xfer, ret);
+  }
+
+  if (p_bus->p_cur == NULL && p_bus->req_recovery != true)
+  {
+    i2cStartNext(ch);
+  }
 }
 
-bool i2cWriteByte (uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t data, uint32_t timeout)
+uint8_t i2cGetTxByte(i2c_bus_t *p_bus)
 {
-  return i2cWriteBytes(ch, dev_addr, reg_addr, &data, 1, timeout);
+  i2c_xfer_t *p_xfer = p_bus->p_cur;
+  uint32_t    index  = p_bus->tx_index++;
+
+  if (index < p_xfer->reg_size)
+  {
+    if (p_xfer->reg_size == 2 && index == 0)
+      return p_xfer->reg_addr >> 8;
+    else
+      return p_xfer->reg_addr & 0xFF;
+  }
+
+  return p_xfer->p_data[index - p_xfer->reg_size];
 }
 
-bool i2cWriteBytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+void i2cEvtISR(uint8_t ch)
 {
-  #if 1
-  bool ret;
-  HAL_StatusTypeDef i2c_ret;
+  I2C_T      *p_i2c  = i2c_tbl[ch].p_i2c;
+  i2c_bus_t  *p_bus  = &i2c_bus[ch];
+  i2c_xfer_t *p_xfer = p_bus->p_cur;
+  uint32_t    sts1;
+  uint32_t    remain;
 
-  if (ch >= I2C_MAX_CH)
+
+  if (p_xfer == NULL)
   {
-    return false;
+    I2C_DisableInterrupt(p_i2c, I2C_INT_EVT | I2C_INT_BUF | I2C_INT_ERR);
+    return;
   }
+  sts1 = p_i2c->STS1;
 
-  lock();
-  i2c_ret = HAL_I2C_Mem_Write(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), reg_addr, I2C_MEMADD_SIZE_8BIT, p_data, length, timeout);
-  unLock();
+  if (sts1 & I2C_STS1_START)
+  {
+    if (p_bus->phase == I2C_PHASE_TX)
+      I2C_Tx7BitAddress(p_i2c, p_xfer->dev_addr << 1, I2C_DIRECTION_TX);
+    else
+      I2C_Tx7BitAddress(p_i2c, p_xfer->dev_addr << 1, I2C_DIRECTION_RX);
+    return;
+  }
 
-  if(i2c_ret == HAL_OK)
+  if (sts1 & I2C_STS1_ADDR)
   {
-    ret = true;
+    if (p_bus->phase == I2C_PHASE_TX)
+    {
+      (void)p_i2c->STS2;
+      if (p_bus->tx_total == 0)
+      {
+        I2C_EnableGenerateStop(p_i2c);
+        i2cFinish(ch, true);
+        return;
+      }
+      I2C_TxData(p_i2c, i2cGetTxByte(p_bus));
+      I2C_EnableInterrupt(p_i2c, I2C_INT_BUF);
+      return;
+    }
+
+    // 수신 바이트 수에 따라 ADDR 을 지우기 전에 ACK/STOP 을 정한다.
+    //
+    p_bus->phase = I2C_PHASE_RX;
+    if (p_xfer->length <= 1)
+    {
+      I2C_DisableAcknowledge(p_i2c);
+      (void)p_i2c->STS2;
+      I2C_EnableGenerateStop(p_i2c);
+      if (p_xfer->length == 0)
+      {
+        i2cFinish(ch, true);
+        return;
+      }
+      I2C_EnableInterrupt(p_i2c, I2C_INT_BUF);
+    }
+    else if (p_xfer->length == 2)
+    {
+      I2C_DisableAcknowledge(p_i2c);
+      p_i2c->CTRL1_B.ACKPOS = 1;
+      (void)p_i2c->STS2;
+    }
+    else
+    {
+      I2C_EnableAcknowledge(p_i2c);
+      (void)p_i2c->STS2;
+      I2C_EnableInterrupt(p_i2c, I2C_INT_BUF);
+    }
+    return;
   }
-  else
+
+  if (p_bus->phase == I2C_PHASE_TX)
   {
-    ret = false;
+    if ((sts1 & I2C_STS1_TXBE) && p_bus->tx_index < p_bus->tx_total)
+    {
+      I2C_TxData(p_i2c, i2cGetTxByte(p_bus));
+      return;
+    }
+    if (sts1 & I2C_STS1_BTC)
+    {
+      I2C_DisableInterrupt(p_i2c, I2C_INT_BUF);
+      if (p_xfer->is_read)
+      {
+        p_bus->phase = I2C_PHASE_RX_ADDR;
+        I2C_EnableGenerateStart(p_i2c);
+      }
+      else
+      {
+        I2C_EnableGenerateStop(p_i2c);
+        i2cFinish(ch, true);
+      }
+      return;
+    }
+    if (sts1 & I2C_STS1_TXBE)
+    {
+      I2C_DisableInterrupt(p_i2c, I2C_INT_BUF);
+    }
+    return;
   }
 
-  return ret;
-  #else
-  return false;
-  #endif
+  if (p_bus->phase == I2C_PHASE_RX)
+  {
+    remain = p_xfer->length - p_bus->rx_index;
+
+    if ((sts1 & I2C_STS1_RXBNE) && !(sts1 & I2C_STS1_BTC) && p_i2c->CTRL2_B.BUFIEN)
+    {
+      if (remain > 3)
+      {
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+        if (remain - 1 == 3)
+          I2C_DisableInterrupt(p_i2c, I2C_INT_BUF);
+      }
+      else if (remain == 1)
+      {
+        I2C_DisableInterrupt(p_i2c, I2C_INT_BUF);
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+        i2cFinish(ch, true);
+      }
+      else
+      {
+        // 마지막 2~3 바이트는 BTC 에서 NACK/STOP 과 같이 처리한다.
+        I2C_DisableInterrupt(p_i2c, I2C_INT_BUF);
+      }
+      return;
+    }
+
+    if (sts1 & I2C_STS1_BTC)
+    {
+      if (remain == 3)
+      {
+        I2C_DisableAcknowledge(p_i2c);
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+      }
+      else if (remain == 2)
+      {
+        I2C_EnableGenerateStop(p_i2c);
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+        i2cFinish(ch, true);
+      }
+      else
+      {
+        p_xfer->p_data[p_bus->rx_index++] = I2C_RxData(p_i2c);
+        if (remain == 1)
+          i2cFinish(ch, true);
+      }
+    }
+  }
 }
 
-bool i2cWriteA16Bytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+void i2cErrISR(uint8_t ch)
 {
-  #if 1
-  bool ret;
-  HAL_StatusTypeDef i2c_ret;
+  I2C_T    *p_i2c = i2c_tbl[ch].p_i2c;
+  uint32_t  sts1  = p_i2c->STS1;
 
-  if (ch >= I2C_MAX_CH)
-  {
-    return false;
-  }
 
-  lock();
-  i2c_ret = HAL_I2C_Mem_Write(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), reg_addr, I2C_MEMADD_SIZE_16BIT, p_data, length, timeout);
-  unLock();
+  I2C_ClearStatusFlag(p_i2c, I2C_FLAG_AE);
+  I2C_ClearStatusFlag(p_i2c, I2C_FLAG_AL);
+  I2C_ClearStatusFlag(p_i2c, I2C_FLAG_BERR);
+  I2C_ClearStatusFlag(p_i2c, I2C_FLAG_OVRUR);
 
-  if(i2c_ret == HAL_OK)
-  {
-    ret = true;
-  }
+  // NACK 는 해당 전송만 실패로 끝내고, 버스 오류는 복구 후에 다음 전송을 시작한다.
+  //
+  if (sts1 & (I2C_STS1_BERR | I2C_STS1_AL))
+    i2c_bus[ch].req_recovery = true;
+  else
+    I2C_EnableGenerateStop(p_i2c);
+
+  if (i2c_bus[ch].p_cur != NULL)
+    i2cFinish(ch, false);
   else
+    I2C_DisableInterrupt(p_i2c, I2C_INT_EVT | I2C_INT_BUF | I2C_INT_ERR);
+}
+
+void i2cReset(uint8_t ch)
+{
+  GPIO_Config_T  GPIO_InitStruct;
+  i2c_tbl_t *p_pin = &i2c_tbl[ch];
+
+  lock();
+  GPIO_InitStruct.pin       = p_pin->scl_pin;
+  GPIO_InitStruct.mode      = GPIO_MODE_OUT_OD;
+  GPIO_InitStruct.speed     = GPIO_SPEED_10MHz;
+  GPIO_Config(p_pin->scl_port, &GPIO_InitStruct);
+
+  GPIO_InitStruct.pin       = p_pin->sda_pin;
+  GPIO_InitStruct.mode      = GPIO_MODE_OUT_OD;
+  GPIO_Config(p_pin->sda_port, &GPIO_InitStruct);
+
+
+  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
+  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_HIGH);
+  delayUs(5);
+
+  for (int i = 0; i < 9; i++)
   {
-    ret = false;
+
+    GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_LOW);
+    delayUs(5);
+    GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
+    delayUs(5);
   }
 
-  return ret;
-  #else
-  return false;
-  #endif
+  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_LOW);
+  delayUs(5);
+  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_LOW);
+  delayUs(5);
+
+  GPIO_WriteBitValue(p_pin->scl_port, p_pin->scl_pin, _DEF_HIGH);
+  delayUs(5);
+  GPIO_WriteBitValue(p_pin->sda_port, p_pin->sda_pin, _DEF_HIGH);
+  unLock();
 }
 
-bool i2cWriteData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+bool i2cIsDeviceReady(uint8_t ch, uint8_t dev_addr)
+{
+  return i2cTransfer(ch, dev_addr, false, 0, 0, NULL, 0, 10, true);
+}
+
+bool i2cRecovery(uint8_t ch)
 {
-  #if 0
   bool ret;
-  HAL_StatusTypeDef i2c_ret;
+
+  i2cReset(ch);
+
+  ret = i2cBegin(ch, i2c_freq[ch]);
+
+  return ret;
+}
+
+bool i2cTransfer(uint8_t ch, uint16_t dev_addr, bool is_read, uint8_t reg_size, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout, bool is_probe)
+{
+  bool       ret;
+  i2c_xfer_t xfer;
+  i2c_dev_t *p_dev;
+
 
   if (ch >= I2C_MAX_CH)
   {
     return false;
   }
 
-  lock();
-  i2c_ret = HAL_I2C_Master_Transmit(i2c_tbl[ch].p_i2c, (uint16_t)(dev_addr << 1), p_data, length, timeout);
-  unLock();
-  
-  if(i2c_ret == HAL_OK)
+  // 완료는 I2C 인터럽트에서 처리되므로 ISR 이나 인터럽트가 막힌 상태에서
+  // 기다리면 빠져나올 수 없다. 이런 호출은 i2cSubmit() 을 써야 한다.
+  //
+  if (__get_IPSR() != 0 || __get_PRIMASK() != 0)
   {
-    ret = true;
+    i2c_errcount[ch]++;
+    return false;
   }
-  else
+
+  p_dev = i2cGetDev(ch, dev_addr, false);
+
+  xfer.dev_addr = dev_addr;
+  xfer.is_read  = is_read;
+  xfer.reg_size = reg_size;
+  xfer.reg_addr = reg_addr;
+  xfer.p_data   = p_data;
+  xfer.length   = length;
+  xfer.prio     = p_dev != NULL ? p_dev->prio : I2C_PRIO_NORMAL;
+  xfer.timeout  = timeout > 0 ? timeout : i2c_timeout[ch];
+  xfer.is_probe = is_probe;
+  xfer.func     = NULL;
+  xfer.arg      = NULL;
+  xfer.state    = I2C_XFER_IDLE;
+
+  // 큐가 버스 접근을 직렬화하므로 완료될 때까지 기다리기만 한다.
+  //
+  ret = i2cSubmit(ch, &xfer);
+  if (ret == true)
   {
-    ret = false;
+    while(xfer.state != I2C_XFER_DONE)
+    {
+      i2cUpdate();
+    }
+    ret = xfer.ret;
   }
 
   return ret;
-  #else
-  return false;
-  #endif
+}
+
+bool i2cReadByte (uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t timeout)
+{
+  return i2cReadBytes(ch, dev_addr, reg_addr, p_data, 1, timeout);
+}
+
+bool i2cReadBytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, true, 1, reg_addr, p_data, length, timeout, false);
+}
+
+bool i2cReadA16Bytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, true, 2, reg_addr, p_data, length, timeout, false);
+}
+
+bool i2cReadData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, true, 0, 0, p_data, length, timeout, false);
+}
+
+bool i2cWriteByte (uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t data, uint32_t timeout)
+{
+  return i2cWriteBytes(ch, dev_addr, reg_addr, &data, 1, timeout);
+}
+
+bool i2cWriteBytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, false, 1, reg_addr, p_data, length, timeout, false);
+}
+
+bool i2cWriteA16Bytes(uint8_t ch, uint16_t dev_addr, uint16_t reg_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, false, 2, reg_addr, p_data, length, timeout, false);
+}
+
+bool i2cWriteData(uint8_t ch, uint16_t dev_addr, uint8_t *p_data, uint32_t length, uint32_t timeout)
+{
+  return i2cTransfer(ch, dev_addr, false, 0, 0, p_data, length, timeout, false);
 }
 
 void i2cSetTimeout(uint8_t ch, uint32_t timeout)
@@ -477,9 +913,25 @@ void delayUs(uint32_t us)
 }
 
 
+
 void I2C1_EV_IRQHandler(void)
 {
-  return;
+  i2cEvtISR(_DEF_I2C1);
+}
+
+void I2C1_ER_IRQHandler(void)
+{
+  i2cErrISR(_DEF_I2C1);
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+  i2cEvtISR(_DEF_I2C2);
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+  i2cErrISR(_DEF_I2C2);
 }
 
 
@@ -591,6 +1043,33 @@ if (args->argc == 2 && args->isStr(0, "scan") == true)
     ret = true;
   }
 
+  if (args->argc == 1 && args->isStr(0, "stat") == true)
+  {
+    for (int i=0; i<I2C_MAX_CH; i++)
+    {
+      i2c_bus_t *p_bus = &i2c_bus[i];
+
+      cliPrintf("CH%d err %d, recovery %d, start defer %d\n", i+1, i2c_errcount[i], p_bus->recovery_cnt, p_bus->defer_cnt);
+      cliPrintf("  addr prio    count      err wait_max(us)  avg(us)  max(us)\n");
+      for (int j=0; j<p_bus->dev_cnt; j++)
+      {
+        i2c_dev_t *p_dev = &p_bus->dev[j];
+        uint32_t   avg;
+
+        avg = p_dev->count > 0 ? p_dev->time_sum / p_dev->count : 0;
+        cliPrintf("  0x%02X %4d %8d %8d %12d %8d %8d\n",
+                  p_dev->dev_addr,
+                  p_dev->prio,
+                  p_dev->count,
+                  p_dev->err_cnt,
+                  p_dev->wait_max,
+                  avg,
+                  p_dev->time_max);
+      }
+    }
+    ret = true;
+  }
+
 
   if (ret == false)
   {
@@ -598,6 +1077,7 @@ if (args->argc == 2 && args->isStr(0, "scan") == true)
     cliPrintf( "i2c scan  ch[1~%d]\n", I2C_MAX_CH);
     cliPrintf( "i2c read  ch dev_addr reg_addr length\n");
     cliPrintf( "i2c write ch dev_addr reg_addr data\n");
+    cliPrintf( "i2c stat\n");
   }
 }
 
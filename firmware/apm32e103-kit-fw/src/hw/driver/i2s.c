@@ -1,4 +1,5 @@
 #include "i2s.h"
+#include "mem.h"
 
 
 #ifdef _USE_HW_I2S
@@ -9,6 +10,7 @@
 #include "files.h"
 #include "mixer.h"
 #include "nvs.h"
+#include "perf.h"
 #include <math.h>
 
 #define I2S_CFG_NAME     "cfg.i2s"
@@ -90,6 +92,9 @@ bool i2sInit(void)
   mixerInit(&mixer);
   i2sCfgLoad();
 
+  MEM_BUF_ADD("i2s frame", i2s_frame_buf);
+  MEM_BUF_ADD("mixer", &mixer);
+
   i2s_frame_len = (i2s_sample_rate * 2 * I2S_BUF_MS) / 1000;
 
 
@@ -705,6 +710,54 @@ void cliI2s(cli_args_t *args)
     ret = true;
   }
 
+#ifdef _USE_HW_PERF
+  if (args->argc == 1 && args->isStr(0, "bench") == true)
+  {
+    // DMA 인터럽트를 잠시 막고 같은 mixer 로 한 프레임 믹싱 시간을 잰다.
+    //
+    int16_t  buf[I2S_BUF_FRAME_LEN];
+    uint32_t frame_cycle = SystemCoreClock / 1000 * I2S_BUF_MS;
+
+    if (mixerAvailable(&mixer) > 0)
+    {
+      cliPrintf("i2s busy\n");
+      return;
+    }
+
+    for (int i=0; i<i2s_frame_len; i++)
+    {
+      buf[i] = (int16_t)(i * 997);
+    }
+
+    NVIC_DisableIRQRequest(DMA2_Channel2_IRQn);
+    for (int ch_cnt=1; ch_cnt<=MIXER_MAX_CH; ch_cnt++)
+    {
+      uint32_t pre_cycle;
+      uint32_t cycle = 0;
+
+      for (int i=0; i<16; i++)
+      {
+        for (int ch=0; ch<ch_cnt; ch++)
+          mixerWrite(&mixer, ch, buf, i2s_frame_len);
+
+        pre_cycle = perfGetCycle();
+        mixerRead(&mixer, buf, i2s_frame_len);
+        cycle += perfGetCycle() - pre_cycle;
+      }
+      cycle /= 16;
+
+      cliPrintf("%d ch : %6d cycle/frame, %3d cycle/sample, %d.%02d%%\n",
+                ch_cnt,
+                cycle,
+                cycle / i2s_frame_len,
+                cycle * 100 / frame_cycle,
+                cycle * 10000 / frame_cycle % 100);
+    }
+    NVIC_EnableIRQRequest(DMA2_Channel2_IRQn, 0, 0);
+    ret = true;
+  }
+#endif
+
   if (args->argc == 3 && args->isStr(0, "beep") == true)
   {
     uint32_t freq;
@@ -846,6 +899,9 @@ void cliI2s(cli_args_t *args)
   if (ret != true)
   {
     cliPrintf("i2s info\n");
+#ifdef _USE_HW_PERF
+    cliPrintf("i2s bench\n");
+#endif
     cliPrintf("i2s melody\n");
     cliPrintf("i2s beep freq time_ms\n");
     cliPrintf("i2s play-wav filename\n");
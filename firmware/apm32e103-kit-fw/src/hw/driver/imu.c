@@ -6,20 +6,25 @@
 #include "cli.h"
 #include "imu/icm42670.h"
 #include "imu/madgwick.h"
-
+#include "perf.h"
 
 
 #if CLI_USE(HW_IMU)
 static void cliCmd(cli_args_t *args);
 #endif
-static void imuComputeIMU( void );
+static bool imuComputeIMU( void );
 static bool imuUpdateInfo(imu_info_t *p_info);
+static void imuFillInfo(void);
 
-static uint32_t        update_hz = 100;
+static uint32_t        update_hz = HW_IMU_ODR_HZ;
 static uint32_t        update_us;
+static uint32_t        update_time;
+static uint32_t        sample_count = 0;
 static bool            is_init   = false;
+static bool            is_info_filled = false;
 static imu_info_t      imu_info;
 static madgwick_info_t filter_info;
+static void          (*sample_func)(imu_sample_t *p_sample) = NULL;
 
 
 bool imuInit(void)
@@ -29,7 +34,7 @@ bool imuInit(void)
 
   imu_info.a_res = 2.0 / 32768.0;    // 2g
   imu_info.g_res = 2000.0 / 32768.0; // 2000dps
-  update_us      = 1000000 / update_hz;
+  update_us      = HW_IMU_UPDATE_MS * 1000;
 
   is_init = imuBegin();
   ret = is_init;
@@ -54,8 +59,9 @@ bool imuBegin(void)
   ret &= icm42670Init();
   ret &= madgwickInit();
 
-  madgwickSetFreq(update_hz);
-  
+  // 첫 update 에서 바로 샘플을 받도록 FIFO 개수 읽기를 미리 걸어 둔다.
+  icm42670StartFifo();
+
   return ret;
 }
 
@@ -64,95 +70,164 @@ bool imuGetInfo(imu_info_t *p_info)
   if (!is_init)
     return false;
 
+  imuFillInfo();
   *p_info = imu_info;
 
   return true;
 }
 
+// 필터에 넣은 샘플마다 호출된다. 태스크 안에서 호출되므로 길게 처리하면 안된다.
+//
+bool imuSetSampleCallback(void (*p_func)(imu_sample_t *p_sample))
+{
+  sample_func = p_func;
+  return true;
+}
+
+// HW_IMU_UPDATE_MS 주기의 태스크에서 호출한다. 주기는 태스크가 맞추므로 바로 계산한다.
+//
 bool imuUpdate(void)
 {
-  bool ret;
+  update_time = micros();
 
-  ret = imuUpdateInfo(&imu_info);
-  return ret;
+  return imuComputeIMU();
 }
 
 bool imuUpdateInfo(imu_info_t *p_info)
 {
   bool ret = false;
-  static uint32_t tTime;
 
 
-  if( (micros()-tTime) >= update_us )
+  if( (micros()-update_time) >= update_us )
   {
-    tTime = micros();
-
-    imuComputeIMU();
+    update_time = micros();
 
-    *p_info = imu_info;
-
-    ret = true;
+    if (imuComputeIMU())
+    {
+      imuFillInfo();
+      *p_info = imu_info;
+      ret = true;
+    }
   }
 
   return ret;
 }
 
-
-#define FILTER_NUM    3
-
-void imuComputeIMU( void )
+// float 값은 읽는 쪽에서 필요할 때만 변환한다.
+//
+void imuFillInfo(void)
 {
-  static uint32_t prev_process_time = 0;
-  static uint32_t cur_process_time = 0;
-  static uint32_t process_time = 0;
-  icm42670_info_t sensor_info;
-  int16_t gyro_offset = 15;
+  if (is_info_filled)
+    return;
+
+  madgwickGetInfo(&filter_info);
 
+  imu_info.ax = (float)imu_info.a_raw[0]*imu_info.a_res;
+  imu_info.ay = (float)imu_info.a_raw[1]*imu_info.a_res;
+  imu_info.az = (float)imu_info.a_raw[2]*imu_info.a_res;
 
-  if (!icm42670GetInfo(&sensor_info))
-  {
-    return;
-  }
+  imu_info.gx = (float)imu_info.g_raw[0]*imu_info.g_res;
+  imu_info.gy = (float)imu_info.g_raw[1]*imu_info.g_res;
+  imu_info.gz = (float)imu_info.g_raw[2]*imu_info.g_res;
 
-  if (micros() - prev_process_time > 100*1000)
+  for (int i=0; i<4; i++)
   {
-    prev_process_time = micros();
+    imu_info.quat[i] = (float)filter_info.quat[i] / (float)(1<<MADGWICK_Q);
   }
 
-  if (sensor_info.gyro_x > -gyro_offset && sensor_info.gyro_x < gyro_offset)
-    sensor_info.gyro_x = 0;
-  if (sensor_info.gyro_y > -gyro_offset && sensor_info.gyro_y < gyro_offset)
-    sensor_info.gyro_y = 0;
-  if (sensor_info.gyro_z > -gyro_offset && sensor_info.gyro_z < gyro_offset)
-    sensor_info.gyro_z = 0;
+  imu_info.roll  = (float)filter_info.deg_roll  / (float)(1<<MADGWICK_DEG_Q);
+  imu_info.pitch = (float)filter_info.deg_pitch / (float)(1<<MADGWICK_DEG_Q);
+  imu_info.yaw   = (float)filter_info.deg_yaw   / (float)(1<<MADGWICK_DEG_Q);
 
-  imu_info.ax = (float)sensor_info.acc_x*imu_info.a_res;
-  imu_info.ay = (float)sensor_info.acc_y*imu_info.a_res;
-  imu_info.az = (float)sensor_info.acc_z*imu_info.a_res;
+  is_info_filled = true;
+}
 
-  imu_info.gx = (float)sensor_info.gyro_x*imu_info.g_res;
-  imu_info.gy = (float)sensor_info.gyro_y*imu_info.g_res;
-  imu_info.gz = (float)sensor_info.gyro_z*imu_info.g_res;
 
-  imu_info.a_raw[0] = sensor_info.acc_x;
-  imu_info.a_raw[1] = sensor_info.acc_y;
-  imu_info.a_raw[2] = sensor_info.acc_z;
+// FIFO 에 쌓인 샘플을 순서대로 필터에 넣는다. dt 는 센서 타임스탬프로 계산한다.
+//
+bool imuComputeIMU( void )
+{
+  static icm42670_info_t sensor_tbl[ICM42670_FIFO_READ_MAX];
+  static uint32_t pre_timestamp;
+  static bool     is_pre_timestamp = false;
+  icm42670_info_t *p_sensor;
+  int16_t  gyro_offset = 15;
+  int16_t  gyro[3];
+  int32_t  gyro_q16[3];
+  int32_t  acc[3];
+  uint32_t count;
+  uint32_t dt_us;
+
+
+  count = icm42670ReadFifo(sensor_tbl, ICM42670_FIFO_READ_MAX);
+  if (count == 0)
+  {
+    return false;
+  }
 
-  imu_info.g_raw[0] = sensor_info.gyro_x;
-  imu_info.g_raw[1] = sensor_info.gyro_y;
-  imu_info.g_raw[2] = sensor_info.gyro_z;
+  for (int i=0; i<count; i++)
+  {
+    p_sensor = &sensor_tbl[i];
+
+    // 타임스탬프를 다시 맞춘 직후에는 차이가 맞지 않으므로 ODR 주기로 대신한다.
+    if (is_pre_timestamp)
+      dt_us = p_sensor->timestamp - pre_timestamp;
+    else
+      dt_us = 1000000 / update_hz;
+    if (dt_us == 0 || dt_us > 4 * 1000000 / update_hz)
+      dt_us = 1000000 / update_hz;
+    pre_timestamp    = p_sensor->timestamp;
+    is_pre_timestamp = true;
+
+    // 정지 상태의 작은 자이로 값은 필터에만 0 으로 넣는다.
+    gyro[0] = p_sensor->gyro_x;
+    gyro[1] = p_sensor->gyro_y;
+    gyro[2] = p_sensor->gyro_z;
+    for (int j=0; j<3; j++)
+    {
+      if (gyro[j] > -gyro_offset && gyro[j] < gyro_offset)
+        gyro[j] = 0;
+      gyro_q16[j] = (gyro[j] * IMU_GYRO_RAD_Q24) >> 8;
+    }
+    acc[0] = p_sensor->acc_x;
+    acc[1] = p_sensor->acc_y;
+    acc[2] = p_sensor->acc_z;
+
+    madgwickUpdate(gyro_q16, acc, dt_us);
+
+    if (sample_func != NULL)
+    {
+      imu_sample_t sample;
+
+      madgwickGetInfo(&filter_info);
+
+      sample.timestamp  = p_sensor->timestamp;
+      sample.a_raw[0]   = p_sensor->acc_x;
+      sample.a_raw[1]   = p_sensor->acc_y;
+      sample.a_raw[2]   = p_sensor->acc_z;
+      sample.g_raw[0]   = p_sensor->gyro_x;
+      sample.g_raw[1]   = p_sensor->gyro_y;
+      sample.g_raw[2]   = p_sensor->gyro_z;
+      sample.roll_x100  = (filter_info.deg_roll  * 100) >> MADGWICK_DEG_Q;
+      sample.pitch_x100 = (filter_info.deg_pitch * 100) >> MADGWICK_DEG_Q;
+      sample.yaw_x100   = (filter_info.deg_yaw   * 100) >> MADGWICK_DEG_Q;
+
+      sample_func(&sample);
+    }
+  }
+  sample_count += count;
 
-  cur_process_time  = micros();
-  process_time      = cur_process_time-prev_process_time;
-  prev_process_time = cur_process_time;
+  p_sensor = &sensor_tbl[count-1];
+  imu_info.a_raw[0] = p_sensor->acc_x;
+  imu_info.a_raw[1] = p_sensor->acc_y;
+  imu_info.a_raw[2] = p_sensor->acc_z;
 
-  madgwickSetFreqTime(process_time/1000000.0f);
-  madgwickUpdate(imu_info.gx, imu_info.gy, imu_info.gz, imu_info.ax, imu_info.ay, imu_info.az);
-  madgwickGetInfo(&filter_info);
+  imu_info.g_raw[0] = p_sensor->gyro_x;
+  imu_info.g_raw[1] = p_sensor->gyro_y;
+  imu_info.g_raw[2] = p_sensor->gyro_z;
 
-  imu_info.roll  = filter_info.deg_roll;
-  imu_info.pitch = filter_info.deg_pitch;
-  imu_info.yaw   = filter_info.deg_yaw - 180;
+  is_info_filled = false;
+  return true;
 }
 
 
@@ -165,6 +240,8 @@ void cliCmd(cli_args_t *args)
   if (args->argc == 1 && args->isStr(0, "info"))
   {
     cliPrintf("imu init : %d\n", is_init);
+    cliPrintf("odr      : %d Hz\n", update_hz);
+    cliPrintf("samples  : %d\n", sample_count);
     ret = true;
   }
 
@@ -239,6 +316,39 @@ void cliCmd(cli_args_t *args)
     ret = true;
   }
 
+#ifdef _USE_HW_PERF
+  if (args->argc == 1 && args->isStr(0, "bench"))
+  {
+    // dt 를 0 으로 넣어 현재 자세는 그대로 두고 계산 시간만 측정한다.
+    const uint32_t  count       = 1000;
+    const int32_t   gyro_q16[3] = {1 << 16, -2 << 16, 3 << 16};
+    const int32_t   acc[3]      = {2000, -3000, 16000};
+    madgwick_info_t info;
+    uint32_t        pre_cycle;
+    uint32_t        update_cycle;
+    uint32_t        angle_cycle;
+
+    pre_cycle = perfGetCycle();
+    for (int i=0; i<count; i++)
+    {
+      madgwickUpdate(gyro_q16, acc, 0);
+    }
+    update_cycle = (perfGetCycle() - pre_cycle) / count;
+
+    pre_cycle = perfGetCycle();
+    for (int i=0; i<count; i++)
+    {
+      madgwickUpdate(gyro_q16, acc, 0);
+      madgwickGetInfo(&info);
+    }
+    angle_cycle = (perfGetCycle() - pre_cycle) / count - update_cycle;
+    is_info_filled = false;
+
+    cliPrintf("update : %d cycle, %d us\n", update_cycle, update_cycle / (SystemCoreClock / 1000000));
+    cliPrintf("angles : %d cycle, %d us\n", angle_cycle, angle_cycle / (SystemCoreClock / 1000000));
+    ret = true;
+  }
+#endif
 
   if (ret == false)
   {
@@ -246,7 +356,9 @@ void cliCmd(cli_args_t *args)
     cliPrintf( "imu acc\n");
     cliPrintf( "imu gyro\n");
     cliPrintf( "imu show\n");
-    cliPrintf( "imu graph\n");
+#ifdef _USE_HW_PERF
+    cliPrintf( "imu bench\n");
+#endif
   }
 }
 
@@ -11,6 +11,22 @@
 #define WHO_AM_I      ICM42670_WHO_AM_I
 #define REG_WHO_AM_I  ICM42670_REG_WHO_AM_I
 
+#define MREG1_BANK    0x00
+
+// 16bit 타임스탬프는 65.5ms 마다 돌아가므로 읽기 간격이 절반을 넘으면
+// 차이를 믿을 수 없어 micros() 로 다시 맞춘다.
+#define FIFO_TMST_RESYNC_US   32768
+#define FIFO_TMST_SLEW_SHIFT  3       // 읽을 때마다 micros() 와의 차이를 1/8 씩 줄인다.
+
+
+typedef enum
+{
+  FIFO_STATE_IDLE,
+  FIFO_STATE_COUNT,
+  FIFO_STATE_DATA,
+  FIFO_STATE_READY,
+} FifoState_t;
+
 
 #if CLI_USE(HW_LED)
 static void cliCmd(cli_args_t *args);
@@ -19,13 +35,55 @@ bool regReadByte(uint16_t addr, uint8_t *p_data);
 bool regWriteByte(uint16_t addr, uint8_t data);
 bool regRead(uint16_t addr, uint8_t *p_data, uint16_t length);
 bool regWrite(uint16_t addr, uint8_t *p_data, uint16_t length);
+static bool mregWriteByte(uint8_t bank, uint8_t addr, uint8_t data);
 static bool icm42670InitRegs(void);
+static void fifoSetXfer(uint16_t reg_addr, uint8_t *p_data, uint16_t length);
+static void fifoISR(i2c_xfer_t *p_xfer, bool ret);
+static uint32_t fifoParse(icm42670_info_t *p_info, uint32_t max_count);
+
+
+//-- 필터 대역은 ODR 의 절반보다 낮게 맞춘다.
+//
+typedef struct
+{
+  uint16_t freq_hz;
+  uint8_t  odr;
+  uint8_t  gyro_lpf;
+  uint8_t  accel_lpf;
+} icm42670_odr_t;
+
+static const icm42670_odr_t odr_tbl[] =
+{
+  {  50, ICM42670_GYRO_ODR_50HZ,  ICM42670_GYRO_LFP_16HZ,  ICM42670_ACCEL_LFP_16HZ},
+  { 100, ICM42670_GYRO_ODR_100HZ, ICM42670_GYRO_LFP_34HZ,  ICM42670_ACCEL_LFP_34HZ},
+  { 200, ICM42670_GYRO_ODR_200HZ, ICM42670_GYRO_LFP_73HZ,  ICM42670_ACCEL_LFP_73HZ},
+  { 400, ICM42670_GYRO_ODR_400HZ, ICM42670_GYRO_LFP_53HZ,  ICM42670_ACCEL_LFP_53HZ},
+  { 800, ICM42670_GYRO_ODR_800HZ, ICM42670_GYRO_LFP_121HZ, ICM42670_ACCEL_LFP_121HZ},
+};
 
 static bool    is_init     = false;
 static uint8_t i2c_ch      = HW_I2C_CH_IMU;
 static uint8_t i2c_addr    = ICM42670_I2C_ADDR_GND;
 static bool    is_found    = false;
 
+static volatile FifoState_t fifo_state = FIFO_STATE_IDLE;
+static i2c_xfer_t fifo_xfer;
+static uint8_t    fifo_count_buf[2];
+static uint8_t    fifo_buf[ICM42670_FIFO_READ_MAX * ICM42670_FIFO_PACKET_SIZE];
+static uint16_t   fifo_length;
+static uint16_t   fifo_pre_tmst;
+static bool       fifo_is_tmst = false;
+static uint32_t   fifo_tmst;
+static int32_t    fifo_tmst_ofs;
+static uint32_t   fifo_period_us;
+static uint32_t   fifo_rd_us;
+static uint32_t   fifo_pre_rd_us;
+static uint32_t   fifo_read_cnt;
+static uint32_t   fifo_sample_cnt;
+static uint32_t   fifo_err_cnt;
+static uint32_t   fifo_resync_cnt;
+static uint16_t   fifo_level_max;
+
 
 
 
@@ -40,6 +98,8 @@ bool icm42670Init(void)
   {
     ret = i2cBegin(i2c_ch, 100);
   }
+  // EEPROM 과 같은 버스를 쓰므로 센서 읽기가 먼저 처리되도록 한다.
+  i2cSetPriority(i2c_ch, i2c_addr, I2C_PRIO_HIGH);
 
   if (ret)
   {
@@ -71,6 +131,17 @@ bool icm42670InitRegs(void)
 {
   
   uint8_t data;
+  const icm42670_odr_t *p_odr = &odr_tbl[0];
+
+
+  // ODR 은 태스크 주기와 같은 HW_IMU_ODR_HZ 를 사용한다.
+  for (int i=0; i<sizeof(odr_tbl)/sizeof(icm42670_odr_t); i++)
+  {
+    p_odr = &odr_tbl[i];
+    if (p_odr->freq_hz >= HW_IMU_ODR_HZ)
+      break;
+  }
+  fifo_period_us = 1000000 / p_odr->freq_hz;
 
 
   data = 1 << ICM42670_FIFO_FLUSH_SHIFT;
@@ -104,22 +175,45 @@ bool icm42670InitRegs(void)
   // GYRO
   //
   data  = ICM42670_GYRO_RANGE_2000DPS << ICM42670_GYRO_UI_FS_SEL_SHIFT;
-  data |= ICM42670_GYRO_ODR_400HZ     << ICM42670_GYRO_ODR_SHIFT;
+  data |= p_odr->odr                  << ICM42670_GYRO_ODR_SHIFT;
   regWriteByte(ICM42670_REG_GYRO_CONFIG0, data);
 
-  data = ICM42670_GYRO_LFP_53HZ << ICM42670_GYRO_UI_FILT_BW_SHIFT;
+  data = p_odr->gyro_lpf << ICM42670_GYRO_UI_FILT_BW_SHIFT;
   regWriteByte(ICM42670_REG_GYRO_CONFIG1, data);
 
   // ACCEL
   //
   data  = ICM42670_ACCEL_RANGE_2G  << ICM42670_ACCEL_UI_FS_SEL_SHIFT;
-  data |= ICM42670_ACCEL_ODR_400HZ << ICM42670_ACCEL_ODR_SHIFT;
+  data |= p_odr->odr               << ICM42670_ACCEL_ODR_SHIFT;
   regWriteByte(ICM42670_REG_ACCEL_CONFIG0, data);
 
   data  = ICM42670_ACCEL_AVG_2X   << ICM42670_ACCEL_UI_AVG_SHIFT;
-  data |= ICM42670_ACCEL_LFP_53HZ << ICM42670_ACCEL_UI_FILT_BW_SHIFT;
+  data |= p_odr->accel_lpf         << ICM42670_ACCEL_UI_FILT_BW_SHIFT;
   regWriteByte(ICM42670_REG_ACCEL_CONFIG1, data);
 
+  // FIFO
+  //   accel + gyro + ODR 타임스탬프(1us) 16 byte 패킷, stream 모드
+  //   개수는 byte 단위, 데이터는 big endian
+  data  = 1 << ICM42670_FIFO_COUNT_ENDIAN_SHIFT;
+  data |= 1 << ICM42670_SENSOR_DATA_ENDIAN_SHIFT;
+  regWriteByte(ICM42670_REG_INTF_CONFIG0, data);
+
+  data = 1 << ICM42670_TMST_EN_SHIFT;
+  mregWriteByte(MREG1_BANK, ICM42670_REG_TMST_CONFIG1, data);
+
+  data  = 1 << ICM42670_FIFO_WM_GT_TH_SHIFT;
+  data |= 1 << ICM42670_FIFO_TMST_FSYNC_EN_SHIFT;
+  data |= 1 << ICM42670_FIFO_GYRO_EN_SHIFT;
+  data |= 1 << ICM42670_FIFO_ACCEL_EN_SHIFT;
+  mregWriteByte(MREG1_BANK, ICM42670_REG_FIFO_CONFIG5, data);
+
+  data = 0;
+  regWriteByte(ICM42670_REG_FIFO_CONFIG1, data);
+
+  data = 1 << ICM42670_FIFO_FLUSH_SHIFT;
+  regWriteByte(ICM42670_REG_SIGNAL_PATH_RESET, data);
+  fifo_is_tmst = false;
+
   return true;
 }
 
@@ -150,6 +244,221 @@ bool icm42670GetInfo(icm42670_info_t *p_info)
   return ret;
 }
 
+// 이전에 읽어 둔 FIFO 샘플을 꺼내고 다음 읽기를 시작한다.
+//   FIFO 개수 → 데이터 순서로 인터럽트에서 이어서 읽으므로 기다리지 않는다.
+//
+uint32_t icm42670ReadFifo(icm42670_info_t *p_info, uint32_t max_count)
+{
+  uint32_t count = 0;
+
+
+  if (is_found == false)
+    return 0;
+
+  if (fifo_state == FIFO_STATE_READY)
+  {
+    count = fifoParse(p_info, max_count);
+    fifo_state = FIFO_STATE_IDLE;
+  }
+  icm42670StartFifo();
+
+  return count;
+}
+
+// FIFO 개수 읽기를 시작한다. 초기화 때 미리 불러 두면 첫 icm42670ReadFifo() 부터 샘플이 나온다.
+//
+bool icm42670StartFifo(void)
+{
+  if (is_found == false || fifo_state != FIFO_STATE_IDLE)
+    return false;
+
+  fifoSetXfer(ICM42670_REG_FIFO_COUNTH, fifo_count_buf, 2);
+  fifo_state = FIFO_STATE_COUNT;
+  if (i2cSubmit(i2c_ch, &fifo_xfer) != true)
+  {
+    fifo_state = FIFO_STATE_IDLE;
+    return false;
+  }
+
+  return true;
+}
+
+void fifoSetXfer(uint16_t reg_addr, uint8_t *p_data, uint16_t length)
+{
+  fifo_xfer.dev_addr = i2c_addr;
+  fifo_xfer.is_read  = true;
+  fifo_xfer.reg_size = 1;
+  fifo_xfer.prio     = I2C_PRIO_HIGH;
+  fifo_xfer.reg_addr = reg_addr;
+  fifo_xfer.length   = length;
+  fifo_xfer.p_data   = p_data;
+  fifo_xfer.timeout  = 5 + length/8;
+  fifo_xfer.func     = fifoISR;
+}
+
+void fifoISR(i2c_xfer_t *p_xfer, bool ret)
+{
+  uint16_t length;
+
+
+  // 읽지 못한 동안 타임스탬프가 한바퀴 돌았을 수 있으므로 다음 샘플에서 다시 맞춘다.
+  //
+  if (ret != true)
+  {
+    fifo_err_cnt++;
+    fifo_is_tmst = false;
+    fifo_state   = FIFO_STATE_IDLE;
+    return;
+  }
+
+  if (fifo_state == FIFO_STATE_COUNT)
+  {
+    // 이 시점에 FIFO 의 가장 최근 샘플은 ODR 한 주기 안에 만들어졌다.
+    fifo_rd_us = micros();
+
+    length = (fifo_count_buf[0] << 8) | (fifo_count_buf[1] << 0);
+    if (length > fifo_level_max)
+      fifo_level_max = length;
+
+    // 패킷 단위로만 읽고 남는 것은 다음에 읽는다.
+    if (length > sizeof(fifo_buf))
+      length = sizeof(fifo_buf);
+    length = length / ICM42670_FIFO_PACKET_SIZE * ICM42670_FIFO_PACKET_SIZE;
+    if (length == 0)
+    {
+      fifo_state = FIFO_STATE_IDLE;
+      return;
+    }
+
+    fifoSetXfer(ICM42670_REG_FIFO_DATA, fifo_buf, length);
+    fifo_state = FIFO_STATE_DATA;
+    if (i2cSubmit(i2c_ch, &fifo_xfer) != true)
+    {
+      fifo_state = FIFO_STATE_IDLE;
+    }
+  }
+  else if (fifo_state == FIFO_STATE_DATA)
+  {
+    fifo_length = p_xfer->length;
+    fifo_state  = FIFO_STATE_READY;
+  }
+}
+
+// 샘플 간격은 센서 클럭으로 정확하게 두고, 절대 시각은 micros() 에 맞춘다.
+//   timestamp = 누적한 센서 시각 + fifo_tmst_ofs 이며, 읽을 때마다 마지막 샘플과
+//   FIFO 개수를 읽은 시각의 차이로 ofs 를 조금씩 보정해서 센서 클럭이
+//   micros() 에서 벌어지지 않게 한다.
+//
+uint32_t fifoParse(icm42670_info_t *p_info, uint32_t max_count)
+{
+  icm42670_info_t *p_first = p_info;
+  uint32_t count = 0;
+  uint8_t *p_buf;
+  uint8_t  header;
+  uint16_t tmst;
+  bool     is_resync;
+  bool     is_tmst = false;
+  int32_t  err;
+
+
+  fifo_read_cnt++;
+
+  if (fifo_is_tmst && fifo_rd_us - fifo_pre_rd_us >= FIFO_TMST_RESYNC_US)
+  {
+    fifo_is_tmst = false;
+  }
+  is_resync = (fifo_is_tmst != true);
+  if (is_resync)
+  {
+    fifo_resync_cnt++;
+  }
+  fifo_pre_rd_us = fifo_rd_us;
+
+  for (int i=0; i<fifo_length; i+=ICM42670_FIFO_PACKET_SIZE)
+  {
+    if (count >= max_count)
+      break;
+
+    p_buf  = &fifo_buf[i];
+    header = p_buf[0];
+    if (header & ICM42670_FIFO_HEADER_MSG_BITS)
+      break;
+    if ((header & ICM42670_FIFO_HEADER_ACCEL_BITS) == 0 || (header & ICM42670_FIFO_HEADER_GYRO_BITS) == 0)
+      continue;
+
+    p_info->acc_x  = (p_buf[1]<<8)  | (p_buf[2]<<0);
+    p_info->acc_y  = (p_buf[3]<<8)  | (p_buf[4]<<0);
+    p_info->acc_z  = (p_buf[5]<<8)  | (p_buf[6]<<0);
+    p_info->gyro_x = (p_buf[7]<<8)  | (p_buf[8]<<0);
+    p_info->gyro_y = (p_buf[9]<<8)  | (p_buf[10]<<0);
+    p_info->gyro_z = (p_buf[11]<<8) | (p_buf[12]<<0);
+    p_info->temp   = (int8_t)p_buf[13] * 64;        // 레지스터 값과 같은 단위로 맞춘다.
+
+    // 16bit 센서 타임스탬프를 누적해서 32bit 로 늘린다.
+    if ((header & ICM42670_FIFO_HEADER_TMST_BITS) == ICM42670_FIFO_HEADER_TMST_ODR)
+    {
+      tmst = (p_buf[14]<<8) | (p_buf[15]<<0);
+      if (fifo_is_tmst)
+      {
+        fifo_tmst += (uint16_t)(tmst - fifo_pre_tmst);
+      }
+      else
+      {
+        fifo_tmst     = fifo_rd_us;
+        fifo_tmst_ofs = 0;
+      }
+      fifo_pre_tmst = tmst;
+      fifo_is_tmst  = true;
+      is_tmst       = true;
+      p_info->timestamp = fifo_tmst + fifo_tmst_ofs;
+    }
+    else
+    {
+      p_info->timestamp = micros();
+    }
+
+    p_info->acc_scale  = 16384;
+    p_info->gyro_scale = 164;
+
+    p_info++;
+    count++;
+  }
+  fifo_sample_cnt += count;
+
+  // 마지막 샘플은 FIFO 개수를 읽기 평균 반주기 전에 만들어졌다고 본다.
+  // 다시 맞춘 경우는 이번 샘플들까지 한번에 옮기고, 아니면 조금씩 따라간다.
+  //
+  if (is_tmst)
+  {
+    err = (int32_t)(fifo_rd_us - fifo_period_us/2 - (fifo_tmst + fifo_tmst_ofs));
+    if (is_resync)
+    {
+      fifo_tmst_ofs += err;
+      for (int i=0; i<count; i++)
+        p_first[i].timestamp += err;
+    }
+    else
+    {
+      fifo_tmst_ofs += err >> FIFO_TMST_SLEW_SHIFT;
+    }
+  }
+
+  return count;
+}
+
+bool mregWriteByte(uint8_t bank, uint8_t addr, uint8_t data)
+{
+  bool ret = true;
+
+  // 각 쓰기가 10us 보다 길게 걸리므로 따로 기다리지 않는다.
+  ret &= regWriteByte(ICM42670_REG_BLK_SEL_W, bank);
+  ret &= regWriteByte(ICM42670_REG_MADDR_W, addr);
+  ret &= regWriteByte(ICM42670_REG_M_W, data);
+  ret &= regWriteByte(ICM42670_REG_BLK_SEL_W, 0);
+
+  return ret;
+}
+
 bool regReadByte(uint16_t addr, uint8_t *p_data)
 {
   bool ret;  
@@ -168,26 +477,19 @@ bool regWriteByte(uint16_t addr, uint8_t data)
 
 bool regRead(uint16_t addr, uint8_t *p_data, uint16_t length)
 {
-  bool ret = true;  
+  bool ret;
 
-  ret = i2cIsDeviceReady(i2c_ch, i2c_addr);
-  if (ret)
-  {
-    ret = i2cReadBytes(i2c_ch, i2c_addr, addr, p_data, length, length * 5);
-  }
+  // 응답이 없으면 전송이 NACK 로 실패하므로 따로 확인하지 않는다.
+  ret = i2cReadBytes(i2c_ch, i2c_addr, addr, p_data, length, 5 + length/8);
 
   return ret;
 }
 
 bool regWrite(uint16_t addr, uint8_t *p_data, uint16_t length)
 {
-  bool ret = true;  
+  bool ret;
 
-  ret = i2cIsDeviceReady(i2c_ch, i2c_addr);
-  if (ret)
-  {
-    ret = i2cWriteBytes(i2c_ch, i2c_addr, addr, p_data, length, length * 5);
-  }
+  ret = i2cWriteBytes(i2c_ch, i2c_addr, addr, p_data, length, 5 + length/8);
 
   return ret;
 }
@@ -207,6 +509,12 @@ void cliCmd(cli_args_t *args)
     
     cliPrintf("is init  : %d\n", is_init);
     cliPrintf("WHO_AM_I : 0x%02X\n", data);
+    cliPrintf("odr      : %d Hz\n", HW_IMU_ODR_HZ);
+    cliPrintf("fifo rd  : %d\n", fifo_read_cnt);
+    cliPrintf("fifo smp : %d (%d per read)\n", fifo_sample_cnt, fifo_read_cnt > 0 ? fifo_sample_cnt/fifo_read_cnt : 0);
+    cliPrintf("fifo max : %d bytes\n", fifo_level_max);
+    cliPrintf("fifo err : %d\n", fifo_err_cnt);
+    cliPrintf("fifo sync: %d\n", fifo_resync_cnt);
     ret = true;
   }
 
@@ -1,38 +1,63 @@
 #include "madgwick.h"
-#include <math.h>
 
-#define sampleFreqDef   512.0f          // sample frequency in Hz
-#define betaDef         0.1f            // 2 * proportional gain
 
+//-- Cortex-M3 에는 FPU 가 없으므로 필터를 정수로 계산한다.
+//
+//   쿼터니언, 정규화된 벡터 : Q30
+//   자이로 입력            : rad/s Q16
+//   가속도 입력            : 크기는 상관없음 (정규화해서 사용)
+//   각도 출력              : degree Q16
+//
+#define BETA_DEF        107374182       // 0.1 (Q30), 2 * proportional gain
+#define DT_MAX_US       50000           // dt_k 가 int32 를 넘지 않는 범위
+#define DT_K            34360           // dt[us] -> dt/2 (Q36), 2^36 / 2e6
 
-static float invSqrt(float x);
-static void computeAngles();
+#define DEG_90          (90  << MADGWICK_DEG_Q)
+#define DEG_180         (180 << MADGWICK_DEG_Q)
 
-static float beta;				// algorithm gain
-static float roll;
-static float pitch;
-static float yaw;
-static char anglesComputed;
 
-static float invSampleFreq;
+static uint32_t invSqrt(uint64_t x, int32_t *p_shift);
+static bool     normalize(int32_t *p_v, uint32_t length);
+static int32_t  atan2Deg(int32_t y, int32_t x);
+static void     computeAngles(void);
+
+static int32_t beta;
+static int32_t roll;
+static int32_t pitch;
+static int32_t yaw;
+static bool    is_angles_computed;
+
+static int32_t q0;
+static int32_t q1;
+static int32_t q2;
+static int32_t q3;    // quaternion of sensor frame relative to auxiliary frame
+
+// 1/sqrt(x) 초기값, x = (i+0.5)/16, i = 4~15
+static const uint32_t inv_sqrt_tbl[12] =
+{
+  2024667000, 1831380208, 1684624773, 1568300315,
+  1473161629, 1393471397, 1325455684, 1266516759,
+  1214800200, 1168942037, 1127913670, 1090922784,
+};
+
+// atan(t) 다항식 계수, degree Q24
+static const int32_t atan_coef_tbl[5] =
+{
+  961134859, -317504909, 173162999, -81835260, 20028025,
+};
 
-static float q0;
-static float q1;
-static float q2;
-static float q3;	// quaternion of sensor frame relative to auxiliary frame
 
 
 
 bool madgwickInit(void)
 {
-	beta = betaDef;
+  beta = BETA_DEF;
 
-	q0 = 1.0f;
-	q1 = 0.0f;
-	q2 = 0.0f;
-	q3 = 0.0f;
-	invSampleFreq = 1.0f / sampleFreqDef;
-	anglesComputed = 0;
+  q0 = 1 << MADGWICK_Q;
+  q1 = 0;
+  q2 = 0;
+  q3 = 0;
+  is_angles_computed = false;
 
   roll  = 0;
   pitch = 0;
@@ -41,103 +66,96 @@ bool madgwickInit(void)
   return true;
 }
 
-void madgwickSetFreq(float freq_hz)
+void madgwickSetBeta(int32_t beta_q30)
 {
-  invSampleFreq = 1.0f / freq_hz; 
+  beta = beta_q30;
 }
 
-void madgwickSetFreqTime(float freq_time)
+void madgwickUpdate(const int32_t gyro_q16[3], const int32_t acc[3], uint32_t dt_us)
 {
-  invSampleFreq = freq_time; 
-}
+  int32_t dt_k;
+  int32_t hx, hy, hz;
+  int32_t d0, d1, d2, d3;
+  int32_t a[3];
+  int32_t s[4];
+  int32_t q[4];
 
-void madgwickUpdate(float gx, float gy, float gz, float ax, float ay, float az)
-{
-  float recipNorm;
-	float s0, s1, s2, s3;
-	float qDot1, qDot2, qDot3, qDot4;
-	float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2 ,_8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
-
-	// Convert gyroscope degrees/sec to radians/sec
-	gx *= 0.0174533f;
-	gy *= 0.0174533f;
-	gz *= 0.0174533f;
-
-	// Rate of change of quaternion from gyroscope
-  qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
-  qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
-  qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
-  qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
-
-  // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
-	if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) 
+
+  if (dt_us > DT_MAX_US)
+    dt_us = DT_MAX_US;
+  dt_k = dt_us * DT_K;
+
+  // 한 주기 동안의 회전 반각 (w * dt / 2), Q30
+  hx = (int32_t)(((int64_t)gyro_q16[0] * dt_k) >> 22);
+  hy = (int32_t)(((int64_t)gyro_q16[1] * dt_k) >> 22);
+  hz = (int32_t)(((int64_t)gyro_q16[2] * dt_k) >> 22);
+
+  // Rate of change of quaternion from gyroscope, dt 를 곱한 값
+  d0 = (int32_t)((-(int64_t)q1 * hx - (int64_t)q2 * hy - (int64_t)q3 * hz) >> 30);
+  d1 = (int32_t)(( (int64_t)q0 * hx + (int64_t)q2 * hz - (int64_t)q3 * hy) >> 30);
+  d2 = (int32_t)(( (int64_t)q0 * hy - (int64_t)q1 * hz + (int64_t)q3 * hx) >> 30);
+  d3 = (int32_t)(( (int64_t)q0 * hz + (int64_t)q1 * hy - (int64_t)q2 * hx) >> 30);
+
+  // Compute feedback only if accelerometer measurement valid
+  a[0] = acc[0];
+  a[1] = acc[1];
+  a[2] = acc[2];
+  if (normalize(a, 3))
+  {
+    int32_t k;
+    int32_t bdt;
+
+    // Gradient decent algorithm corrective step
+    //   float 식에서 |q| = 1 을 이용해 정리하고 1/4 로 나눈 것이다.
+    //   크기는 정규화에서 없어지므로 방향만 같으면 된다. (Q28)
+    k = (int32_t)(((int64_t)q1 * q1 + (int64_t)q2 * q2) >> 30);
+
+    s[0] = (int32_t)(((int64_t)q0 * k
+                   + (((int64_t)q2 * a[0] - (int64_t)q1 * a[1]) >> 1)) >> 32);
+    s[1] = (int32_t)(((int64_t)q1 * k + (int64_t)q1 * a[2]
+                   - (((int64_t)q3 * a[0] + (int64_t)q0 * a[1]) >> 1)) >> 32);
+    s[2] = (int32_t)(((int64_t)q2 * k + (int64_t)q2 * a[2]
+                   + (((int64_t)q0 * a[0] - (int64_t)q3 * a[1]) >> 1)) >> 32);
+    s[3] = (int32_t)(((int64_t)q3 * k
+                   - (((int64_t)q1 * a[0] + (int64_t)q2 * a[1]) >> 1)) >> 32);
+
+    if (normalize(s, 4))
+    {
+      // Apply feedback step, beta * dt (Q30)
+      bdt = (int32_t)(((int64_t)beta * dt_k) >> 35);
+
+      d0 -= (int32_t)(((int64_t)bdt * s[0]) >> 30);
+      d1 -= (int32_t)(((int64_t)bdt * s[1]) >> 30);
+      d2 -= (int32_t)(((int64_t)bdt * s[2]) >> 30);
+      d3 -= (int32_t)(((int64_t)bdt * s[3]) >> 30);
+    }
+  }
+
+  // Integrate rate of change of quaternion to yield quaternion
+  q[0] = q0 + d0;
+  q[1] = q1 + d1;
+  q[2] = q2 + d2;
+  q[3] = q3 + d3;
+
+  // Normalise quaternion
+  if (normalize(q, 4))
   {
-		// Normalise accelerometer measurement
-		recipNorm = invSqrt(ax * ax + ay * ay + az * az);
-		ax *= recipNorm;
-		ay *= recipNorm;
-		az *= recipNorm;
-
-		// Auxiliary variables to avoid repeated arithmetic
-		_2q0 = 2.0f * q0;
-		_2q1 = 2.0f * q1;
-		_2q2 = 2.0f * q2;
-		_2q3 = 2.0f * q3;
-		_4q0 = 4.0f * q0;
-		_4q1 = 4.0f * q1;
-		_4q2 = 4.0f * q2;
-		_8q1 = 8.0f * q1;
-		_8q2 = 8.0f * q2;
-		q0q0 = q0 * q0;
-		q1q1 = q1 * q1;
-		q2q2 = q2 * q2;
-		q3q3 = q3 * q3;
-
-		// Gradient decent algorithm corrective step
-		s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
-		s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
-		s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
-		s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
-		recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
-		s0 *= recipNorm;
-		s1 *= recipNorm;
-		s2 *= recipNorm;
-		s3 *= recipNorm;
-
-		// Apply feedback step
-		qDot1 -= beta * s0;
-		qDot2 -= beta * s1;
-		qDot3 -= beta * s2;
-		qDot4 -= beta * s3;
-	}
-
-	// Integrate rate of change of quaternion to yield quaternion
-	q0 += qDot1 * invSampleFreq;
-	q1 += qDot2 * invSampleFreq;
-	q2 += qDot3 * invSampleFreq;
-	q3 += qDot4 * invSampleFreq;
-
-	// Normalise quaternion
-	recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-	q0 *= recipNorm;
-	q1 *= recipNorm;
-	q2 *= recipNorm;
-	q3 *= recipNorm;
-	anglesComputed = 0;
+    q0 = q[0];
+    q1 = q[1];
+    q2 = q[2];
+    q3 = q[3];
+  }
+  is_angles_computed = false;
 }
 
 bool madgwickGetInfo(madgwick_info_t *p_info)
 {
-  if (!anglesComputed)
+  if (!is_angles_computed)
     computeAngles();
 
-  p_info->deg_roll  = roll * 57.29578f;
-  p_info->deg_pitch = pitch * 57.29578f;
-  p_info->deg_yaw   = yaw * 57.29578f + 180.0f;
-
-  p_info->rad_roll  = roll;
-  p_info->rad_pitch = pitch;
-  p_info->rad_yaw   = pitch;
+  p_info->deg_roll  = roll;
+  p_info->deg_pitch = pitch;
+  p_info->deg_yaw   = yaw;
 
   p_info->quat[0] = q0;
   p_info->quat[1] = q1;
@@ -147,25 +165,145 @@ bool madgwickGetInfo(madgwick_info_t *p_info)
   return true;
 }
 
-// Fast inverse square-root
-// See: http://en.wikipedia.org/wiki/Fast_inverse_square_root
-
-float invSqrt(float x) 
+// 1/sqrt(x) = ret(Q30) / 2^shift
+//   x 를 짝수 비트만큼 밀어서 [0.25, 1) 로 맞추고 테이블 초기값에서
+//   뉴턴 반복을 3번 한다.
+//
+uint32_t invSqrt(uint64_t x, int32_t *p_shift)
 {
-  float halfx = 0.5f * x;
-  float y     = x;
-  long  i     = *(long *)&y;
-  i           = 0x5f3759df - (i >> 1);
-  y           = *(float *)&i;
-  y           = y * (1.5f - (halfx * y * y));
-  y           = y * (1.5f - (halfx * y * y));
+  int32_t  msb;
+  int32_t  e;
+  uint32_t m;
+  uint32_t y;
+
+
+  if ((x >> 32) != 0)
+    msb = 63 - __CLZ((uint32_t)(x >> 32));
+  else
+    msb = 31 - __CLZ((uint32_t)x);
+
+  e = 61 - msb;
+  if (e & 1)
+    e -= 1;
+
+  if (e >= 0)
+    m = (uint32_t)((x << e) >> 32);
+  else
+    m = (uint32_t)((x >> -e) >> 32);
+
+  y = inv_sqrt_tbl[(m >> 26) - 4];
+  for (int i=0; i<3; i++)
+  {
+    uint32_t yy;
+    uint32_t myy;
+
+    yy  = (uint32_t)(((uint64_t)y * y) >> 31);                // Q29
+    myy = (uint32_t)(((uint64_t)m * yy) >> 29);               // Q30
+    y   = (uint32_t)(((uint64_t)y * ((3UL << 30) - myy)) >> 31);
+  }
+
+  *p_shift = 31 - e/2;
   return y;
 }
 
+// 벡터를 Q30 단위 벡터로 바꾼다. 크기가 0 이면 false
+//
+bool normalize(int32_t *p_v, uint32_t length)
+{
+  uint64_t sum = 0;
+  int32_t  y;
+  int32_t  shift;
+
+
+  for (int i=0; i<length; i++)
+  {
+    sum += (int64_t)p_v[i] * p_v[i];
+  }
+  if (sum == 0)
+  {
+    return false;
+  }
+
+  y = (int32_t)(invSqrt(sum, &shift) >> 1);
+  for (int i=0; i<length; i++)
+  {
+    p_v[i] = (int32_t)(((int64_t)p_v[i] * y) >> (shift - 1));
+  }
+  return true;
+}
+
+// atan2 (degree Q16)
+//   |t| <= 1 로 접어서 다항식으로 계산한다. 오차 0.001 도 이하
+//
+int32_t atan2Deg(int32_t y, int32_t x)
+{
+  uint32_t abs_x = x < 0 ? -(uint32_t)x : (uint32_t)x;
+  uint32_t abs_y = y < 0 ? -(uint32_t)y : (uint32_t)y;
+  uint32_t num;
+  uint32_t den;
+  uint32_t shift;
+  int32_t  t;
+  int32_t  t2;
+  int32_t  p;
+  int32_t  ret;
+  bool     is_swap;
+
+
+  is_swap = abs_y > abs_x;
+  num = is_swap ? abs_x : abs_y;
+  den = is_swap ? abs_y : abs_x;
+  if (den == 0)
+  {
+    return 0;
+  }
+
+  shift = __CLZ(den) - 1;
+  num <<= shift;
+  den <<= shift;
+  t = (int32_t)((num / (den >> 16)) << 14);                   // Q30
+  if (t > (1 << 30))
+    t = 1 << 30;
+
+  t2 = (int32_t)(((int64_t)t * t) >> 30);
+  p  = atan_coef_tbl[4];
+  for (int i=3; i>=0; i--)
+  {
+    p = atan_coef_tbl[i] + (int32_t)(((int64_t)p * t2) >> 30);
+  }
+  ret = (int32_t)(((int64_t)p * t) >> (30 + 24 - MADGWICK_DEG_Q));
+
+  if (is_swap)
+    ret = DEG_90 - ret;
+  if (x < 0)
+    ret = DEG_180 - ret;
+  if (y < 0)
+    ret = -ret;
+
+  return ret;
+}
+
 void computeAngles(void)
 {
-  roll           = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2);
-  pitch          = asinf(-2.0f * (q1 * q3 - q0 * q2));
-  yaw            = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3);
-  anglesComputed = 1;
-}
\ No newline at end of file
+  int32_t sin_p;
+  int32_t cos_p;
+  int32_t cos_p2;
+  int32_t shift;
+
+
+  roll  = atan2Deg((int32_t)(((int64_t)q0 * q1 + (int64_t)q2 * q3) >> 30),
+                   (1 << 29) - (int32_t)(((int64_t)q1 * q1 + (int64_t)q2 * q2) >> 30));
+  yaw   = atan2Deg((int32_t)(((int64_t)q1 * q2 + (int64_t)q0 * q3) >> 30),
+                   (1 << 29) - (int32_t)(((int64_t)q2 * q2 + (int64_t)q3 * q3) >> 30));
+
+  // asin(x) = atan2(x, sqrt(1 - x^2))
+  sin_p = (int32_t)(((int64_t)q0 * q2 - (int64_t)q1 * q3) >> 29);
+  sin_p = constrain(sin_p, -(1 << 30), (1 << 30));
+  cos_p2 = (1 << 30) - (int32_t)(((int64_t)sin_p * sin_p) >> 30);
+  if (cos_p2 > 0)
+    cos_p = (int32_t)(((uint64_t)cos_p2 * invSqrt((uint64_t)cos_p2 << 30, &shift)) >> shift);
+  else
+    cos_p = 0;
+  pitch = atan2Deg(sin_p, cos_p);
+
+  is_angles_computed = true;
+}
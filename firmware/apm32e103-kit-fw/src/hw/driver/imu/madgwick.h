@@ -9,29 +9,30 @@ extern "C" {
 #include "hw_def.h"
 
 
+#define MADGWICK_Q            30                // 쿼터니언, 단위 벡터
+#define MADGWICK_DEG_Q        16                // 각도(degree)
+
+#define IMU_GYRO_RAD_Q24      17872             // 2000dps / 32768 * pi / 180, rad/s per LSB
+
+
 typedef struct
 {
-  float quat[4];
+  int32_t quat[4];      // Q30
 
-  float deg_roll;
-  float deg_pitch;
-  float deg_yaw;
-
-  float rad_roll;
-  float rad_pitch;
-  float rad_yaw;
+  int32_t deg_roll;     // Q16 degree
+  int32_t deg_pitch;
+  int32_t deg_yaw;
 } madgwick_info_t;
 
 
 
 bool madgwickInit(void);
-void madgwickSetFreq(float freq_hz);
-void madgwickSetFreqTime(float freq_time);
-void madgwickUpdate(float gx, float gy, float gz, float ax, float ay, float az);
+void madgwickSetBeta(int32_t beta_q30);
+void madgwickUpdate(const int32_t gyro_q16[3], const int32_t acc[3], uint32_t dt_us);
 bool madgwickGetInfo(madgwick_info_t *p_info);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,252 @@
+#include "init.h"
+
+
+#ifdef _USE_HW_INIT
+#include "cli.h"
+#ifdef _USE_HW_BOOT_TIME
+#include "boot_time.h"
+#endif
+
+
+typedef struct
+{
+  InitState_t state;
+  uint32_t    exe_time;   // init() 실행 시간 us
+  uint32_t    done_time;  // 완료 시점 ms
+} init_node_t;
+
+
+#if CLI_USE(HW_INIT)
+static void cliCmd(cli_args_t *args);
+#endif
+static void initRun(uint32_t id);
+static void initDone(uint32_t id, bool result);
+static bool initIsReady(uint32_t id);
+static bool initIsFailed(uint32_t id);
+static void initSkip(uint32_t id);
+
+static bool is_init = false;
+static const init_tbl_t *p_init_tbl = NULL;
+static uint32_t init_count = 0;
+static uint32_t done_bits = 0;     // 성공한 항목
+static uint32_t fail_bits = 0;     // 실패하거나 건너뛴 항목
+static init_node_t init_node[INIT_MAX];
+
+static const char *state_str[] =
+  {
+    "WAIT",
+    "BUSY",
+    "OK  ",
+    "FAIL",
+    "SKIP",
+  };
+
+
+
+
+
+bool initBegin(const init_tbl_t *p_tbl, uint32_t count)
+{
+  bool ret = true;
+
+
+  if (count > INIT_MAX)
+    return false;
+
+  p_init_tbl = p_tbl;
+  init_count = count;
+  done_bits  = 0;
+  fail_bits  = 0;
+
+  for (int i=0; i<init_count; i++)
+  {
+    init_node[i].state     = INIT_STATE_WAIT;
+    init_node[i].exe_time  = 0;
+    init_node[i].done_time = 0;
+  }
+  is_init = true;
+
+
+  for (int i=0; i<init_count; i++)
+  {
+    if (p_init_tbl[i].mode != INIT_MODE_NOW)
+      continue;
+
+    if (initIsFailed(i) == true)
+    {
+      logPrintf("[E_] initBegin() %s : depend failed\n", p_init_tbl[i].name);
+      initSkip(i);
+      ret = false;
+      continue;
+    }
+
+    if (initIsReady(i) != true)
+    {
+      logPrintf("[E_] initBegin() %s : depend not ready\n", p_init_tbl[i].name);
+      ret = false;
+      continue;
+    }
+
+    initRun(i);
+    while(init_node[i].state == INIT_STATE_BUSY)
+    {
+      if (p_init_tbl[i].update() == true)
+      {
+        initDone(i, true);
+      }
+    }
+  }
+
+#if CLI_USE(HW_INIT)
+  cliAdd("init", cliCmd);
+#endif
+  return ret;
+}
+
+bool initUpdate(void)
+{
+  if (is_init != true)
+    return false;
+
+  if (initIsAllDone())
+    return true;
+
+
+  for (int i=0; i<init_count; i++)
+  {
+    if (init_node[i].state == INIT_STATE_BUSY && p_init_tbl[i].update() == true)
+    {
+      initDone(i, true);
+    }
+  }
+
+  // 의존 항목이 실패하면 실행하지 않고 건너뛴다.
+  //
+  for (int i=0; i<init_count; i++)
+  {
+    if (init_node[i].state == INIT_STATE_WAIT && initIsFailed(i))
+    {
+      initSkip(i);
+    }
+  }
+
+  // 메인 루프가 오래 멈추지 않도록 한번에 하나의 init()만 실행한다.
+  //
+  for (int i=0; i<init_count; i++)
+  {
+    if (init_node[i].state == INIT_STATE_WAIT && initIsReady(i))
+    {
+      initRun(i);
+      break;
+    }
+  }
+
+  return initIsAllDone();
+}
+
+bool initIsDone(uint32_t id)
+{
+  if (id >= init_count)
+    return false;
+
+  return (done_bits & INIT_BIT(id)) ? true:false;
+}
+
+// 실패하거나 건너뛴 항목도 더 할 일이 없으므로 끝난 것으로 본다.
+//
+bool initIsAllDone(void)
+{
+  return (done_bits | fail_bits) == (INIT_BIT(init_count) - 1);
+}
+
+InitState_t initGetState(uint32_t id)
+{
+  if (id >= init_count)
+    return INIT_STATE_FAIL;
+
+  return init_node[id].state;
+}
+
+bool initIsReady(uint32_t id)
+{
+  return (p_init_tbl[id].depend & ~done_bits) == 0;
+}
+
+bool initIsFailed(uint32_t id)
+{
+  return (p_init_tbl[id].depend & fail_bits) != 0;
+}
+
+void initSkip(uint32_t id)
+{
+  init_node[id].state     = INIT_STATE_SKIP;
+  init_node[id].done_time = millis();
+  fail_bits |= INIT_BIT(id);
+}
+
+void initRun(uint32_t id)
+{
+  const init_tbl_t *p_tbl = &p_init_tbl[id];
+  uint32_t pre_time;
+  bool ret;
+
+
+  pre_time = micros();
+  ret = p_tbl->init();
+  init_node[id].exe_time = micros() - pre_time;
+
+  if (ret == true && p_tbl->update != NULL)
+  {
+    init_node[id].state = INIT_STATE_BUSY;
+  }
+  else
+  {
+    initDone(id, ret);
+  }
+}
+
+void initDone(uint32_t id, bool result)
+{
+  init_node[id].state     = result ? INIT_STATE_OK:INIT_STATE_FAIL;
+  init_node[id].done_time = millis();
+  if (result == true)
+    done_bits |= INIT_BIT(id);
+  else
+    fail_bits |= INIT_BIT(id);
+
+#ifdef _USE_HW_BOOT_TIME
+  bootTimeMark(p_init_tbl[id].name);
+#endif
+}
+
+
+#if CLI_USE(HW_INIT)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("idx name       mode   state  exe(us)   done(ms)\n");
+    for (int i=0; i<init_count; i++)
+    {
+      cliPrintf("%3d %-10s %s  %s  %8d  %8d\n",
+                i,
+                p_init_tbl[i].name,
+                p_init_tbl[i].mode == INIT_MODE_NOW ? "NOW  ":"LATER",
+                state_str[init_node[i].state],
+                init_node[i].exe_time,
+                init_node[i].done_time);
+    }
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("init info\n");
+  }
+}
+#endif
+
+#endif
@@ -1,4 +1,6 @@
 #include "lcd.h"
+#include "perf.h"
+#include "mem.h"
 
 
 
@@ -31,6 +33,16 @@
 
 
 #define LCD_FONT_RESIZE_WIDTH  64
+#define LCD_GLYPH_CACHE_MAX    HW_LCD_GLYPH_CACHE_MAX
+#define LCD_GLYPH_HEIGHT       16
+
+#ifndef HW_LCD_MONO
+#define HW_LCD_MONO            0
+#endif
+
+#if HW_LCD_MONO == 1 && !defined(_USE_HW_SSD1306)
+#error "HW_LCD_MONO needs a 1bpp panel driver"
+#endif
 
 #define MAKECOL(r, g, b) ( ((r)<<11) | ((g)<<5) | (b))
 
@@ -47,6 +59,17 @@ typedef struct
   int16_t y;
 } lcd_pixel_t;
 
+//-- 한글 폰트를 조합한 결과를 글자 코드로 보관한다.
+//   각 줄은 왼쪽 픽셀이 MSB 인 16bit 이다.
+//
+typedef struct
+{
+  uint32_t code;
+  uint32_t use;               // 마지막 사용 순번, 0 이면 빈 항목
+  uint8_t  width;
+  uint16_t rows[LCD_GLYPH_HEIGHT];
+} lcd_glyph_t;
+
 
 static lcd_driver_t lcd;
 
@@ -69,21 +92,33 @@ static volatile uint32_t draw_frame_time = 0;
 static LcdResizeMode lcd_resize_mode = LCD_RESIZE_NEAREST;
 
 
+//-- HW_LCD_MONO 는 16bit 프레임 버퍼 없이 패널 드라이버의
+//   1bpp 페이지 버퍼에 바로 그린다.
+//
 static uint16_t *p_draw_frame_buf = NULL;
+#if HW_LCD_MONO == 0
 static uint16_t __attribute__((aligned(64))) frame_buffer[1][HW_LCD_WIDTH * HW_LCD_HEIGHT];
+#endif
 
 static uint16_t __attribute__((aligned(64))) font_src_buffer[16 * 16];
 static uint16_t __attribute__((aligned(64))) font_dst_buffer[LCD_FONT_RESIZE_WIDTH * LCD_FONT_RESIZE_WIDTH];
 
 static lcd_font_t *font_tbl[LCD_FONT_MAX] = { &font_07x10, &font_11x18, &font_16x26, &font_hangul};
 
+static lcd_glyph_t glyph_cache[LCD_GLYPH_CACHE_MAX];
+static uint32_t    glyph_use  = 0;
+static uint32_t    glyph_hit  = 0;
+static uint32_t    glyph_miss = 0;
+
 static volatile bool requested_from_thread = false;
 
 
 
 
-static void disHanFont(int x, int y, han_font_t *FontPtr, uint16_t textcolor);
-static void disEngFont(int x, int y, char ch, lcd_font_t *font, uint16_t textcolor);
+static lcd_glyph_t *lcdGlyphLoad(char *p_str, uint16_t *p_size);
+static void lcdGlyphClear(void);
+static void lcdDrawGlyph(int16_t x, int16_t y, const uint16_t *p_rows, uint8_t w, uint8_t h, uint16_t color);
+static void lcdDrawSpan(int16_t x, int16_t y, int16_t w, uint16_t color);
 static void lcdDrawLineBuffer(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, lcd_pixel_t *line);
 
 
@@ -117,6 +152,7 @@ bool lcdInit(void)
   lcd.setCallBack(TransferDoneISR);
 
 
+#if HW_LCD_MONO == 0
   for (int i=0; i<LCD_WIDTH*LCD_HEIGHT; i++)
   {
     frame_buffer[0][i] = black;
@@ -125,6 +161,14 @@ bool lcdInit(void)
 
   p_draw_frame_buf = frame_buffer[frame_index];
 
+  MEM_BUF_ADD("lcd frame", frame_buffer);
+#endif
+  MEM_BUF_ADD("lcd font src", font_src_buffer);
+  MEM_BUF_ADD("lcd font dst", font_dst_buffer);
+  MEM_BUF_ADD("lcd glyph", glyph_cache);
+
+  lcdGlyphClear();
+
   if (is_init)
   {
     lcdDrawFillRect(0, 0, LCD_WIDTH, LCD_HEIGHT, black);
@@ -191,15 +235,23 @@ void lcdSetBackLight(uint8_t value)
 
 LCD_OPT_DEF uint32_t lcdReadPixel(uint16_t x_pos, uint16_t y_pos)
 {
+#if HW_LCD_MONO == 1
+  return ssd1306ReadPixel(x_pos, y_pos);
+#else
   return p_draw_frame_buf[y_pos * LCD_WIDTH + x_pos];
+#endif
 }
 
 LCD_OPT_DEF void lcdDrawPixel(int16_t x_pos, int16_t y_pos, uint32_t rgb_code)
 {
+#if HW_LCD_MONO == 1
+  ssd1306DrawPixel(x_pos, y_pos, rgb_code);
+#else
   if (x_pos < 0 || x_pos >= LCD_WIDTH) return;
   if (y_pos < 0 || y_pos >= LCD_HEIGHT) return;
 
   p_draw_frame_buf[y_pos * LCD_WIDTH + x_pos] = rgb_code;
+#endif
 }
 
 LCD_OPT_DEF void lcdClear(uint32_t rgb_code)
@@ -211,12 +263,16 @@ LCD_OPT_DEF void lcdClear(uint32_t rgb_code)
 
 LCD_OPT_DEF void lcdClearBuffer(uint32_t rgb_code)
 {
+#if HW_LCD_MONO == 1
+  ssd1306Fill(rgb_code);
+#else
   uint16_t *p_buf = lcdGetFrameBuffer();
 
   for (int i=0; i<LCD_WIDTH * LCD_HEIGHT; i++)
   {
     p_buf[i] = rgb_code;
   }
+#endif
 }
 
 LCD_OPT_DEF void lcdDrawFillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color)
@@ -431,6 +487,7 @@ bool lcdDrawAvailable(void)
 
 bool lcdRequestDraw(void)
 {
+  PERF_SCOPE("lcdRequestDraw");
   if (is_init != true)
   {
     return false;
@@ -443,7 +500,11 @@ bool lcdRequestDraw(void)
   lcd.setWindow(0, 0, LCD_WIDTH-1, LCD_HEIGHT-1);
 
   lcd_request_draw = true;
+#if HW_LCD_MONO == 1
+  lcd.sendBuffer(NULL, 0, 0);
+#else
   lcd.sendBuffer((uint8_t *)frame_buffer[frame_index], LCD_WIDTH * LCD_HEIGHT, 0);
+#endif
 
   return true;
 }
@@ -487,7 +548,11 @@ uint16_t *lcdGetFrameBuffer(void)
 
 uint16_t *lcdGetCurrentFrameBuffer(void)
 {
+#if HW_LCD_MONO == 1
+  return NULL;
+#else
   return (uint16_t *)frame_buffer[frame_index];
+#endif
 }
 
 void lcdDisplayOff(void)
@@ -644,10 +709,14 @@ void lcdDrawHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 
 void lcdDrawFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
+#if HW_LCD_MONO == 1
+  ssd1306FillRect(x, y, w, h, color);
+#else
   for (int16_t i=x; i<x+w; i++)
   {
     lcdDrawVLine(i, y, h, color);
   }
+#endif
 }
 
 void lcdDrawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
@@ -669,9 +738,10 @@ void lcdPrintf(int x, int y, uint16_t color,  const char *fmt, ...)
   va_start (arg, fmt);
   int32_t len;
   char print_buffer[256];
-  int Size_Char;
+  uint16_t Size_Char;
   int i, x_Pre = x;
-  han_font_t FontBuf;
+  lcd_glyph_t *p_glyph;
+  lcd_font_t  *p_font = font_tbl[lcd_font];
   uint8_t font_width;
   uint8_t font_height;
 
@@ -679,15 +749,15 @@ void lcdPrintf(int x, int y, uint16_t color,  const char *fmt, ...)
   len = vsnprintf(print_buffer, 255, fmt, arg);
   va_end (arg);
 
-  if (font_tbl[lcd_font]->data != NULL)
+  if (p_font->data != NULL)
   {
-    for( i=0; i<len; i+=Size_Char )
+    font_width  = p_font->width;
+    font_height = p_font->height;
+
+    for( i=0; i<len; i++ )
     {
-      disEngFont(x, y, print_buffer[i], font_tbl[lcd_font], color);
+      lcdDrawGlyph(x, y, &p_font->data[(print_buffer[i] - 32) * font_height], font_width, font_height, color);
 
-      Size_Char = 1;
-      font_width = font_tbl[lcd_font]->width;
-      font_height = font_tbl[lcd_font]->height;
       x += font_width;
 
       if ((x+font_width) > HW_LCD_WIDTH)
@@ -701,43 +771,33 @@ void lcdPrintf(int x, int y, uint16_t color,  const char *fmt, ...)
   {
     for( i=0; i<len; i+=Size_Char )
     {
-      hanFontLoad( &print_buffer[i], &FontBuf );
+      p_glyph = lcdGlyphLoad(&print_buffer[i], &Size_Char);
+      if (p_glyph == NULL) break;
 
-      disHanFont( x, y, &FontBuf, color);
+      lcdDrawGlyph(x, y, p_glyph->rows, p_glyph->width, LCD_GLYPH_HEIGHT, color);
 
-      Size_Char = FontBuf.Size_Char;
-      if (Size_Char >= 2)
-      {
-        font_width = 16;
-        x += 2*8;
-      }
-      else
-      {
-        font_width = 8;
-        x += 1*8;
-      }
+      font_width = p_glyph->width;
+      x += font_width;
 
       if ((x+font_width) > HW_LCD_WIDTH)
       {
         x  = x_Pre;
         y += 16;
       }
-
-      if( FontBuf.Code_Type == PHAN_END_CODE ) break;
     }
   }
 }
 
-
 uint32_t lcdGetStrWidth(const char *fmt, ...)
 {
   va_list arg;
   va_start (arg, fmt);
   int32_t len;
   char print_buffer[256];
-  int Size_Char;
+  uint16_t Size_Char;
+  uint16_t Code_Type;
+  uint32_t code;
   int i;
-  han_font_t FontBuf;
   uint32_t str_len;
 
 
@@ -746,67 +806,138 @@ uint32_t lcdGetStrWidth(const char *fmt, ...)
 
   str_len = 0;
 
+  // 폭만 필요하므로 폰트는 만들지 않는다.
   for( i=0; i<len; i+=Size_Char )
   {
-    hanFontLoad( &print_buffer[i], &FontBuf );
-
-    Size_Char = FontBuf.Size_Char;
+    Code_Type = hanFontGetCode(&print_buffer[i], &code, &Size_Char);
 
     str_len += (Size_Char * 8);
 
-    if( FontBuf.Code_Type == PHAN_END_CODE ) break;
+    if( Code_Type == PHAN_END_CODE ) break;
   }
 
   return str_len;
 }
 
-void disHanFont(int x, int y, han_font_t *FontPtr, uint16_t textcolor)
+void lcdGlyphClear(void)
 {
-  uint16_t    i, j, Loop;
-  uint16_t  FontSize = FontPtr->Size_Char;
-  uint16_t index_x;
+  for (int i=0; i<LCD_GLYPH_CACHE_MAX; i++)
+  {
+    glyph_cache[i].use = 0;
+  }
+  glyph_use = 0;
+}
 
-  if (FontSize > 2)
+lcd_glyph_t *lcdGlyphLoad(char *p_str, uint16_t *p_size)
+{
+  lcd_glyph_t *p_glyph;
+  lcd_glyph_t *p_old;
+  han_font_t   font;
+  uint32_t     code;
+
+
+  if (hanFontGetCode(p_str, &code, p_size) == PHAN_END_CODE)
   {
-    FontSize = 2;
+    return NULL;
   }
 
-  for ( i = 0 ; i < 16 ; i++ )        // 16 Lines per Font/Char
+  // 순번이 한바퀴 돌면 처음부터 다시 채운다.
+  if (++glyph_use == 0)
   {
-    index_x = 0;
-    for ( j = 0 ; j < FontSize ; j++ )      // 16 x 16 (2 Bytes)
-    {
-      uint8_t font_data;
+    lcdGlyphClear();
+    glyph_use = 1;
+  }
 
-      font_data = FontPtr->FontBuffer[i*FontSize +j];
+  p_old = &glyph_cache[0];
+  for (int i=0; i<LCD_GLYPH_CACHE_MAX; i++)
+  {
+    p_glyph = &glyph_cache[i];
 
-      for( Loop=0; Loop<8; Loop++ )
-      {
-        if( (font_data<<Loop) & (0x80))
-        {
-          lcdDrawPixel(x + index_x, y + i, textcolor);
-        }
-        index_x++;
-      }
+    if (p_glyph->use != 0 && p_glyph->code == code)
+    {
+      p_glyph->use = glyph_use;
+      glyph_hit++;
+      return p_glyph;
+    }
+    if (p_glyph->use < p_old->use)
+    {
+      p_old = p_glyph;
     }
   }
+
+  // 가장 오래 쓰지 않은 항목에 새로 조합한다.
+  //
+  glyph_miss++;
+  hanFontLoad(p_str, &font);
+
+  p_glyph = p_old;
+  p_glyph->code  = code;
+  p_glyph->use   = glyph_use;
+  p_glyph->width = font.Size_Char >= 2 ? 16 : 8;
+  for (int i=0; i<LCD_GLYPH_HEIGHT; i++)
+  {
+    if (p_glyph->width == 16)
+      p_glyph->rows[i] = (font.FontBuffer[i*2] << 8) | font.FontBuffer[i*2 + 1];
+    else
+      p_glyph->rows[i] = (font.FontBuffer[i] << 8);
+  }
+
+  return p_glyph;
 }
 
-void disEngFont(int x, int y, char ch, lcd_font_t *font, uint16_t textcolor)
+LCD_OPT_DEF void lcdDrawSpan(int16_t x, int16_t y, int16_t w, uint16_t color)
 {
-  uint32_t i, b, j;
+#if HW_LCD_MONO == 1
+  ssd1306DrawSpan(x, y, w, color);
+#else
+  uint16_t *p_buf = &p_draw_frame_buf[y * LCD_WIDTH + x];
 
+  for (int i=0; i<w; i++)
+  {
+    p_buf[i] = color;
+  }
+#endif
+}
 
-  // We gaan door het font
-  for (i = 0; i < font->height; i++)
+//-- 글자 영역을 한번만 잘라낸 후 줄마다 연속된 픽셀 구간을 찾아 그린다.
+//
+LCD_OPT_DEF void lcdDrawGlyph(int16_t x, int16_t y, const uint16_t *p_rows, uint8_t w, uint8_t h, uint16_t color)
+{
+  int16_t  y_begin = 0;
+  int16_t  y_end   = h;
+  uint32_t mask;
+  uint32_t bits;
+  uint32_t col;
+  uint32_t run;
+
+
+  if (x >= LCD_WIDTH || y >= LCD_HEIGHT || x + w <= 0 || y + h <= 0)
   {
-    b = font->data[(ch - 32) * font->height + i];
-    for (j = 0; j < font->width; j++)
+    return;
+  }
+  if (y < 0)
+    y_begin = -y;
+  if (y + h > LCD_HEIGHT)
+    y_end = LCD_HEIGHT - y;
+
+  // 왼쪽 픽셀이 bit31 이 되도록 맞춘 열 마스크
+  mask = 0xFFFFFFFF << (32 - w);
+  if (x < 0)
+    mask &= 0xFFFFFFFF >> (-x);
+  if (x + w > LCD_WIDTH)
+    mask &= ~(0xFFFFFFFF >> (LCD_WIDTH - x));
+
+  for (int i=y_begin; i<y_end; i++)
+  {
+    bits = ((uint32_t)p_rows[i] << 16) & mask;
+
+    while (bits != 0)
     {
-      if ((b << j) & 0x8000)
-      {
-        lcdDrawPixel(x + j, (y + i), textcolor);
-      }
+      col  = __CLZ(bits);
+      run  = __CLZ(~(bits << col));
+      lcdDrawSpan(x + col, y + i, run, color);
+
+      bits &= 0xFFFFFFFF >> (col + run);
     }
   }
 }
@@ -894,15 +1025,26 @@ LCD_OPT_DEF uint16_t lcdGetColorMix(uint16_t c1_, uint16_t c2_, uint8_t mix)
 
 LCD_OPT_DEF void lcdDrawPixelMix(int16_t x_pos, int16_t y_pos, uint32_t rgb_code, uint8_t mix)
 {
+#if HW_LCD_MONO == 0
   uint16_t color1, color2;
+#endif
 
   if (x_pos < 0 || x_pos >= LCD_WIDTH) return;
   if (y_pos < 0 || y_pos >= LCD_HEIGHT) return;
 
+#if HW_LCD_MONO == 1
+  // 1bpp 는 섞을 수 없으므로 절반 이상이면 찍는다.
+  //
+  if (mix >= 128)
+  {
+    ssd1306DrawPixel(x_pos, y_pos, rgb_code);
+  }
+#else
   color1 = p_draw_frame_buf[y_pos * LCD_WIDTH + x_pos];
   color2 = rgb_code;
 
   p_draw_frame_buf[y_pos * LCD_WIDTH + x_pos] = lcdGetColorMix(color1, color2, 255-mix);
+#endif
 }
 
 void lcdPrintfResize(int x, int y, uint16_t color,  float ratio_h, const char *fmt, ...)
@@ -921,7 +1063,7 @@ void lcdPrintfResize(int x, int y, uint16_t color,  float ratio_h, const char *f
   uint16_t pixel;
   int16_t x_pos;
   int16_t y_pos;
-  float ratio;
+  int32_t ratio;              // Q16
 
   r_src.x = 0;
   r_src.y = 0;
@@ -938,7 +1080,8 @@ void lcdPrintfResize(int x, int y, uint16_t color,  float ratio_h, const char *f
   {
     ratio_h = LCD_FONT_RESIZE_WIDTH;
   }
-  ratio = ratio_h / 16;
+  // 글자마다 float 연산을 하지 않도록 비율은 한번만 Q16 으로 바꾼다.
+  ratio = (int32_t)(ratio_h * 65536) / 16;
 
   x = 0;
   y = 0;
@@ -949,8 +1092,8 @@ void lcdPrintfResize(int x, int y, uint16_t color,  float ratio_h, const char *f
 
     disHanFontBuffer(x, y, &FontBuf, 0xFF);
 
-    x_pos = x_Pre + x * ratio;
-    y_pos = y_Pre + y * ratio;
+    x_pos = x_Pre + ((x * ratio) >> 16);
+    y_pos = y_Pre + ((y * ratio) >> 16);
 
     Size_Char = FontBuf.Size_Char;
     if (Size_Char >= 2)
@@ -967,19 +1110,19 @@ void lcdPrintfResize(int x, int y, uint16_t color,  float ratio_h, const char *f
     r_src.w = font_width;
 
     //if ((x+font_width) > HW_LCD_WIDTH)
-    if ((x_pos + font_width*ratio) >= HW_LCD_WIDTH)
+    if ((x_pos + ((font_width*ratio) >> 16)) >= HW_LCD_WIDTH)
     {
       x  = x_Pre;
       y += 16;
 
-      x_pos = x_Pre + x * ratio;
-      y_pos = y_Pre + y * ratio;
+      x_pos = x_Pre + ((x * ratio) >> 16);
+      y_pos = y_Pre + ((y * ratio) >> 16);
     }
 
     r_dst.x = 0;
     r_dst.y = 0;
-    r_dst.w = r_src.w * ratio;
-    r_dst.h = r_src.h * ratio;
+    r_dst.w = (r_src.w * ratio) >> 16;
+    r_dst.h = (r_src.h * ratio) >> 16;
     r_dst.stride = LCD_FONT_RESIZE_WIDTH;
     r_dst.p_data = font_dst_buffer;
 
@@ -1080,6 +1223,29 @@ void cliLcd(cli_args_t *args)
 
     ret = true;
   }
+#if HW_LCD_MONO == 1
+  if (args->argc == 1 && args->isStr(0, "info") == true)
+  {
+    cliPrintf("fps       : %d\n", lcdGetFps());
+    cliPrintf("tx bytes  : %d\n", ssd1306GetTxBytes());
+    ret = true;
+  }
+#endif
+  if (args->argc == 1 && args->isStr(0, "glyph") == true)
+  {
+    uint32_t used = 0;
+
+    for (int i=0; i<LCD_GLYPH_CACHE_MAX; i++)
+    {
+      if (glyph_cache[i].use != 0)
+        used++;
+    }
+    cliPrintf("cache     : %d/%d\n", used, LCD_GLYPH_CACHE_MAX);
+    cliPrintf("hit       : %d\n", glyph_hit);
+    cliPrintf("miss      : %d\n", glyph_miss);
+    ret = true;
+  }
+
   if (args->argc == 2 && args->isStr(0, "bl") == true)
   {
     uint8_t bl_value;
@@ -1095,6 +1261,10 @@ void cliLcd(cli_args_t *args)
   {
     cliPrintf("lcd test\n");
     cliPrintf("lcd bl 0~100\n");
+    cliPrintf("lcd glyph\n");
+#if HW_LCD_MONO == 1
+    cliPrintf("lcd info\n");
+#endif
   }
 }
 #endif
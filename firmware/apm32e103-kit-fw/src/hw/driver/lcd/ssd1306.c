@@ -15,6 +15,8 @@
 
 #define SSD1306_WIDTH       HW_LCD_WIDTH
 #define SSD1306_HEIGHT      HW_LCD_HEIGHT
+#define SSD1306_PAGE_MAX    (SSD1306_HEIGHT / 8)
+#define SSD1306_CLEAN       0xFF
 
 
 static uint8_t i2c_ch  = _DEF_I2C2;
@@ -28,12 +30,31 @@ static uint16_t ssd1306GetWidth(void);
 static uint16_t ssd1306GetHeight(void);
 static bool ssd1306SendBuffer(uint8_t *p_data, uint32_t length, uint32_t timeout_ms);
 static bool ssd1306SetCallBack(void (*p_func)(void));
-static void ssd1306Fill(uint16_t color);
 static bool ssd1306UpdateDraw(void);
-static void ssd1306DrawPixel(uint8_t x, uint8_t y, uint16_t color);
+static void ssd1306MarkDirty(uint8_t page, uint8_t x0, uint8_t x1);
+static void ssd1306Invalidate(void);
+static void ssd1306SetXfer(i2c_xfer_t *p_xfer, uint8_t ctrl, uint8_t *p_data, uint16_t length);
+static void ssd1306TxDone(i2c_xfer_t *p_xfer, bool ret);
 
 
-static uint8_t ssd1306_buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
+//-- ssd1306_sent 는 패널에 전송된 내용으로, 페이지별 변경 구간 중
+//   실제로 바뀐 바이트만 전송하는데 쓴다.
+//
+static uint8_t  ssd1306_buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
+static uint8_t  ssd1306_sent[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
+static uint8_t  dirty_x0[SSD1306_PAGE_MAX];
+static uint8_t  dirty_x1[SSD1306_PAGE_MAX];
+static uint32_t tx_bytes = 0;
+
+//-- 한 프레임은 페이지마다 주소 명령과 데이터 두개의 전송으로 나누어
+//   I2C 큐에 낮은 우선 순위로 넣는다. 데이터는 ssd1306_sent 에서
+//   보내므로 전송 중에 다음 프레임을 그려도 된다.
+//
+static uint8_t    page_cmd[SSD1306_PAGE_MAX][3];
+static i2c_xfer_t tx_xfer[SSD1306_PAGE_MAX * 2];
+static i2c_xfer_t *p_tx_last = NULL;
+static volatile bool is_tx_busy = false;
+static volatile bool is_tx_err  = false;
 
 
 
@@ -78,6 +99,7 @@ bool ssd1306Reset(void)
   {
     return false;
   }
+  i2cSetPriority(i2c_ch, i2c_dev, I2C_PRIO_NORMAL);
 
   /* Init LCD */
   ssd1306WriteCmd(0xAE); //display off
@@ -116,8 +138,14 @@ bool ssd1306Reset(void)
   ssd1306WriteCmd(0x14); //
   ssd1306WriteCmd(0xAF); //--turn on SSD1306 panel
 
+  // 패널 내용을 알 수 없으므로 전체를 다시 보내도록 한다.
   ssd1306Fill(black);
+  ssd1306Invalidate();
   ssd1306UpdateDraw();
+  while(is_tx_busy == true)
+  {
+    i2cUpdate();
+  }
 
   return true;
 }
@@ -141,19 +169,27 @@ bool ssd1306SendBuffer(uint8_t *p_data, uint32_t length, uint32_t timeout_ms)
   uint16_t *p_buf = (uint16_t *)p_data;
 
 
-  for (int y=0; y<SSD1306_HEIGHT; y++)
+  // p_data 가 NULL 이면 페이지 버퍼에 이미 그려진 상태이다.
+  //
+  if (p_buf != NULL)
   {
-    for (int x=0; x<SSD1306_WIDTH; x++)
+    for (int y=0; y<SSD1306_HEIGHT; y++)
     {
-      ssd1306DrawPixel(x, y, p_buf[y*LCD_WIDTH + x]);
+      for (int x=0; x<SSD1306_WIDTH; x++)
+      {
+        ssd1306DrawPixel(x, y, p_buf[y*LCD_WIDTH + x]);
+      }
     }
   }
 
-  ssd1306UpdateDraw();
-
-  if (frameCallBack != NULL)
+  // 전송이 시작되면 완료 인터럽트에서 frameCallBack 을 호출한다.
+  //
+  if (ssd1306UpdateDraw() != true)
   {
-    frameCallBack();
+    if (frameCallBack != NULL)
+    {
+      frameCallBack();
+    }
   }
   return true;
 }
@@ -167,48 +203,269 @@ bool ssd1306SetCallBack(void (*p_func)(void))
 
 void ssd1306Fill(uint16_t color)
 {
-  uint32_t i;
+  ssd1306FillRect(0, 0, SSD1306_WIDTH, SSD1306_HEIGHT, color);
+}
+
+void ssd1306MarkDirty(uint8_t page, uint8_t x0, uint8_t x1)
+{
+  if (dirty_x0[page] == SSD1306_CLEAN)
+  {
+    dirty_x0[page] = x0;
+    dirty_x1[page] = x1;
+    return;
+  }
+  if (x0 < dirty_x0[page])
+    dirty_x0[page] = x0;
+  if (x1 > dirty_x1[page])
+    dirty_x1[page] = x1;
+}
 
-  for(i = 0; i < sizeof(ssd1306_buffer); i++)
+void ssd1306Invalidate(void)
+{
+  for (int i=0; i<sizeof(ssd1306_sent); i++)
   {
-    ssd1306_buffer[i] = (color > 0) ? 0xFF : 0x00;
+    ssd1306_sent[i] = ~ssd1306_buffer[i];
+  }
+  for (int i=0; i<SSD1306_PAGE_MAX; i++)
+  {
+    dirty_x0[i] = 0;
+    dirty_x1[i] = SSD1306_WIDTH-1;
   }
 }
 
 bool ssd1306UpdateDraw(void)
 {
-  uint8_t i;
+  uint8_t *p_buf;
+  uint8_t *p_sent;
+  int16_t  x0;
+  int16_t  x1;
+  uint32_t seq_cnt = 0;
+  uint32_t primask;
+  bool     ret;
+
 
-  for (i = 0; i < SSD1306_HEIGHT/8; i++)
+  if (is_tx_busy == true || i2cIsBegin(i2c_ch) != true)
   {
-    ssd1306WriteCmd(0xB0 + i);
-    ssd1306WriteCmd(0x00);
-    ssd1306WriteCmd(0x10);
+    return false;
+  }
+  if (is_tx_err == true)
+  {
+    is_tx_err = false;
+    ssd1306Invalidate();
+  }
+
+  tx_bytes = 0;
 
-    if (i2cWriteBytes(i2c_ch, i2c_dev, 0x40, &ssd1306_buffer[SSD1306_WIDTH * i], SSD1306_WIDTH, 100) == false)
+  for (int i = 0; i < SSD1306_PAGE_MAX; i++)
+  {
+    if (dirty_x0[i] == SSD1306_CLEAN)
+      continue;
+
+    p_buf  = &ssd1306_buffer[SSD1306_WIDTH * i];
+    p_sent = &ssd1306_sent[SSD1306_WIDTH * i];
+    x0     = dirty_x0[i];
+    x1     = dirty_x1[i];
+
+    while (x0 <= x1 && p_buf[x0] == p_sent[x0])
+      x0++;
+    while (x1 >= x0 && p_buf[x1] == p_sent[x1])
+      x1--;
+
+    if (x0 <= x1)
     {
-      return false;
+      memcpy(&p_sent[x0], &p_buf[x0], x1 - x0 + 1);
+
+      page_cmd[i][0] = 0xB0 + i;
+      page_cmd[i][1] = 0x00 | (x0 & 0x0F);
+      page_cmd[i][2] = 0x10 | (x0 >> 4);
+
+      ssd1306SetXfer(&tx_xfer[seq_cnt++], 0x00, page_cmd[i], 3);
+      ssd1306SetXfer(&tx_xfer[seq_cnt++], 0x40, &p_sent[x0], x1 - x0 + 1);
+
+      tx_bytes += x1 - x0 + 1;
     }
+
+    dirty_x0[i] = SSD1306_CLEAN;
+    dirty_x1[i] = 0;
   }
 
-  return true;
+  if (seq_cnt == 0)
+  {
+    return false;
+  }
+
+  // 완료 콜백은 I2C 인터럽트에서 오므로 큐에 넣는 동안에는 인터럽트를 막아
+  // 넣지 못한 전송이 있을 때 p_tx_last 를 안전하게 줄일 수 있게 한다.
+  //
+  primask = __get_PRIMASK();
+  __disable_irq();
+  p_tx_last  = &tx_xfer[seq_cnt-1];
+  is_tx_busy = true;
+  for (int i=0; i<seq_cnt; i++)
+  {
+    if (i2cSubmit(i2c_ch, &tx_xfer[i]) != true)
+    {
+      // 보내지 못한 영역은 다음 프레임에 전체를 다시 보낸다.
+      is_tx_err = true;
+      if (i == 0)
+        is_tx_busy = false;
+      else
+        p_tx_last = &tx_xfer[i-1];
+      break;
+    }
+  }
+  ret = is_tx_busy;
+  __set_PRIMASK(primask);
+
+  return ret;
+}
+
+void ssd1306SetXfer(i2c_xfer_t *p_xfer, uint8_t ctrl, uint8_t *p_data, uint16_t length)
+{
+  p_xfer->dev_addr = i2c_dev;
+  p_xfer->is_read  = false;
+  p_xfer->reg_size = 1;
+  p_xfer->reg_addr = ctrl;
+  p_xfer->p_data   = p_data;
+  p_xfer->length   = length;
+  p_xfer->prio     = I2C_PRIO_LOW;
+  p_xfer->timeout  = 100;
+  p_xfer->func     = ssd1306TxDone;
+  p_xfer->arg      = NULL;
+}
+
+void ssd1306TxDone(i2c_xfer_t *p_xfer, bool ret)
+{
+  // 실패하면 패널 내용을 알 수 없으므로 다음 프레임에 전체를 보낸다.
+  //
+  if (ret != true)
+  {
+    is_tx_err = true;
+  }
+  if (p_xfer != p_tx_last)
+  {
+    return;
+  }
+  is_tx_busy = false;
+
+  if (frameCallBack != NULL)
+  {
+    frameCallBack();
+  }
+}
+
+uint32_t ssd1306GetTxBytes(void)
+{
+  return tx_bytes;
 }
 
-void ssd1306DrawPixel(uint8_t x, uint8_t y, uint16_t color)
+void ssd1306DrawPixel(int16_t x, int16_t y, uint16_t color)
 {
-  if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT)
+  uint8_t *p_data;
+  uint8_t  data;
+
+
+  if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT)
   {
     return;
   }
 
+  p_data = &ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH];
+  if (color > 0)
+    data = *p_data | (1 << (y % 8));
+  else
+    data = *p_data & ~(1 << (y % 8));
+
+  if (data != *p_data)
+  {
+    *p_data = data;
+    ssd1306MarkDirty(y / 8, x, x);
+  }
+}
+
+uint16_t ssd1306ReadPixel(int16_t x, int16_t y)
+{
+  if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT)
+  {
+    return black;
+  }
+
+  if (ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH] & (1 << (y % 8)))
+    return white;
+  else
+    return black;
+}
+
+//-- 글자 출력용 가로 구간 그리기. 호출하는 쪽에서 화면 안으로 잘라서 넘긴다.
+//
+void ssd1306DrawSpan(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  uint8_t *p_data;
+  uint8_t  mask;
+  uint8_t  diff = 0;
+
+
+  p_data = &ssd1306_buffer[(y / 8) * SSD1306_WIDTH + x];
+  mask   = 1 << (y % 8);
 
   if (color > 0)
   {
-    ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+    for (int i=0; i<w; i++)
+    {
+      diff      |= ~p_data[i] & mask;
+      p_data[i] |= mask;
+    }
   }
   else
   {
-    ssd1306_buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+    for (int i=0; i<w; i++)
+    {
+      diff      |= p_data[i] & mask;
+      p_data[i] &= ~mask;
+    }
+  }
+  if (diff != 0)
+  {
+    ssd1306MarkDirty(y / 8, x, x + w - 1);
+  }
+}
+
+void ssd1306FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  uint8_t *p_data;
+  uint8_t  mask;
+  int16_t  page_y;
+
+
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > SSD1306_WIDTH)  w = SSD1306_WIDTH - x;
+  if (y + h > SSD1306_HEIGHT) h = SSD1306_HEIGHT - y;
+  if (w <= 0 || h <= 0)
+  {
+    return;
+  }
+
+  // 페이지 단위로 세로 8픽셀을 한번에 바꾼다.
+  //
+  for (int page = y / 8; page <= (y + h - 1) / 8; page++)
+  {
+    page_y = page * 8;
+    mask   = 0xFF;
+    if (y > page_y)
+      mask &= (uint8_t)(0xFF << (y - page_y));
+    if (y + h < page_y + 8)
+      mask &= (uint8_t)(0xFF >> (page_y + 8 - (y + h)));
+
+    p_data = &ssd1306_buffer[page * SSD1306_WIDTH + x];
+    for (int i=0; i<w; i++)
+    {
+      if (color > 0)
+        p_data[i] |= mask;
+      else
+        p_data[i] &= ~mask;
+    }
+    ssd1306MarkDirty(page, x, x + w - 1);
   }
 }
 
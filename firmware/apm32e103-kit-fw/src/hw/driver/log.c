@@ -1,9 +1,11 @@
 #include "log.h"
+#include "mem.h"
 
 
 #ifdef _USE_HW_LOG
 #include "uart.h"
 #include "cli.h"
+#include "task.h"
 
 #ifdef _USE_HW_RTOS
 #define lock()      xSemaphoreTake(mutex_lock, portMAX_DELAY);
@@ -14,6 +16,26 @@
 #endif
 
 
+#ifdef _USE_HW_LOG_BIN
+#define LOG_BIN_Q_MASK        (LOG_BIN_Q_MAX - 1)
+#define LOG_BIN_UPDATE_MAX    4
+
+#if (LOG_BIN_Q_MAX & LOG_BIN_Q_MASK) != 0
+#error "HW_LOG_BIN_Q_MAX must be a power of 2"
+#endif
+#if LOG_BIN_ARG_MAX != 4
+#error "logUpdate() expects HW_LOG_BIN_ARG_MAX 4"
+#endif
+
+//-- 여러 생산자(ISR 포함), 단일 소비자 큐. 구조는 event.c 와 같다.
+//
+typedef struct
+{
+  volatile uint32_t seq;
+  log_bin_t         log;
+} log_bin_slot_t;
+#endif
+
 typedef struct
 {
   uint16_t line_index;
@@ -44,6 +66,20 @@ static char print_buf[256];
 static SemaphoreHandle_t mutex_lock;
 #endif
 
+#ifdef _USE_HW_LOG_BIN
+static volatile uint32_t bin_q_in   = 0;
+static uint32_t          bin_q_out  = 0;
+static volatile uint32_t bin_drop   = 0;
+static uint32_t          bin_read   = 0;
+static bool              is_bin_host = false;
+static log_bin_slot_t    bin_q[LOG_BIN_Q_MAX];
+#endif
+
+static void logWrite(char *p_data, uint32_t length);
+#ifdef _USE_HW_LOG_BIN
+static bool logBinCas(volatile uint32_t *p_addr, uint32_t expected, uint32_t desired);
+#endif
+
 
 
 #if CLI_USE(HW_LOG)
@@ -73,6 +109,16 @@ bool logInit(void)
   log_buf_list.buf_index      = 0;
   log_buf_list.buf            = buf_list;
 
+  MEM_BUF_ADD("log boot", buf_boot);
+  MEM_BUF_ADD("log list", buf_list);
+
+#ifdef _USE_HW_LOG_BIN
+  for (int i=0; i<LOG_BIN_Q_MAX; i++)
+  {
+    bin_q[i].seq = i;
+  }
+  MEM_BUF_ADD("log bin", bin_q);
+#endif
 
   is_init = true;
 
@@ -148,6 +194,20 @@ bool logBufPrintf(log_buf_t *p_log, char *p_data, uint32_t length)
   return true;
 }
 
+void logWrite(char *p_data, uint32_t length)
+{
+  if (is_open == true && is_enable == true)
+  {
+    uartWrite(log_ch, (uint8_t *)p_data, length);
+  }
+
+  if (is_boot_log)
+  {
+    logBufPrintf(&log_buf_boot, p_data, length);
+  }
+  logBufPrintf(&log_buf_list, p_data, length);
+}
+
 void logPrintf(const char *fmt, ...)
 {
   lock();
@@ -161,22 +221,135 @@ void logPrintf(const char *fmt, ...)
   va_start(args, fmt);
   len = vsnprintf(print_buf, 256, fmt, args);
 
-  if (is_open == true && is_enable == true)
+  logWrite(print_buf, len);
+
+  va_end(args);
+
+  unLock();
+}
+
+void logUpdate(void)
+{
+#ifdef _USE_HW_LOG_BIN
+  log_bin_t log;
+  int len;
+
+
+  // 호스트가 바이너리 로그를 가져가는 동안은 장치에서 변환하지 않는다.
+  //
+  if (is_init != true || is_bin_host == true)
+    return;
+
+  for (int i=0; i<LOG_BIN_UPDATE_MAX; i++)
   {
-    uartWrite(log_ch, (uint8_t *)print_buf, len);
+    if (logBinRead(&log) != true)
+      return;
+
+    lock();
+    len = snprintf(print_buf, 256, (const char *)log.fmt, log.arg[0], log.arg[1], log.arg[2], log.arg[3]);
+    if (len > 255)
+      len = 255;
+    logWrite(print_buf, len);
+    unLock();
   }
 
-  if (is_boot_log)
+  // 남은 로그가 있을 수 있으므로 쉬지 않고 다음 라운드에서 이어서 변환한다.
+#ifdef _USE_HW_TASK
+  taskSetBusy();
+#endif
+#endif
+}
+
+#ifdef _USE_HW_LOG_BIN
+bool logBinCas(volatile uint32_t *p_addr, uint32_t expected, uint32_t desired)
+{
+  if (__LDREXW(p_addr) != expected)
   {
-    logBufPrintf(&log_buf_boot, print_buf, len);
+    __CLREX();
+    return false;
   }
-  logBufPrintf(&log_buf_list, print_buf, len);
+  return __STREXW(desired, p_addr) == 0;
+}
 
-  va_end(args);
+bool logBinWrite(const char *fmt, uint32_t argc, const uint32_t *p_arg)
+{
+  log_bin_slot_t *p_slot;
+  uint32_t pos;
+  int32_t  diff;
 
-  unLock();
+
+  if (is_init != true)
+    return false;
+
+  pos = bin_q_in;
+  while(1)
+  {
+    p_slot = &bin_q[pos & LOG_BIN_Q_MASK];
+    diff = (int32_t)(p_slot->seq - pos);
+
+    if (diff == 0)
+    {
+      if (logBinCas(&bin_q_in, pos, pos + 1))
+        break;
+      pos = bin_q_in;
+    }
+    else if (diff < 0)
+    {
+      bin_drop++;
+      return false;
+    }
+    else
+    {
+      pos = bin_q_in;
+    }
+  }
+
+  if (argc > LOG_BIN_ARG_MAX)
+    argc = LOG_BIN_ARG_MAX;
+
+  p_slot->log.fmt     = (uint32_t)fmt;
+  p_slot->log.time_us = micros();
+  p_slot->log.argc    = argc;
+  for (int i=0; i<LOG_BIN_ARG_MAX; i++)
+  {
+    p_slot->log.arg[i] = i < argc ? p_arg[i] : 0;
+  }
+  __DMB();
+  p_slot->seq = pos + 1;
+
+  return true;
 }
 
+bool logBinRead(log_bin_t *p_log)
+{
+  log_bin_slot_t *p_slot;
+
+
+  p_slot = &bin_q[bin_q_out & LOG_BIN_Q_MASK];
+  if (p_slot->seq != bin_q_out + 1)
+    return false;
+
+  __DMB();
+  *p_log = p_slot->log;
+  __DMB();
+  p_slot->seq = bin_q_out + LOG_BIN_Q_MAX;
+  bin_q_out++;
+  bin_read++;
+
+  return true;
+}
+
+void logBinSetHost(bool enable)
+{
+  is_bin_host = enable;
+}
+
+uint32_t logBinGetDrop(void)
+{
+  return bin_drop;
+}
+#endif
+
 
 #if CLI_USE(HW_LOG)
 void cliCmd(cli_args_t *args)
@@ -192,6 +365,13 @@ void cliCmd(cli_args_t *args)
     cliPrintf("\n");
     cliPrintf("list.line_index %d\n", log_buf_list.line_index);
     cliPrintf("list.buf_length %d\n", log_buf_list.buf_length);
+#ifdef _USE_HW_LOG_BIN
+    cliPrintf("\n");
+    cliPrintf("bin.queue       %d/%d\n", bin_q_in - bin_q_out, LOG_BIN_Q_MAX);
+    cliPrintf("bin.read        %d\n", bin_read);
+    cliPrintf("bin.drop        %d\n", bin_drop);
+    cliPrintf("bin.host        %s\n", is_bin_host ? "On":"Off");
+#endif
 
     ret = true;
   }
@@ -0,0 +1,198 @@
+#include "mem.h"
+
+
+#ifdef _USE_HW_MEM
+#include <malloc.h>
+#include "cli.h"
+
+
+//-- memInit() 에서 힙 끝부터 현재 스택 위치까지를 패턴으로 채워두고
+//   지워지지 않은 가장 낮은 주소로 스택의 최대 사용량을 찾는다.
+//
+#define MEM_STACK_PAINT       0xA5A5A5A5
+#define MEM_STACK_MARGIN      64
+
+
+extern uint32_t _fw_flash_begin;
+extern uint32_t _fw_flash_end;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _snoinit;
+extern uint32_t _enoinit;
+extern uint32_t _end;
+extern uint32_t _estack;
+
+extern void *_sbrk(ptrdiff_t incr);
+
+
+#if CLI_USE(HW_MEM)
+static void cliCmd(cli_args_t *args);
+#endif
+static uint32_t *memGetStackLow(void);
+
+static bool      is_init = false;
+static uint32_t *paint_begin = NULL;
+static uint32_t *paint_end   = NULL;
+static uint32_t  buf_count   = 0;
+static mem_buf_t buf_tbl[MEM_BUF_MAX];
+
+
+
+
+
+bool memInit(void)
+{
+  uint32_t *p_addr;
+
+
+  // 스택이 얕은 초기화 단계에서 한번만 칠한다.
+  //
+  paint_begin = (uint32_t *)_sbrk(0);
+  paint_end   = (uint32_t *)((__get_MSP() - MEM_STACK_MARGIN) & ~0x03);
+
+  for (p_addr = paint_begin; p_addr < paint_end; p_addr++)
+  {
+    *p_addr = MEM_STACK_PAINT;
+  }
+  buf_count = 0;
+
+  is_init = true;
+
+#if CLI_USE(HW_MEM)
+  cliAdd("mem", cliCmd);
+#endif
+  return true;
+}
+
+bool memAddBuf(const char *name, void *p_buf, uint32_t size)
+{
+  if (buf_count >= MEM_BUF_MAX)
+    return false;
+
+  buf_tbl[buf_count].name  = name;
+  buf_tbl[buf_count].p_buf = p_buf;
+  buf_tbl[buf_count].size  = size;
+  buf_count++;
+
+  return true;
+}
+
+uint32_t memGetBufCount(void)
+{
+  return buf_count;
+}
+
+bool memGetBuf(uint32_t index, mem_buf_t *p_buf)
+{
+  if (index >= buf_count)
+    return false;
+
+  *p_buf = buf_tbl[index];
+  return true;
+}
+
+uint32_t *memGetStackLow(void)
+{
+  uint32_t *p_addr;
+  uint32_t *p_heap;
+
+
+  // 힙이 늘어나면서 지운 영역은 스택 사용으로 보지 않는다.
+  //
+  p_addr = paint_begin;
+  p_heap = (uint32_t *)_sbrk(0);
+  if (p_addr < p_heap)
+    p_addr = p_heap;
+
+  while (p_addr < paint_end && *p_addr == MEM_STACK_PAINT)
+  {
+    p_addr++;
+  }
+
+  return p_addr;
+}
+
+bool memGetInfo(mem_info_t *p_info)
+{
+  struct mallinfo mi;
+  uint32_t stack_low;
+  uint32_t heap_end;
+
+
+  if (is_init != true)
+    return false;
+
+  mi        = mallinfo();
+  stack_low = (uint32_t)memGetStackLow();
+  heap_end  = (uint32_t)_sbrk(0);
+
+  p_info->ram_size    = (uint32_t)&_estack - (uint32_t)&_sdata;
+  p_info->flash_size  = (uint32_t)&_fw_flash_end - (uint32_t)&_fw_flash_begin;
+  p_info->data_size   = (uint32_t)&_edata - (uint32_t)&_sdata;
+  p_info->bss_size    = (uint32_t)&_ebss - (uint32_t)&_sbss;
+  p_info->noinit_size = (uint32_t)&_enoinit - (uint32_t)&_snoinit;
+
+  p_info->buf_size = 0;
+  for (int i=0; i<buf_count; i++)
+  {
+    p_info->buf_size += buf_tbl[i].size;
+  }
+
+  p_info->heap_size  = heap_end - (uint32_t)&_end;
+  p_info->heap_used  = mi.uordblks;
+  p_info->stack_used = (uint32_t)&_estack - stack_low;
+  p_info->stack_free = stack_low > heap_end ? stack_low - heap_end : 0;
+
+  return true;
+}
+
+
+#if CLI_USE(HW_MEM)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    mem_info_t info;
+
+    memGetInfo(&info);
+
+    cliPrintf("flash      : %8d B\n", info.flash_size);
+    cliPrintf("sram       : %8d B\n", info.ram_size);
+    cliPrintf("  .data    : %8d B\n", info.data_size);
+    cliPrintf("  .bss     : %8d B\n", info.bss_size);
+    cliPrintf("  .noinit  : %8d B\n", info.noinit_size);
+    cliPrintf("  buf      : %8d B, %d registered\n", info.buf_size, buf_count);
+    cliPrintf("  heap     : %8d B, used %d B\n", info.heap_size, info.heap_used);
+    cliPrintf("  stack    : %8d B max\n", info.stack_used);
+    cliPrintf("  free     : %8d B\n", info.stack_free);
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "buf"))
+  {
+    uint32_t total = 0;
+
+    cliPrintf("name               addr        size\n");
+    for (int i=0; i<buf_count; i++)
+    {
+      cliPrintf("%-16s 0x%08X %8d\n", buf_tbl[i].name, (uint32_t)buf_tbl[i].p_buf, buf_tbl[i].size);
+      total += buf_tbl[i].size;
+    }
+    cliPrintf("total                       %8d\n", total);
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("mem info\n");
+    cliPrintf("mem buf\n");
+  }
+}
+#endif
+
+#endif
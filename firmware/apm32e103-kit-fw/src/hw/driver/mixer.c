@@ -9,6 +9,7 @@
 
 
 #include "mixer.h"
+#include "perf.h"
 
 
 
@@ -17,7 +18,7 @@
 
 
 static uint32_t mixerBufAvailable(mixer_t *p_mixer, uint8_t ch);
-static int16_t mixerBufRead(mixer_t *p_mixer, uint8_t ch);
+static void     mixerBufReadAdd(mixer_buf_t *p_buf, int32_t *p_acc, uint32_t length);
 
 
 
@@ -34,6 +35,7 @@ bool mixerInit(mixer_t *p_mixer)
     p_mixer->buf[i].length = MIXER_MAX_BUF_LEN;
   }
   p_mixer->volume = 100;
+  p_mixer->gain   = MIXER_GAIN_UNITY;
 
   return true;
 }
@@ -41,6 +43,7 @@ bool mixerInit(mixer_t *p_mixer)
 bool mixerSetVolume(mixer_t *p_mixer, int32_t volume)
 {
   p_mixer->volume = constrain(volume, 0, 100);
+  p_mixer->gain   = (p_mixer->volume << 15) / 100;
   return true;
 }
 
@@ -103,24 +106,41 @@ int16_t mixerSamples(int16_t a, int16_t b)
         a + b);
 }
 
+//-- DMA 인터럽트에서 호출된다.
+//   채널 버퍼에서 연속된 구간을 꺼내 32bit 로 더하고, 블록 끝에서
+//   Q15 볼륨을 곱한 뒤 한번만 포화시킨다.
+//
 bool mixerRead(mixer_t *p_mixer, int16_t *p_data, uint32_t length)
 {
-  uint32_t i;
-  uint32_t ch;
-  int16_t mixer_out;
-  int16_t sample;
+  PERF_SCOPE("mixerRead");
+  int32_t  acc[MIXER_BLOCK_LEN];
+  int32_t  gain = p_mixer->gain;
+  uint32_t block_len;
 
-  for (i=0; i<length; i++)
+
+  while(length > 0)
   {
+    block_len = cmin(length, MIXER_BLOCK_LEN);
+
+    memset(acc, 0, block_len * sizeof(int32_t));
+    for (int ch=0; ch<MIXER_MAX_CH; ch++)
+    {
+      mixerBufReadAdd(&p_mixer->buf[ch], acc, block_len);
+    }
 
-    mixer_out = mixerBufRead(p_mixer, 0);
-    for (ch=1; ch<MIXER_MAX_CH; ch++)
+    if (gain == MIXER_GAIN_UNITY)
+    {
+      for (int i=0; i<block_len; i++)
+        p_data[i] = (int16_t)__SSAT(acc[i], 16);
+    }
+    else
     {
-      sample = mixerBufRead(p_mixer, ch);
-      mixer_out = mixerSamples(mixer_out, sample);
+      for (int i=0; i<block_len; i++)
+        p_data[i] = (int16_t)__SSAT((int32_t)(((int64_t)acc[i] * gain) >> 15), 16);
     }
 
-    p_data[i] = mixer_out * p_mixer->volume / 100;;
+    p_data += block_len;
+    length -= block_len;
   }
 
   return true;
@@ -128,39 +148,50 @@ bool mixerRead(mixer_t *p_mixer, int16_t *p_data, uint32_t length)
 
 uint32_t mixerBufAvailable(mixer_t *p_mixer, uint8_t ch)
 {
-  uint32_t ret = 0;
+  uint32_t in;
+  uint32_t out;
 
   if (ch >= MIXER_MAX_CH) return 0;
 
-  ret = (p_mixer->buf[ch].length + p_mixer->buf[ch].in - p_mixer->buf[ch].out) % p_mixer->buf[ch].length;
+  in  = p_mixer->buf[ch].in;
+  out = p_mixer->buf[ch].out;
 
-  return ret;
+  if (in >= out)
+    return in - out;
+  else
+    return p_mixer->buf[ch].length - out + in;
 }
 
-int16_t mixerBufRead(mixer_t *p_mixer, uint8_t ch)
+// 버퍼가 끝에서 넘어가면 두 구간으로 나눠서 더한다.
+// 모자란 샘플은 0 으로 둔다.
+//
+void mixerBufReadAdd(mixer_buf_t *p_buf, int32_t *p_acc, uint32_t length)
 {
-  int16_t ret = 0;
-  uint32_t index;
-  uint32_t next_index;
-
-  if (ch >= MIXER_MAX_CH) return 0;
-
+  uint32_t in  = p_buf->in;
+  uint32_t out = p_buf->out;
+  uint32_t span;
+  const int16_t *p_src;
 
-  index      = p_mixer->buf[ch].out;
-  next_index = p_mixer->buf[ch].out + 1;
 
-  if (next_index == p_mixer->buf[ch].length)
+  while(length > 0 && out != in)
   {
-    next_index = 0;
-  }
+    span  = (in > out ? in : p_buf->length) - out;
+    span  = cmin(span, length);
+    p_src = &p_buf->buf[out];
 
-  if (index != p_mixer->buf[ch].in)
-  {
-    ret = p_mixer->buf[ch].buf[index];
-    p_mixer->buf[ch].out = next_index;
+    for (int i=0; i<span; i++)
+    {
+      p_acc[i] += p_src[i];
+    }
+    p_acc  += span;
+    length -= span;
+
+    out += span;
+    if (out == p_buf->length)
+      out = 0;
   }
 
-  return ret;
+  p_buf->out = out;
 }
 
 uint32_t mixerAvailable(mixer_t *p_mixer)
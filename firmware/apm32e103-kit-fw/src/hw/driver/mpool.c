@@ -0,0 +1,318 @@
+#include "mpool.h"
+#include "mem.h"
+
+
+#ifdef _USE_HW_MPOOL
+#include "cli.h"
+#include "log.h"
+
+
+//-- 크기별 고정 블럭 풀. 비어있는 블럭의 앞 4바이트에 다음 블럭 주소를
+//   넣어 free list 로 쓰므로 할당/해제가 블럭 수와 상관없이 일정하다.
+//   요청 크기에 맞는 가장 작은 풀에서만 할당하고 큰 풀로 넘어가지 않는다.
+//
+#define MPOOL_ALIGN(x)        (((x) + 3) & ~0x03)
+
+
+typedef struct
+{
+  uint32_t owner;             // 할당한 함수의 복귀 주소, 0 이면 비어있음
+  uint32_t tick;
+} mpool_dbg_t;
+
+typedef struct
+{
+  const char  *name;
+  uint16_t     block_size;
+  uint16_t     block_cnt;
+  uint8_t     *p_mem;
+  void        *p_free;
+
+  uint16_t     used;
+  uint16_t     used_max;
+  uint32_t     alloc_cnt;
+  uint32_t     fail_cnt;
+  uint32_t     err_cnt;
+#if MPOOL_DEBUG
+  mpool_dbg_t *p_dbg;
+#endif
+} mpool_t;
+
+
+#if CLI_USE(HW_MPOOL)
+static void cliCmd(cli_args_t *args);
+#endif
+static mpool_t *mpoolFind(void *p_mem, uint32_t *p_index);
+
+static uint8_t mem_m[HW_MPOOL_M_CNT][MPOOL_ALIGN(HW_MPOOL_M_SIZE)] __attribute__((aligned(4)));
+static uint8_t mem_l[HW_MPOOL_L_CNT][MPOOL_ALIGN(HW_MPOOL_L_SIZE)] __attribute__((aligned(4)));
+#if MPOOL_DEBUG
+static mpool_dbg_t dbg_m[HW_MPOOL_M_CNT];
+static mpool_dbg_t dbg_l[HW_MPOOL_L_CNT];
+#endif
+
+static bool    is_init = false;
+static mpool_t pool_tbl[] =
+{
+  {"m", MPOOL_ALIGN(HW_MPOOL_M_SIZE), HW_MPOOL_M_CNT, &mem_m[0][0], NULL, 0, 0, 0, 0, 0,
+#if MPOOL_DEBUG
+   dbg_m
+#endif
+  },
+  {"l", MPOOL_ALIGN(HW_MPOOL_L_SIZE), HW_MPOOL_L_CNT, &mem_l[0][0], NULL, 0, 0, 0, 0, 0,
+#if MPOOL_DEBUG
+   dbg_l
+#endif
+  },
+};
+
+#define MPOOL_MAX             (sizeof(pool_tbl)/sizeof(mpool_t))
+
+
+
+
+
+bool mpoolInit(void)
+{
+  for (int i=0; i<MPOOL_MAX; i++)
+  {
+    mpool_t *p_pool = &pool_tbl[i];
+
+    p_pool->p_free = NULL;
+    for (int j=p_pool->block_cnt-1; j>=0; j--)
+    {
+      void **p_block = (void **)&p_pool->p_mem[j * p_pool->block_size];
+
+      *p_block = p_pool->p_free;
+      p_pool->p_free = p_block;
+    }
+    p_pool->used      = 0;
+    p_pool->used_max  = 0;
+    p_pool->alloc_cnt = 0;
+    p_pool->fail_cnt  = 0;
+    p_pool->err_cnt   = 0;
+#if MPOOL_DEBUG
+    for (int j=0; j<p_pool->block_cnt; j++)
+    {
+      p_pool->p_dbg[j].owner = 0;
+      p_pool->p_dbg[j].tick  = 0;
+    }
+#endif
+  }
+
+  MEM_BUF_ADD("mpool m", mem_m);
+  MEM_BUF_ADD("mpool l", mem_l);
+
+  is_init = true;
+
+#if CLI_USE(HW_MPOOL)
+  cliAdd("mpool", cliCmd);
+#endif
+  return true;
+}
+
+void *mpoolAlloc(size_t size)
+{
+  mpool_t *p_pool = NULL;
+  void   **p_block = NULL;
+  uint32_t primask;
+
+
+  if (is_init != true)
+    return NULL;
+
+  for (int i=0; i<MPOOL_MAX; i++)
+  {
+    if (size <= pool_tbl[i].block_size)
+    {
+      p_pool = &pool_tbl[i];
+      break;
+    }
+  }
+  if (p_pool == NULL)
+    return NULL;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  p_block = (void **)p_pool->p_free;
+  if (p_block != NULL)
+  {
+    p_pool->p_free = *p_block;
+    p_pool->used++;
+    p_pool->alloc_cnt++;
+    if (p_pool->used > p_pool->used_max)
+      p_pool->used_max = p_pool->used;
+#if MPOOL_DEBUG
+    uint32_t index = ((uint8_t *)p_block - p_pool->p_mem) / p_pool->block_size;
+
+    p_pool->p_dbg[index].owner = (uint32_t)__builtin_return_address(0);
+    p_pool->p_dbg[index].tick  = millis();
+#endif
+  }
+  else
+  {
+    p_pool->fail_cnt++;
+  }
+  __set_PRIMASK(primask);
+
+  return (void *)p_block;
+}
+
+mpool_t *mpoolFind(void *p_mem, uint32_t *p_index)
+{
+  uint8_t *p_addr = (uint8_t *)p_mem;
+
+  for (int i=0; i<MPOOL_MAX; i++)
+  {
+    mpool_t *p_pool = &pool_tbl[i];
+    uint32_t offset;
+
+    if (p_addr < p_pool->p_mem || p_addr >= p_pool->p_mem + p_pool->block_size * p_pool->block_cnt)
+      continue;
+
+    offset = p_addr - p_pool->p_mem;
+    if ((offset % p_pool->block_size) != 0)
+      return NULL;
+
+    *p_index = offset / p_pool->block_size;
+    return p_pool;
+  }
+  return NULL;
+}
+
+void mpoolFree(void *p_mem)
+{
+  mpool_t *p_pool;
+  uint32_t index;
+  uint32_t primask;
+
+
+  if (p_mem == NULL)
+    return;
+
+  // 호출하는 쪽이 인터럽트를 막은 상태일 수 있으므로 텍스트 로그 대신
+  // 블럭되지 않는 바이너리 로그만 남긴다.
+  //
+  p_pool = mpoolFind(p_mem, &index);
+  if (p_pool == NULL)
+  {
+    logBinPrintf("[E_] mpoolFree() invalid addr 0x%X\n", (uint32_t)p_mem);
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+#if MPOOL_DEBUG
+  if (p_pool->p_dbg[index].owner == 0)
+  {
+    p_pool->err_cnt++;
+    __set_PRIMASK(primask);
+    logBinPrintf("[E_] mpoolFree() double free 0x%X\n", (uint32_t)p_mem);
+    return;
+  }
+  p_pool->p_dbg[index].owner = 0;
+#endif
+  *(void **)p_mem = p_pool->p_free;
+  p_pool->p_free  = p_mem;
+  p_pool->used--;
+  __set_PRIMASK(primask);
+}
+
+uint32_t mpoolGetCount(void)
+{
+  return MPOOL_MAX;
+}
+
+bool mpoolGetInfo(uint32_t index, mpool_info_t *p_info)
+{
+  mpool_t *p_pool;
+
+  if (index >= MPOOL_MAX)
+    return false;
+
+  p_pool = &pool_tbl[index];
+  p_info->name       = p_pool->name;
+  p_info->block_size = p_pool->block_size;
+  p_info->block_cnt  = p_pool->block_cnt;
+  p_info->used       = p_pool->used;
+  p_info->used_max   = p_pool->used_max;
+  p_info->alloc_cnt  = p_pool->alloc_cnt;
+  p_info->fail_cnt   = p_pool->fail_cnt;
+  p_info->err_cnt    = p_pool->err_cnt;
+  return true;
+}
+
+
+#if CLI_USE(HW_MPOOL)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("name  size  cnt used  max      alloc   fail    err\n");
+    for (int i=0; i<MPOOL_MAX; i++)
+    {
+      mpool_t *p_pool = &pool_tbl[i];
+
+      cliPrintf("%-4s %5d %4d %4d %4d %10d %6d %6d\n",
+                p_pool->name,
+                p_pool->block_size,
+                p_pool->block_cnt,
+                p_pool->used,
+                p_pool->used_max,
+                p_pool->alloc_cnt,
+                p_pool->fail_cnt,
+                p_pool->err_cnt);
+    }
+    ret = true;
+  }
+
+#if MPOOL_DEBUG
+  if (args->argc >= 1 && args->isStr(0, "leak"))
+  {
+    uint32_t age_ms = 0;
+    uint32_t cnt = 0;
+
+    // age_ms 보다 오래 해제되지 않은 블럭을 할당한 위치와 함께 보여준다.
+    //
+    if (args->argc == 2)
+      age_ms = args->getData(1);
+
+    for (int i=0; i<MPOOL_MAX; i++)
+    {
+      mpool_t *p_pool = &pool_tbl[i];
+
+      for (int j=0; j<p_pool->block_cnt; j++)
+      {
+        mpool_dbg_t *p_dbg = &p_pool->p_dbg[j];
+
+        if (p_dbg->owner == 0 || millis() - p_dbg->tick < age_ms)
+          continue;
+
+        cliPrintf("%-4s %2d 0x%08X owner 0x%08X, %d ms\n",
+                  p_pool->name,
+                  j,
+                  (uint32_t)&p_pool->p_mem[j * p_pool->block_size],
+                  p_dbg->owner & ~0x01,
+                  millis() - p_dbg->tick);
+        cnt++;
+      }
+    }
+    cliPrintf("%d blocks\n", cnt);
+    ret = true;
+  }
+#endif
+
+  if (ret == false)
+  {
+    cliPrintf("mpool info\n");
+#if MPOOL_DEBUG
+    cliPrintf("mpool leak [age_ms]\n");
+#endif
+  }
+}
+#endif
+
+#endif
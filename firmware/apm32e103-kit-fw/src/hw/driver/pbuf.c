@@ -0,0 +1,169 @@
+#include "pbuf.h"
+
+
+#ifdef _USE_HW_PBUF
+#include "cli.h"
+#include "mpool.h"
+
+
+//-- cmd 채널과 전송 드라이버가 같이 쓰는 고정 크기 패킷 버퍼.
+//   mpool 블럭 앞쪽에 pbuf_t 를 두고 뒤를 데이터로 쓰며,
+//   참조 카운트가 0 이 되면 풀로 돌아간다.
+//
+#define PBUF_BLOCK_SIZE       (sizeof(pbuf_t) + PBUF_LENGTH)
+
+#if PBUF_LENGTH + 16 > HW_MPOOL_L_SIZE
+#error "HW_MPOOL_L_SIZE is smaller than a pbuf block"
+#endif
+
+
+#if CLI_USE(HW_PBUF)
+static void cliCmd(cli_args_t *args);
+#endif
+static uint32_t pbufLock(void);
+static void pbufUnlock(uint32_t primask);
+
+static bool     is_init   = false;
+static uint32_t used      = 0;
+static uint32_t free_min  = 0;
+static uint32_t alloc_cnt = 0;
+static uint32_t fail_cnt  = 0;
+
+
+
+
+
+bool pbufInit(void)
+{
+  used      = 0;
+  free_min  = PBUF_MAX;
+  alloc_cnt = 0;
+  fail_cnt  = 0;
+
+  is_init = true;
+
+#if CLI_USE(HW_PBUF)
+  cliAdd("pbuf", cliCmd);
+#endif
+  return true;
+}
+
+uint32_t pbufLock(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  return primask;
+}
+
+void pbufUnlock(uint32_t primask)
+{
+  __set_PRIMASK(primask);
+}
+
+pbuf_t *pbufAlloc(void)
+{
+  pbuf_t  *p_pbuf = NULL;
+  uint32_t primask;
+
+
+  if (is_init != true)
+    return NULL;
+
+  primask = pbufLock();
+  if (used < PBUF_MAX)
+  {
+    p_pbuf = (pbuf_t *)mpoolAlloc(PBUF_BLOCK_SIZE);
+  }
+  if (p_pbuf != NULL)
+  {
+    p_pbuf->p_buf  = (uint8_t *)&p_pbuf[1];
+    p_pbuf->size   = PBUF_LENGTH;
+    p_pbuf->length = 0;
+    p_pbuf->ref    = 1;
+    used++;
+    alloc_cnt++;
+
+    if (PBUF_MAX - used < free_min)
+      free_min = PBUF_MAX - used;
+  }
+  else
+  {
+    fail_cnt++;
+  }
+  pbufUnlock(primask);
+
+  return p_pbuf;
+}
+
+pbuf_t *pbufRef(pbuf_t *p_pbuf)
+{
+  uint32_t primask;
+
+  if (p_pbuf == NULL)
+    return NULL;
+
+  primask = pbufLock();
+  p_pbuf->ref++;
+  pbufUnlock(primask);
+
+  return p_pbuf;
+}
+
+void pbufFree(pbuf_t *p_pbuf)
+{
+  uint32_t primask;
+  bool     is_free = false;
+
+  if (p_pbuf == NULL)
+    return;
+
+  primask = pbufLock();
+  if (p_pbuf->ref > 0)
+  {
+    p_pbuf->ref--;
+    if (p_pbuf->ref == 0)
+    {
+      used--;
+      is_free = true;
+    }
+  }
+  pbufUnlock(primask);
+
+  // ref 가 0 이 된 블럭은 더 이상 공유되지 않으므로 락 밖에서 반납한다.
+  if (is_free == true)
+  {
+    mpoolFree(p_pbuf);
+  }
+}
+
+uint32_t pbufGetFree(void)
+{
+  return PBUF_MAX - used;
+}
+
+
+#if CLI_USE(HW_PBUF)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    cliPrintf("block    : %d x %d B\n", PBUF_MAX, PBUF_LENGTH);
+    cliPrintf("free     : %d\n", pbufGetFree());
+    cliPrintf("free min : %d\n", free_min);
+    cliPrintf("alloc    : %d\n", alloc_cnt);
+    cliPrintf("fail     : %d\n", fail_cnt);
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("pbuf info\n");
+  }
+}
+#endif
+
+#endif
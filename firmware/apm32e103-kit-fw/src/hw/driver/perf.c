@@ -0,0 +1,193 @@
+#include "perf.h"
+
+
+#ifdef _USE_HW_PERF
+#include "cli.h"
+
+
+//-- 측정 범위는 처음 실행될 때 리스트에 등록되므로 개수 제한이 없다.
+//   히스토그램은 cycle 의 log2 구간으로 나누어 누적한다.
+//
+
+
+#if CLI_USE(HW_PERF)
+static void cliCmd(cli_args_t *args);
+#endif
+static void perfRegister(perf_t *p_perf);
+
+static bool    is_init   = false;
+static perf_t *perf_head = NULL;
+
+
+
+
+
+bool perfInit(void)
+{
+#if HW_PERF_HOST == 0
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+  is_init = true;
+
+#if CLI_USE(HW_PERF)
+  cliAdd("perf", cliCmd);
+#endif
+  return true;
+}
+
+void perfRegister(perf_t *p_perf)
+{
+  uint32_t primask;
+
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (p_perf->is_reg != true)
+  {
+    p_perf->min    = 0xFFFFFFFF;
+    p_perf->next   = perf_head;
+    perf_head      = p_perf;
+    p_perf->is_reg = true;
+  }
+  __set_PRIMASK(primask);
+}
+
+void perfAdd(perf_t *p_perf, uint32_t cycle)
+{
+  int32_t bin;
+
+
+  if (p_perf->is_reg != true)
+  {
+    if (is_init != true)
+      return;
+    perfRegister(p_perf);
+  }
+
+  bin = cycle > 0 ? (31 - (int32_t)__CLZ(cycle)) - PERF_BIN_SHIFT : 0;
+  if (bin < 0)
+    bin = 0;
+  if (bin >= PERF_BIN_MAX)
+    bin = PERF_BIN_MAX - 1;
+
+  p_perf->count++;
+  p_perf->sum += cycle;
+  if (cycle < p_perf->min)
+    p_perf->min = cycle;
+  if (cycle > p_perf->max)
+    p_perf->max = cycle;
+  p_perf->bin[bin]++;
+}
+
+void perfClear(void)
+{
+  uint32_t primask;
+
+
+  for (perf_t *p_perf = perf_head; p_perf != NULL; p_perf = p_perf->next)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    p_perf->count = 0;
+    p_perf->min   = 0xFFFFFFFF;
+    p_perf->max   = 0;
+    p_perf->sum   = 0;
+    for (int i=0; i<PERF_BIN_MAX; i++)
+    {
+      p_perf->bin[i] = 0;
+    }
+    __set_PRIMASK(primask);
+  }
+}
+
+perf_t *perfGetList(void)
+{
+  return perf_head;
+}
+
+uint32_t perfGetBinCycle(uint8_t bin)
+{
+  // 구간의 상한값
+  return 1UL << (bin + PERF_BIN_SHIFT + 1);
+}
+
+
+#if CLI_USE(HW_PERF)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+  uint32_t cycle_per_us = SystemCoreClock / 1000000;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    int idx = 0;
+
+    cliPrintf("idx name                    count   min(us)   avg(us)   max(us)\n");
+    for (perf_t *p_perf = perf_head; p_perf != NULL; p_perf = p_perf->next)
+    {
+      uint32_t avg = p_perf->count > 0 ? (uint32_t)(p_perf->sum / p_perf->count) : 0;
+      uint32_t min = p_perf->count > 0 ? p_perf->min : 0;
+
+      cliPrintf("%3d %-20s %8d %5d.%03d %5d.%03d %5d.%03d\n",
+                idx++,
+                p_perf->name,
+                p_perf->count,
+                min/cycle_per_us, (min%cycle_per_us)*1000/cycle_per_us,
+                avg/cycle_per_us, (avg%cycle_per_us)*1000/cycle_per_us,
+                p_perf->max/cycle_per_us, (p_perf->max%cycle_per_us)*1000/cycle_per_us);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 2 && args->isStr(0, "hist"))
+  {
+    int idx = 0;
+    int sel = args->getData(1);
+
+    for (perf_t *p_perf = perf_head; p_perf != NULL; p_perf = p_perf->next, idx++)
+    {
+      if (idx != sel)
+        continue;
+
+      cliPrintf("%s, count %d\n", p_perf->name, p_perf->count);
+      cliPrintf("   < cycle      < us      count\n");
+      for (int i=0; i<PERF_BIN_MAX; i++)
+      {
+        uint32_t bar_len;
+
+        bar_len = p_perf->count > 0 ? (uint32_t)((uint64_t)p_perf->bin[i] * 40 / p_perf->count) : 0;
+
+        if (i < PERF_BIN_MAX - 1)
+          cliPrintf("%10d %9d %10d ", perfGetBinCycle(i), perfGetBinCycle(i)/cycle_per_us, p_perf->bin[i]);
+        else
+          cliPrintf("%10s %9s %10d ", "max", "", p_perf->bin[i]);
+
+        for (int j=0; j<bar_len; j++)
+        {
+          cliPrintf("#");
+        }
+        cliPrintf("\n");
+      }
+    }
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "clear"))
+  {
+    perfClear();
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("perf info\n");
+    cliPrintf("perf hist idx\n");
+    cliPrintf("perf clear\n");
+  }
+}
+#endif
+
+#endif
@@ -1,5 +1,4 @@
 #include "resize.h"
-#include <math.h>
 
 
 #define USE_COLOR_DEPTH 16
@@ -39,330 +38,222 @@
 #endif
 #endif
 
+#if (USE_COLOR_DEPTH != 16)
+#error "fixed-point kernels assume RGB565"
+#endif
 
 
+//-- FPU 가 없으므로 좌표는 Q16, 보간 가중치는 Q10 정수로 계산한다.
+//   열마다 같은 좌표/가중치를 쓰므로 한번만 표로 만들고, 폭이 표보다 크면
+//   RESIZE_COL_MAX 열씩 나누어 처리한다.
+//
+#define RESIZE_Q              16
+#define RESIZE_W_Q            10
+#define RESIZE_W_ONE          (1<<RESIZE_W_Q)
+#define RESIZE_COL_MAX        128
 
-
-void resizeImage(resize_image_t *src, resize_image_t *dest)
-{
-  int srcw = src->w;
-  int srch = src->h;
-  int destw = dest->w;
-  int desth = dest->h;
-  int i, j;
-  float src_dest_w = (float)(src->w-1)/(float)(dest->w-1);
-  float src_dest_h = (float)(src->h-1)/(float)(dest->h-1);
-  float ci, cj;
-  int x1, y1, x2, y2;
-  float xoff, yoff;
-  unsigned c1_rgb[3], c2_rgb[3], c3_rgb[3], c4_rgb[3];
-  unsigned r, g, b;
-
-
-   COLOR_DEPTH_TYPE *line1, *line2;
-   COLOR_DEPTH_TYPE *dest_line;
-
-   cj = 0;
-   for (j=0; j<desth; j++)
-   {
-     y1 = cj;
-     y2 = y1 < srch-1 ? y1+1 : srch-1;
-     yoff = cj-y1;
-     line1 = (COLOR_DEPTH_TYPE *)&src->p_data[y1*src->w];
-     line2 = (COLOR_DEPTH_TYPE *)&src->p_data[y2*src->w];
-     dest_line = (COLOR_DEPTH_TYPE *)&dest->p_data[j*dest->w];
-
-     ci = 0;
-     for(i=0; i<destw; i++)
-     {
-       x1 = ci;
-       x2 = x1<srcw-1 ? x1+1 : srcw-1;
-       c1_rgb[0] = GETR(line1[x1]);
-       c1_rgb[1] = GETG(line1[x1]);
-       c1_rgb[2] = GETB(line1[x1]);
-       c2_rgb[0] = GETR(line1[x2]);
-       c2_rgb[1] = GETG(line1[x2]);
-       c2_rgb[2] = GETB(line1[x2]);
-       c3_rgb[0] = GETR(line2[x1]);
-       c3_rgb[1] = GETG(line2[x1]);
-       c3_rgb[2] = GETB(line2[x1]);
-       c4_rgb[0] = GETR(line2[x2]);
-       c4_rgb[1] = GETG(line2[x2]);
-       c4_rgb[2] = GETB(line2[x2]);
-
-       xoff = ci-x1;
-       r = (c1_rgb[0]*(1-xoff)+(c2_rgb[0]*xoff))*(1-yoff)+(c3_rgb[0]*(1-xoff)+(c4_rgb[0]*xoff))*yoff;
-       g = (c1_rgb[1]*(1-xoff)+(c2_rgb[1]*xoff))*(1-yoff)+(c3_rgb[1]*(1-xoff)+(c4_rgb[1]*xoff))*yoff;
-       b = (c1_rgb[2]*(1-xoff)+(c2_rgb[2]*xoff))*(1-yoff)+(c3_rgb[2]*(1-xoff)+(c4_rgb[2]*xoff))*yoff;
-       dest_line[i] = MAKECOL(r, g, b);
-       ci+=src_dest_w;
-     }
-     cj+=src_dest_h;
-   }
-}
-
-
-#define AFFINEWARP_ISHIFT  16
-#define AFFINEWARP_QSHIFT  0
-#define AFFINEWARP_COEFFMASK  0xFFFF
-
-#define round2int32(dbl) ( floor((dbl) +0.5))
-
+// RGB565 의 R 과 B 를 16bit 레인 두개에 나누어 한번의 곱셈으로 같이 보간한다.
+// 31 * 1024 는 16bit 를 넘지 않으므로 레인끼리 섞이지 않는다.
+#define RB_PACK(c)            ((((uint32_t)(c) & 0xF800) << 5) | ((c) & 0x001F))
+#define RB_UNPACK(rb)         ((((rb) >> 5) & 0xF800) | ((rb) & 0x001F))
+#define RB_MASK               0x001F001F
+#define G_PACK(c)             (((c) >> 5) & 0x3F)
 
 
-__attribute__((optimize("O2"))) void resizeImageFast(resize_image_t *src, resize_image_t *dest)
+typedef struct
 {
-  int destw = dest->w;
-  int desth = dest->h;
-  int i, j;
-  float src_dest_w = (float)(src->w-1)/(float)(dest->w-1);
-  float src_dest_h = (float)(src->h-1)/(float)(dest->h-1);
-  unsigned r, g, b;
-
-
-   COLOR_DEPTH_TYPE *line1, *line2;
-   COLOR_DEPTH_TYPE *dest_line;
-
-   int_least32_t xstep_c;
-   int_least32_t xstep_r;
-   int_least32_t ystep_c;
-   int_least32_t ystep_r;
-   int_least32_t xf, yf;
-   uint_least16_t cxf, cyf;
-   uint_least16_t oneminuscxf, oneminuscyf;
-   int_least32_t xstart_r;
-   int_least32_t ystart_r;
-
-   uint_least16_t xi, yi;
-   uint_least8_t s0, s1, s2, s3;
-   uint_least32_t s01f, s23f, soutf;
-
-   xstep_c = (int_least32_t) round2int32(src_dest_w * (1<<AFFINEWARP_ISHIFT));
-   xstep_r = (int_least32_t) round2int32(0 * (1<<AFFINEWARP_ISHIFT));
-   ystep_c = (int_least32_t) round2int32(0 * (1<<AFFINEWARP_ISHIFT));
-   ystep_r = (int_least32_t) round2int32(src_dest_h * (1<<AFFINEWARP_ISHIFT));
+  uint16_t x0;
+  uint16_t x1;
+  uint16_t fx;                // Q10
+} resize_coef_t;
 
 
-   xstart_r = 0;
-   ystart_r = 0;
+static int32_t resizeGetStep(int32_t src_len, int32_t dst_len);
+static int32_t resizeGetStride(resize_image_t *p_img);
+static void    resizeMakeCoef(resize_image_t *src, int32_t x_step, int32_t col_begin, int32_t col_len);
+static void    resizeBilinear(resize_image_t *src, resize_image_t *dest, bool is_gray);
 
-   if (src->stride == 0)  src->stride  = src->w;
-   if (dest->stride == 0) dest->stride = dest->w;
 
-   if ((destw+dest->x) > dest->stride) destw = dest->stride - dest->x;
+static resize_coef_t coef_tbl[RESIZE_COL_MAX];
+static uint16_t      col_tbl[RESIZE_COL_MAX];
 
-   for (j=0; j<desth; j++)
-   {
-     xf = xstart_r;
-     yf = ystart_r;
 
-     yi = (uint_least16_t)(yf >> AFFINEWARP_ISHIFT);
 
-     line1 = (COLOR_DEPTH_TYPE *)&src->p_data[(yi)*src->stride];
-     line2 = (COLOR_DEPTH_TYPE *)&src->p_data[(yi+1)*src->stride];
-     dest_line = (COLOR_DEPTH_TYPE *)&dest->p_data[(j+dest->y)*(dest->stride) + dest->x];
 
-     for(i=0; i<destw; i++)
-     {
-       xi = (uint_least16_t)(xf >> AFFINEWARP_ISHIFT);
-       yi = (uint_least16_t)(yf >> AFFINEWARP_ISHIFT);
 
-       /* extract most significant 16 bits  */
-       cxf = (uint_least16_t)( (xf & AFFINEWARP_COEFFMASK) >> AFFINEWARP_QSHIFT);
-       cyf = (uint_least16_t)( (yf & AFFINEWARP_COEFFMASK) >> AFFINEWARP_QSHIFT);
-       oneminuscxf = 0xFFFF - cxf;
-       oneminuscyf = 0xFFFF - cyf;
-
-
-       s0 = GETR(line1[xi]);
-       s1 = GETR(line1[xi+1]);
-       s2 = GETR(line2[xi]);
-       s3 = GETR(line2[xi+1]);
-
-       // Interpolate
-       s01f  = oneminuscxf*s0 + cxf*s1;   // Interpolate points above
-       s23f  = oneminuscxf*s2 + cxf*s3;   // Interpolate points below
-
-       s01f >>= 8;
-       s23f >>= 8;
-       soutf = oneminuscyf*s01f + cyf*s23f; // Final interpolation
-       soutf = (soutf >> 24);
-       r = (uint_least8_t)soutf;
-
-
-       s0 = GETG(line1[xi]);
-       s1 = GETG(line1[xi+1]);
-       s2 = GETG(line2[xi]);
-       s3 = GETG(line2[xi+1]);
-
-       // Interpolate
-       s01f  = oneminuscxf*s0 + cxf*s1;   // Interpolate points above
-       s23f  = oneminuscxf*s2 + cxf*s3;   // Interpolate points below
+int32_t resizeGetStep(int32_t src_len, int32_t dst_len)
+{
+  // 양 끝 픽셀을 맞추는 (src-1)/(dst-1) 비율
+  if (dst_len <= 1 || src_len <= 1)
+  {
+    return 0;
+  }
+  return ((src_len - 1) << RESIZE_Q) / (dst_len - 1);
+}
 
-       s01f >>= 8;
-       s23f >>= 8;
-       soutf = oneminuscyf*s01f + cyf*s23f; // Final interpolation
-       soutf = (soutf >> 24);
-       g = (uint_least8_t)soutf;
+int32_t resizeGetStride(resize_image_t *p_img)
+{
+  return p_img->stride > 0 ? p_img->stride : p_img->w;
+}
 
+void resizeMakeCoef(resize_image_t *src, int32_t x_step, int32_t col_begin, int32_t col_len)
+{
+  uint32_t xf;
+  uint16_t x0;
 
-       s0 = GETB(line1[xi]);
-       s1 = GETB(line1[xi+1]);
-       s2 = GETB(line2[xi]);
-       s3 = GETB(line2[xi+1]);
+  for (int i=0; i<col_len; i++)
+  {
+    xf = (uint32_t)(col_begin + i) * x_step;
+    x0 = xf >> RESIZE_Q;
 
+    coef_tbl[i].x0 = x0;
+    coef_tbl[i].x1 = x0 < src->w - 1 ? x0 + 1 : x0;
+    coef_tbl[i].fx = (xf & 0xFFFF) >> (RESIZE_Q - RESIZE_W_Q);
+  }
+}
 
-       // Interpolate
-       s01f  = oneminuscxf*s0 + cxf*s1;   // Interpolate points above
-       s23f  = oneminuscxf*s2 + cxf*s3;   // Interpolate points below
+__attribute__((optimize("O2"))) void resizeBilinear(resize_image_t *src, resize_image_t *dest, bool is_gray)
+{
+  int32_t  destw = dest->w;
+  int32_t  desth = dest->h;
+  int32_t  stride_src = resizeGetStride(src);
+  int32_t  stride_dst = resizeGetStride(dest);
+  int32_t  x_step = resizeGetStep(src->w, dest->w);
+  int32_t  y_step = resizeGetStep(src->h, dest->h);
+  int32_t  col_len;
+  uint32_t yf;
+  uint16_t y0, y1;
+  uint32_t fx, fy;
+  uint32_t w00, w01, w10, w11;
+  uint16_t p00, p01, p10, p11;
+  uint32_t rb, g;
+  int32_t  left, right;
+
+  COLOR_DEPTH_TYPE *line0, *line1;
+  COLOR_DEPTH_TYPE *dest_line;
+  resize_coef_t    *p_coef;
+
+
+  if ((destw+dest->x) > stride_dst) destw = stride_dst - dest->x;
+
+  for (int col=0; col<destw; col+=RESIZE_COL_MAX)
+  {
+    col_len = destw - col;
+    if (col_len > RESIZE_COL_MAX)
+      col_len = RESIZE_COL_MAX;
 
-       s01f >>= 8;
-       s23f >>= 8;
-       soutf = oneminuscyf*s01f + cyf*s23f; // Final interpolation
-       soutf = (soutf >> 24);
-       b = (uint_least8_t)soutf;
+    resizeMakeCoef(src, x_step, col, col_len);
 
-       dest_line[i] = MAKECOL(r, g, b);
-       xf += xstep_c;
-       yf += ystep_c;
-     }
+    for (int j=0; j<desth; j++)
+    {
+      yf = (uint32_t)j * y_step;
+      y0 = yf >> RESIZE_Q;
+      y1 = y0 < src->h - 1 ? y0 + 1 : y0;
+      fy = (yf & 0xFFFF) >> (RESIZE_Q - RESIZE_W_Q);
+
+      line0     = (COLOR_DEPTH_TYPE *)&src->p_data[y0*stride_src];
+      line1     = (COLOR_DEPTH_TYPE *)&src->p_data[y1*stride_src];
+      dest_line = (COLOR_DEPTH_TYPE *)&dest->p_data[(j+dest->y)*stride_dst + dest->x + col];
+
+      p_coef = coef_tbl;
+
+      if (is_gray)
+      {
+        for (int i=0; i<col_len; i++, p_coef++)
+        {
+          fx  = p_coef->fx;
+          p00 = line0[p_coef->x0];
+          p10 = line0[p_coef->x1];
+          p01 = line1[p_coef->x0];
+          p11 = line1[p_coef->x1];
+
+          // 8bit 값이므로 세로, 가로 순서로 보간해도 32bit 를 넘지 않는다.
+          left  = p00*RESIZE_W_ONE + (p01 - p00)*(int32_t)fy;
+          right = p10*RESIZE_W_ONE + (p11 - p10)*(int32_t)fy;
+          dest_line[i] = (left*RESIZE_W_ONE + (right - left)*(int32_t)fx) >> (RESIZE_W_Q*2);
+        }
+        continue;
+      }
+
+      for (int i=0; i<col_len; i++, p_coef++)
+      {
+        fx = p_coef->fx;
+
+        // 네 점의 가중치 합이 항상 RESIZE_W_ONE 이 되도록 나눈다.
+        w11 = (fx * fy) >> RESIZE_W_Q;
+        w10 = fx - w11;
+        w01 = fy - w11;
+        w00 = RESIZE_W_ONE - fx - fy + w11;
+
+        p00 = line0[p_coef->x0];
+        p10 = line0[p_coef->x1];
+        p01 = line1[p_coef->x0];
+        p11 = line1[p_coef->x1];
+
+        rb = RB_PACK(p00)*w00 + RB_PACK(p10)*w10 + RB_PACK(p01)*w01 + RB_PACK(p11)*w11;
+        g  = G_PACK(p00)*w00  + G_PACK(p10)*w10  + G_PACK(p01)*w01  + G_PACK(p11)*w11;
+
+        rb = (rb >> RESIZE_W_Q) & RB_MASK;
+        g  = (g  >> RESIZE_W_Q);
+        dest_line[i] = RB_UNPACK(rb) | (g << 5);
+      }
+    }
+  }
+}
 
-     xstart_r += xstep_r;
-     ystart_r += ystep_r;
-   }
+void resizeImage(resize_image_t *src, resize_image_t *dest)
+{
+  resizeBilinear(src, dest, false);
 }
 
-__attribute__((optimize("O2"))) void resizeImageFastGray(resize_image_t *src, resize_image_t *dest)
+void resizeImageFast(resize_image_t *src, resize_image_t *dest)
 {
-  int destw = dest->w;
-  int desth = dest->h;
-  int i, j;
-  float src_dest_w = (float)(src->w-1)/(float)(dest->w-1);
-  float src_dest_h = (float)(src->h-1)/(float)(dest->h-1);
-  unsigned pixel;
-
-
-   COLOR_DEPTH_TYPE *line1, *line2;
-   COLOR_DEPTH_TYPE *dest_line;
-
-   int_least32_t xstep_c;
-   int_least32_t xstep_r;
-   int_least32_t ystep_c;
-   int_least32_t ystep_r;
-   int_least32_t xf, yf;
-   uint_least16_t cxf, cyf;
-   uint_least16_t oneminuscxf, oneminuscyf;
-   int_least32_t xstart_r;
-   int_least32_t ystart_r;
-
-   uint_least16_t xi, yi;
-   uint_least8_t s0, s1, s2, s3;
-   uint_least32_t s01f, s23f, soutf;
-
-   xstep_c = (int_least32_t) round2int32(src_dest_w * (1<<AFFINEWARP_ISHIFT));
-   xstep_r = (int_least32_t) round2int32(0 * (1<<AFFINEWARP_ISHIFT));
-   ystep_c = (int_least32_t) round2int32(0 * (1<<AFFINEWARP_ISHIFT));
-   ystep_r = (int_least32_t) round2int32(src_dest_h * (1<<AFFINEWARP_ISHIFT));
-
-
-   xstart_r = 0;
-   ystart_r = 0;
-
-   if (src->stride == 0)  src->stride  = src->w;
-   if (dest->stride == 0) dest->stride = dest->w;
-
-   if ((destw+dest->x) > dest->stride) destw = dest->stride - dest->x;
-
-   for (j=0; j<desth; j++)
-   {
-     xf = xstart_r;
-     yf = ystart_r;
-
-     yi = (uint_least16_t)(yf >> AFFINEWARP_ISHIFT);
-
-     line1 = (COLOR_DEPTH_TYPE *)&src->p_data[(yi)*src->stride];
-     line2 = (COLOR_DEPTH_TYPE *)&src->p_data[(yi+1)*src->stride];
-     dest_line = (COLOR_DEPTH_TYPE *)&dest->p_data[(j+dest->y)*(dest->stride) + dest->x];
-
-     for(i=0; i<destw; i++)
-     {
-       xi = (uint_least16_t)(xf >> AFFINEWARP_ISHIFT);
-       yi = (uint_least16_t)(yf >> AFFINEWARP_ISHIFT);
-
-       /* extract most significant 16 bits  */
-       cxf = (uint_least16_t)( (xf & AFFINEWARP_COEFFMASK) >> AFFINEWARP_QSHIFT);
-       cyf = (uint_least16_t)( (yf & AFFINEWARP_COEFFMASK) >> AFFINEWARP_QSHIFT);
-       oneminuscxf = 0xFFFF - cxf;
-       oneminuscyf = 0xFFFF - cyf;
-
-
-       s0 = line1[xi];
-       s1 = line1[xi+1];
-       s2 = line2[xi];
-       s3 = line2[xi+1];
-
-       // Interpolate
-       s01f  = oneminuscxf*s0 + cxf*s1;   // Interpolate points above
-       s23f  = oneminuscxf*s2 + cxf*s3;   // Interpolate points below
-
-       s01f >>= 8;
-       s23f >>= 8;
-       soutf = oneminuscyf*s01f + cyf*s23f; // Final interpolation
-       soutf = (soutf >> 24);
-       pixel = (uint_least8_t)soutf;
-
-       dest_line[i] = pixel;
-       xf += xstep_c;
-       yf += ystep_c;
-     }
-
-     xstart_r += xstep_r;
-     ystart_r += ystep_r;
-   }
+  resizeBilinear(src, dest, false);
 }
 
+void resizeImageFastGray(resize_image_t *src, resize_image_t *dest)
+{
+  resizeBilinear(src, dest, true);
+}
 
 __attribute__((optimize("O2"))) void resizeImageNearest(resize_image_t *src, resize_image_t *dest)
 {
   int x_ratio = (int)((src->w<<16)/dest->w) +1;
   int y_ratio = (int)((src->h<<16)/dest->h) +1;
-  int x2, y2;
+  int y2;
   int h2, w2;
-  int w1;
-  int stride_src;
-  int stride_dst;
+  int col_len;
+  int stride_src = resizeGetStride(src);
+  int stride_dst = resizeGetStride(dest);
+  uint16_t *p_src;
+  uint16_t *p_dst;
 
-  w1 = src->w;
   w2 = dest->w;
   h2 = dest->h;
 
-  if (dest->stride > 0)
-  {
-    stride_dst = dest->stride;
-  }
-  else
-  {
-    stride_dst = w2;
-  }
-  if (src->stride > 0)
-  {
-    stride_src = src->stride;
-  }
-  else
+
+  for (int col=0; col<w2; col+=RESIZE_COL_MAX)
   {
-    stride_src = w1;
-  }
+    col_len = w2 - col;
+    if (col_len > RESIZE_COL_MAX)
+      col_len = RESIZE_COL_MAX;
 
+    for (int j=0; j<col_len; j++)
+    {
+      col_tbl[j] = ((col+j)*x_ratio)>>16;
+    }
 
-  for (int i=0;i<h2;i++)
-  {
-    for (int j=0;j<w2;j++)
+    for (int i=0;i<h2;i++)
     {
-      x2 = ((j*x_ratio)>>16) ;
-      y2 = ((i*y_ratio)>>16) ;
-      dest->p_data[((i+dest->y)*stride_dst)+j+dest->x] = src->p_data[(y2*stride_src)+x2];
+      y2    = ((i*y_ratio)>>16);
+      p_src = &src->p_data[y2*stride_src];
+      p_dst = &dest->p_data[((i+dest->y)*stride_dst) + dest->x + col];
+
+      for (int j=0;j<col_len;j++)
+      {
+        p_dst[j] = p_src[col_tbl[j]];
+      }
     }
   }
 }
 
-
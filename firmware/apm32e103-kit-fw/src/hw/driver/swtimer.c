@@ -1,25 +1,51 @@
 #include "swtimer.h"
+#include "perf.h"
 
 
 #ifdef _USE_HW_SWTIMER
+#include "cli.h"
+
+
+//-- 실행중인 타이머는 만료 순서로 정렬된 delta list 로 관리한다.
+//   각 노드는 앞 노드로부터 남은 tick 만 가지고 있으므로 swtimerISR()는
+//   타이머 개수와 관계없이 리스트의 첫번째 노드만 감소시킨다.
+//   만료된 LOOP 타이머는 ISR 안에서 다시 정렬해 넣으므로 그 tick 은
+//   타이머 개수에 비례하는 시간이 든다. (software/fw-test swtimer_test)
+//
+#define SWTIMER_NONE      -1
+
 
 typedef struct
 {
+  bool          is_used;    // 핸들 할당 여부
   bool          timer_en;   // 타이머 인에이블 신호
+  bool          is_defer;   // true 이면 swtimerUpdate()에서 함수 실행
   SwtimerMode_t timer_mode; // 타이머 모드
-  uint32_t      timer_cnt;  // 현재의 타이머 값
-  uint32_t      timer_init; // 타이머 초기화될때의 카운트 값
+  uint32_t      timer_init; // 타이머 주기
+  uint32_t      timer_delta;// 앞 노드로부터 남은 tick
+  int16_t       next;       // delta list 다음 노드
+  int16_t       prev;       // delta list 이전 노드
+  uint32_t      expire_cnt; // 만료 횟수
   void (*tmr_func)(void *); // 만료될때 실행될 함수
   void *tmr_func_arg;       // 함수로 전달할 인수들
 } swtimer_t;
 
+
+#if CLI_USE(HW_SWTIMER)
+static void cliCmd(cli_args_t *args);
+#endif
+static void swtimerInitTimer(void);
+static void swtimerInsert(swtimer_handle_t handle, uint32_t ticks);
+static void swtimerRemove(swtimer_handle_t handle);
+static uint32_t swtimerLock(void);
+static void swtimerUnlock(uint32_t primask);
+
 static bool              is_init               = false;
 static volatile uint32_t sw_timer_counter      = 0;
-static volatile uint16_t sw_timer_handle_index = 0;
+static volatile uint32_t sw_timer_pending      = 0;     // 지연 실행할 타이머 비트
+static int16_t           sw_timer_head         = SWTIMER_NONE;
 static swtimer_t         swtimer_tbl[_HW_DEF_SW_TIMER_MAX]; // 타이머 배열 선언
 
-static void swtimerInitTimer(void);
-
 
 
 
@@ -39,16 +65,26 @@ bool swtimerInit(void)
   // 구조체 초기화
   for(i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
   {
-    swtimer_tbl[i].timer_en   = false;
-    swtimer_tbl[i].timer_cnt  = 0;
-    swtimer_tbl[i].timer_init = 0;
-    swtimer_tbl[i].tmr_func   = NULL;
+    swtimer_tbl[i].is_used     = false;
+    swtimer_tbl[i].timer_en    = false;
+    swtimer_tbl[i].is_defer    = false;
+    swtimer_tbl[i].timer_init  = 0;
+    swtimer_tbl[i].timer_delta = 0;
+    swtimer_tbl[i].next        = SWTIMER_NONE;
+    swtimer_tbl[i].prev        = SWTIMER_NONE;
+    swtimer_tbl[i].expire_cnt  = 0;
+    swtimer_tbl[i].tmr_func    = NULL;
   }
+  sw_timer_head    = SWTIMER_NONE;
+  sw_timer_pending = 0;
 
   is_init = true;
 
   swtimerInitTimer();
 
+#if CLI_USE(HW_SWTIMER)
+  cliAdd("swtimer", cliCmd);
+#endif
   return true;
 }
 
@@ -56,84 +92,280 @@ void swtimerInitTimer(void)
 {
 }
 
+uint32_t swtimerLock(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  return primask;
+}
+
+void swtimerUnlock(uint32_t primask)
+{
+  __set_PRIMASK(primask);
+}
+
+void swtimerInsert(swtimer_handle_t handle, uint32_t ticks)
+{
+  swtimer_t *p_tmr = &swtimer_tbl[handle];
+  int16_t prev = SWTIMER_NONE;
+  int16_t node = sw_timer_head;
+
+
+  if (ticks == 0)
+    ticks = 1;
+
+  // 같은 만료 시점이면 먼저 등록된 타이머 뒤에 넣는다.
+  while (node != SWTIMER_NONE && swtimer_tbl[node].timer_delta <= ticks)
+  {
+    ticks -= swtimer_tbl[node].timer_delta;
+    prev   = node;
+    node   = swtimer_tbl[node].next;
+  }
+
+  p_tmr->timer_delta = ticks;
+  p_tmr->prev        = prev;
+  p_tmr->next        = node;
+
+  if (node != SWTIMER_NONE)
+  {
+    swtimer_tbl[node].timer_delta -= ticks;
+    swtimer_tbl[node].prev = handle;
+  }
+
+  if (prev != SWTIMER_NONE)
+    swtimer_tbl[prev].next = handle;
+  else
+    sw_timer_head = handle;
+
+  p_tmr->timer_en = true;
+}
+
+void swtimerRemove(swtimer_handle_t handle)
+{
+  swtimer_t *p_tmr = &swtimer_tbl[handle];
+
+
+  if (p_tmr->timer_en != true)
+    return;
+
+  if (p_tmr->next != SWTIMER_NONE)
+  {
+    swtimer_tbl[p_tmr->next].timer_delta += p_tmr->timer_delta;
+    swtimer_tbl[p_tmr->next].prev = p_tmr->prev;
+  }
+
+  if (p_tmr->prev != SWTIMER_NONE)
+    swtimer_tbl[p_tmr->prev].next = p_tmr->next;
+  else
+    sw_timer_head = p_tmr->next;
+
+  p_tmr->next     = SWTIMER_NONE;
+  p_tmr->prev     = SWTIMER_NONE;
+  p_tmr->timer_en = false;
+}
+
 void swtimerISR(void)
 {
-  uint8_t i;
+  PERF_SCOPE("swtimerISR");
+  swtimer_handle_t handle;
+  swtimer_t *p_tmr;
 
 
   sw_timer_counter++;
 
+  if (sw_timer_head == SWTIMER_NONE)
+    return;
+
+  swtimer_tbl[sw_timer_head].timer_delta--;
 
-  for (i=0; i<_HW_DEF_SW_TIMER_MAX && i<sw_timer_handle_index; i++)   
+  while (sw_timer_head != SWTIMER_NONE && swtimer_tbl[sw_timer_head].timer_delta == 0)
   {
-    if ( swtimer_tbl[i].timer_en == true)                       
+    handle = sw_timer_head;
+    p_tmr  = &swtimer_tbl[handle];
+
+    swtimerRemove(handle);
+
+    // 콜백에서 swtimerStop()을 호출할 수 있도록 먼저 다시 등록한다.
+    if (p_tmr->timer_mode == LOOP_TIME)
     {
-      swtimer_tbl[i].timer_cnt--;                               
+      swtimerInsert(handle, p_tmr->timer_init);
+    }
+    p_tmr->expire_cnt++;
 
-      if (swtimer_tbl[i].timer_cnt == 0)                        
-      {
-        if(swtimer_tbl[i].timer_mode == ONE_TIME)               
-        {
-          swtimer_tbl[i].timer_en = false;                       
-        }
+    if (p_tmr->is_defer == true)
+    {
+      sw_timer_pending |= (1UL<<handle);
+    }
+    else if (p_tmr->tmr_func != NULL)
+    {
+      (*p_tmr->tmr_func)(p_tmr->tmr_func_arg);
+    }
+  }
+}
+
+void swtimerUpdate(void)
+{
+  uint32_t primask;
+  uint32_t pending;
+
+
+  if (sw_timer_pending == 0)
+    return;
 
-        swtimer_tbl[i].timer_cnt = swtimer_tbl[i].timer_init;   
+  primask = swtimerLock();
+  pending = sw_timer_pending;
+  sw_timer_pending = 0;
+  swtimerUnlock(primask);
 
-        (*swtimer_tbl[i].tmr_func)(swtimer_tbl[i].tmr_func_arg);  
-      }
+  for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+  {
+    if ((pending & (1UL<<i)) && swtimer_tbl[i].tmr_func != NULL)
+    {
+      (*swtimer_tbl[i].tmr_func)(swtimer_tbl[i].tmr_func_arg);
     }
   }
 }
 
 void swtimerSet(swtimer_handle_t handle, uint32_t period_ms, SwtimerMode_t mode, void (*Fnct)(void *), void *arg)
 {
-  if(handle < 0) return;
+  uint32_t primask;
+
+  if(handle < 0 || handle >= _HW_DEF_SW_TIMER_MAX) return;
+
+  primask = swtimerLock();
+  swtimerRemove(handle);
+  swtimer_tbl[handle].timer_mode   = mode;
+  swtimer_tbl[handle].tmr_func     = Fnct;
+  swtimer_tbl[handle].tmr_func_arg = arg;
+  swtimer_tbl[handle].timer_init   = period_ms;
+  swtimerUnlock(primask);
+}
+
+void swtimerSetDefer(swtimer_handle_t handle, bool enable)
+{
+  if(handle < 0 || handle >= _HW_DEF_SW_TIMER_MAX) return;
 
-  swtimer_tbl[handle].timer_mode = mode;    
-  swtimer_tbl[handle].tmr_func   = Fnct;       
-  swtimer_tbl[handle].tmr_func_arg = arg;        
-  swtimer_tbl[handle].timer_cnt  = period_ms;
-  swtimer_tbl[handle].timer_init = period_ms;
+  swtimer_tbl[handle].is_defer = enable;
 }
 
 void swtimerStart(swtimer_handle_t handle)
 {
-  if(handle < 0) return;
+  uint32_t primask;
+
+  if(handle < 0 || handle >= _HW_DEF_SW_TIMER_MAX) return;
 
-  swtimer_tbl[handle].timer_cnt = swtimer_tbl[handle].timer_init;
-  swtimer_tbl[handle].timer_en  = true;
+  primask = swtimerLock();
+  swtimerRemove(handle);
+  swtimerInsert(handle, swtimer_tbl[handle].timer_init);
+  swtimerUnlock(primask);
 }
 
 void swtimerStop (swtimer_handle_t handle)
 {
-  if(handle < 0) return;
+  uint32_t primask;
+
+  if(handle < 0 || handle >= _HW_DEF_SW_TIMER_MAX) return;
 
-  swtimer_tbl[handle].timer_en = false;
+  primask = swtimerLock();
+  swtimerRemove(handle);
+  sw_timer_pending &= ~(1UL<<handle);
+  swtimerUnlock(primask);
 }
 
 void swtimerReset(swtimer_handle_t handle)
 {
-  if(handle < 0) return;
-
-  swtimer_tbl[handle].timer_en   = false;
-  swtimer_tbl[handle].timer_cnt  = swtimer_tbl[handle].timer_init;
+  swtimerStop(handle);
 }
 
 swtimer_handle_t swtimerGetHandle(void)
 {
-  swtimer_handle_t tmr_index = sw_timer_handle_index;
+  swtimer_handle_t tmr_index = -1;
+  uint32_t primask;
 
-  if (tmr_index < _HW_DEF_SW_TIMER_MAX)
-    sw_timer_handle_index++;
-  else
-    tmr_index = -1;
+
+  primask = swtimerLock();
+  for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+  {
+    if (swtimer_tbl[i].is_used != true)
+    {
+      swtimer_tbl[i].is_used    = true;
+      swtimer_tbl[i].is_defer   = false;
+      swtimer_tbl[i].expire_cnt = 0;
+      swtimer_tbl[i].tmr_func   = NULL;
+      tmr_index = i;
+      break;
+    }
+  }
+  swtimerUnlock(primask);
 
   return tmr_index;
 }
 
+bool swtimerReleaseHandle(swtimer_handle_t handle)
+{
+  if(handle < 0 || handle >= _HW_DEF_SW_TIMER_MAX) return false;
+
+  swtimerStop(handle);
+  swtimer_tbl[handle].tmr_func = NULL;
+  swtimer_tbl[handle].is_used  = false;
+
+  return true;
+}
+
 uint32_t swtimerGetCounter(void)
 {
   return sw_timer_counter;
 }
 
+
+#if CLI_USE(HW_SWTIMER)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    uint32_t remain[_HW_DEF_SW_TIMER_MAX] = {0, };
+    uint32_t primask;
+    uint32_t sum = 0;
+    int16_t  node;
+
+    primask = swtimerLock();
+    node = sw_timer_head;
+    while (node != SWTIMER_NONE)
+    {
+      sum += swtimer_tbl[node].timer_delta;
+      remain[node] = sum;
+      node = swtimer_tbl[node].next;
+    }
+    swtimerUnlock(primask);
+
+    cliPrintf("counter : %d\n", swtimerGetCounter());
+    cliPrintf("ch en mode defer   period   remain   expire\n");
+    for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+    {
+      if (swtimer_tbl[i].is_used != true)
+        continue;
+
+      cliPrintf("%2d %s %s  %s %8d %8d %8d\n",
+                i,
+                swtimer_tbl[i].timer_en ? "ON ":"OFF",
+                swtimer_tbl[i].timer_mode == ONE_TIME ? "ONE ":"LOOP",
+                swtimer_tbl[i].is_defer ? "MAIN":"ISR ",
+                swtimer_tbl[i].timer_init,
+                remain[i],
+                swtimer_tbl[i].expire_cnt);
+    }
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("swtimer info\n");
+  }
+}
+#endif
+
 #endif
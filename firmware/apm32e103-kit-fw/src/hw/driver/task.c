@@ -0,0 +1,457 @@
+#include "task.h"
+
+
+#ifdef _USE_HW_TASK
+#include "cli.h"
+
+
+typedef struct
+{
+  const char   *name;
+  TaskMode_t    mode;
+  uint8_t       priority;
+  uint32_t      period_ms;
+  uint32_t      deadline_us;
+  void        (*func)(void);
+
+  volatile bool is_ready;
+  uint32_t      release_us;   // 실행 가능해진 시점
+  uint32_t      next_ms;      // 다음 주기 시점
+
+  uint32_t      run_cnt;
+  uint32_t      overrun_cnt;  // 한 주기 이상 밀려서 건너뛴 횟수
+  uint32_t      miss_cnt;     // deadline 을 넘긴 횟수
+  uint32_t      exe_min;
+  uint32_t      exe_max;
+  uint64_t      exe_sum;
+} task_t;
+
+
+#if CLI_USE(HW_TASK)
+static void cliCmd(cli_args_t *args);
+#endif
+static void taskRun(task_t *p_task);
+static void taskStartRound(void);
+static bool taskIsPending(uint32_t cur_ms);
+static void taskUpdateLoad(void);
+
+static bool is_init = false;
+static uint32_t task_count = 0;
+static task_t task_tbl[TASK_MAX_CH];
+
+static bool        is_sleep     = true;
+static volatile bool is_round_busy = true;   // 이번 라운드에 할 일이 있었는지
+static uint32_t    load_pre_us  = 0;
+static uint32_t    load_idle_us = 0;
+static task_load_t task_load;
+
+
+
+
+
+bool taskInit(void)
+{
+  task_count = 0;
+
+  memset(&task_load, 0, sizeof(task_load));
+  load_pre_us  = micros();
+  load_idle_us = 0;
+
+  // WFI 상태에서도 디버거 연결이 끊어지지 않도록 한다.
+  DBGMCU->CFG_B.SLEEP_CLK_STS = 1;
+
+  is_init = true;
+
+#if CLI_USE(HW_TASK)
+  cliAdd("task", cliCmd);
+#endif
+  return true;
+}
+
+task_handle_t taskAdd(const char *name, void (*func)(void), uint8_t priority, TaskMode_t mode, uint32_t period_ms, uint32_t deadline_us)
+{
+  task_t *p_task;
+
+
+  if (is_init != true || task_count >= TASK_MAX_CH || func == NULL)
+    return -1;
+
+  p_task = &task_tbl[task_count];
+
+  p_task->name        = name;
+  p_task->mode        = mode;
+  p_task->priority    = priority;
+  p_task->period_ms   = period_ms;
+  p_task->deadline_us = deadline_us;
+  p_task->func        = func;
+
+  p_task->is_ready    = false;
+  p_task->release_us  = micros();
+  p_task->next_ms     = millis() + period_ms;
+
+  p_task->run_cnt     = 0;
+  p_task->overrun_cnt = 0;
+  p_task->miss_cnt    = 0;
+  p_task->exe_min     = 0xFFFFFFFF;
+  p_task->exe_max     = 0;
+  p_task->exe_sum     = 0;
+
+  task_count++;
+
+  return task_count - 1;
+}
+
+void taskSignal(task_handle_t handle)
+{
+  task_t *p_task;
+
+  if (handle < 0 || handle >= task_count)
+    return;
+
+  p_task = &task_tbl[handle];
+  if (p_task->is_ready != true)
+  {
+    p_task->release_us = micros();
+    p_task->is_ready   = true;
+  }
+  if (p_task->mode == TASK_MODE_LOOP)
+  {
+    is_round_busy = true;
+  }
+}
+
+// LOOP 태스크가 일을 했으면 호출한다.
+// 라운드에서 아무도 호출하지 않으면 다음 라운드는 잠에서 깬 뒤에 시작한다.
+//
+void taskSetBusy(void)
+{
+  is_round_busy = true;
+}
+
+bool taskUpdate(void)
+{
+  task_t  *p_run = NULL;
+  uint32_t cur_ms;
+  bool     is_loop_ready = false;
+
+
+  if (is_init != true)
+    return false;
+
+  cur_ms = millis();
+
+  // LOOP 태스크가 모두 한번씩 실행되면 다음 라운드를 시작한다.
+  // 다른 태스크가 계속 준비되어 있어도 LOOP 태스크는 매 라운드 실행된다.
+  // 할 일이 없었던 라운드 뒤에는 taskIdle()에서 깰 때까지 시작하지 않는다.
+  //
+  for (int i=0; i<task_count; i++)
+  {
+    if (task_tbl[i].mode == TASK_MODE_LOOP && task_tbl[i].is_ready == true)
+    {
+      is_loop_ready = true;
+      break;
+    }
+  }
+  if (is_loop_ready != true && is_round_busy == true)
+  {
+    is_round_busy = false;
+    taskStartRound();
+  }
+
+  for (int i=0; i<task_count; i++)
+  {
+    task_t *p_task = &task_tbl[i];
+
+    if (p_task->mode == TASK_MODE_PERIOD && p_task->is_ready != true)
+    {
+      if ((int32_t)(cur_ms - p_task->next_ms) >= 0)
+      {
+        p_task->release_us = micros();
+        p_task->is_ready   = true;
+
+        p_task->next_ms += p_task->period_ms;
+        if ((int32_t)(cur_ms - p_task->next_ms) >= 0)
+        {
+          // 한 주기 이상 밀린 경우는 현재 시간 기준으로 다시 맞춘다.
+          p_task->next_ms = cur_ms + p_task->period_ms;
+          p_task->overrun_cnt++;
+        }
+      }
+    }
+
+    if (p_task->is_ready == true)
+    {
+      if (p_run == NULL || p_task->priority < p_run->priority)
+      {
+        p_run = p_task;
+      }
+    }
+  }
+
+  if (p_run == NULL)
+  {
+    return false;
+  }
+
+  taskRun(p_run);
+
+  return true;
+}
+
+void taskStartRound(void)
+{
+  uint32_t cur_us = micros();
+
+  for (int i=0; i<task_count; i++)
+  {
+    if (task_tbl[i].mode == TASK_MODE_LOOP)
+    {
+      task_tbl[i].release_us = cur_us;
+      task_tbl[i].is_ready   = true;
+    }
+  }
+}
+
+void taskRun(task_t *p_task)
+{
+  uint32_t pre_us;
+  uint32_t exe_us;
+  uint32_t end_us;
+
+
+  p_task->is_ready = false;
+
+  // EVENT/PERIOD 태스크가 만든 일을 LOOP 태스크가 처리할 수 있도록
+  // 한 라운드를 더 돌린다.
+  if (p_task->mode != TASK_MODE_LOOP)
+    is_round_busy = true;
+
+  pre_us = micros();
+  p_task->func();
+  end_us = micros();
+  exe_us = end_us - pre_us;
+
+  p_task->run_cnt++;
+  p_task->exe_sum += exe_us;
+  if (exe_us < p_task->exe_min)
+    p_task->exe_min = exe_us;
+  if (exe_us > p_task->exe_max)
+    p_task->exe_max = exe_us;
+
+  if (p_task->deadline_us > 0 && end_us - p_task->release_us > p_task->deadline_us)
+  {
+    p_task->miss_cnt++;
+  }
+}
+
+bool taskIsPending(uint32_t cur_ms)
+{
+  for (int i=0; i<task_count; i++)
+  {
+    task_t *p_task = &task_tbl[i];
+
+    if (p_task->is_ready == true)
+      return true;
+
+    if (p_task->mode == TASK_MODE_PERIOD && (int32_t)(cur_ms - p_task->next_ms) >= 0)
+      return true;
+  }
+
+  return false;
+}
+
+void taskIdle(void)
+{
+  uint32_t pre_us;
+  uint32_t cur_ms;
+  uint32_t primask;
+
+
+  if (is_init != true)
+    return;
+
+  // 준비된 태스크가 없으면 다음 tick 이나 인터럽트까지 쉰다.
+  // 인터럽트를 막은 상태에서 확인하고 WFI 에 들어가야 그 사이의 신호를 놓치지 않는다.
+  // 깨어나면 인터럽트가 만든 일을 처리하도록 LOOP 라운드를 다시 시작한다.
+  //
+  pre_us = micros();
+  cur_ms = millis();
+
+  if (is_sleep == true)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (taskIsPending(cur_ms) != true)
+    {
+      __DSB();
+      __WFI();
+      task_load.sleep_cnt++;
+    }
+    __set_PRIMASK(primask);
+  }
+  else
+  {
+    while(millis() == cur_ms && taskIsPending(cur_ms) != true)
+    {
+    }
+  }
+
+  is_round_busy = true;
+  load_idle_us += micros() - pre_us;
+
+  taskUpdateLoad();
+}
+
+void taskUpdateLoad(void)
+{
+  uint32_t cur_us;
+  uint32_t elapsed_us;
+  uint32_t idle_us;
+
+
+  cur_us     = micros();
+  elapsed_us = cur_us - load_pre_us;
+  if (elapsed_us < 1000000)
+    return;
+
+  idle_us = load_idle_us < elapsed_us ? load_idle_us : elapsed_us;
+
+  task_load.busy_us = elapsed_us - idle_us;
+  task_load.idle_us = idle_us;
+  task_load.load    = (uint16_t)((uint64_t)task_load.busy_us * 1000 / elapsed_us);
+  if (task_load.load > task_load.load_max)
+    task_load.load_max = task_load.load;
+
+  load_pre_us  = cur_us;
+  load_idle_us = 0;
+}
+
+void taskSetSleep(bool enable)
+{
+  is_sleep = enable;
+}
+
+bool taskGetLoad(task_load_t *p_load)
+{
+  if (is_init != true)
+    return false;
+
+  *p_load = task_load;
+  return true;
+}
+
+uint32_t taskGetCount(void)
+{
+  return task_count;
+}
+
+bool taskGetInfo(task_handle_t handle, task_info_t *p_info)
+{
+  task_t *p_task;
+
+  if (handle < 0 || handle >= task_count)
+    return false;
+
+  p_task = &task_tbl[handle];
+
+  p_info->name        = p_task->name;
+  p_info->mode        = p_task->mode;
+  p_info->priority    = p_task->priority;
+  p_info->period_ms   = p_task->period_ms;
+  p_info->deadline_us = p_task->deadline_us;
+  p_info->run_cnt     = p_task->run_cnt;
+  p_info->overrun_cnt = p_task->overrun_cnt;
+  p_info->miss_cnt    = p_task->miss_cnt;
+  p_info->exe_min     = p_task->run_cnt > 0 ? p_task->exe_min : 0;
+  p_info->exe_avg     = p_task->run_cnt > 0 ? (uint32_t)(p_task->exe_sum / p_task->run_cnt) : 0;
+  p_info->exe_max     = p_task->exe_max;
+
+  return true;
+}
+
+void taskClearInfo(void)
+{
+  for (int i=0; i<task_count; i++)
+  {
+    task_tbl[i].run_cnt     = 0;
+    task_tbl[i].overrun_cnt = 0;
+    task_tbl[i].miss_cnt    = 0;
+    task_tbl[i].exe_min  = 0xFFFFFFFF;
+    task_tbl[i].exe_max  = 0;
+    task_tbl[i].exe_sum  = 0;
+  }
+  task_load.load_max  = 0;
+  task_load.sleep_cnt = 0;
+}
+
+
+#if CLI_USE(HW_TASK)
+void cliCmd(cli_args_t *args)
+{
+  bool ret = false;
+
+
+  if (args->argc == 1 && args->isStr(0, "info"))
+  {
+    const char *mode_str[] = {"LOOP  ", "PERIOD", "EVENT "};
+    task_info_t info;
+
+    cliPrintf("name       mode   pri period deadline      run  overrun   miss  min(us)  avg(us)  max(us)\n");
+    for (int i=0; i<task_count; i++)
+    {
+      taskGetInfo(i, &info);
+      cliPrintf("%-10s %s %3d %6d %8d %8d %8d %6d %8d %8d %8d\n",
+                info.name,
+                mode_str[info.mode],
+                info.priority,
+                info.period_ms,
+                info.deadline_us,
+                info.run_cnt,
+                info.overrun_cnt,
+                info.miss_cnt,
+                info.exe_min,
+                info.exe_avg,
+                info.exe_max);
+    }
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "load"))
+  {
+    task_load_t load;
+
+    // CLI 도 태스크에서 실행되므로 반복 출력하지 않고 최근 1초 값만 보여준다.
+    taskGetLoad(&load);
+    cliPrintf("sleep    : %s\n", is_sleep ? "On":"Off");
+    cliPrintf("load     : %d.%d %%\n", load.load/10, load.load%10);
+    cliPrintf("load max : %d.%d %%\n", load.load_max/10, load.load_max%10);
+    cliPrintf("busy     : %d us\n", load.busy_us);
+    cliPrintf("idle     : %d us\n", load.idle_us);
+    cliPrintf("sleep cnt: %d\n", load.sleep_cnt);
+    ret = true;
+  }
+
+  if (args->argc == 2 && args->isStr(0, "sleep"))
+  {
+    taskSetSleep(args->isStr(1, "on"));
+    cliPrintf("sleep : %s\n", is_sleep ? "On":"Off");
+    ret = true;
+  }
+
+  if (args->argc == 1 && args->isStr(0, "clear"))
+  {
+    taskClearInfo();
+    ret = true;
+  }
+
+  if (ret == false)
+  {
+    cliPrintf("task info\n");
+    cliPrintf("task load\n");
+    cliPrintf("task sleep on:off\n");
+    cliPrintf("task clear\n");
+  }
+}
+#endif
+
+#endif
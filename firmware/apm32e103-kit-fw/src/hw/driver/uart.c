@@ -1,4 +1,5 @@
 #include "uart.h"
+#include "mem.h"
 
 #ifdef _USE_HW_UART
 #include "qbuffer.h"
@@ -9,6 +10,7 @@
 
 
 #define UART_RX_BUF_LENGTH        1024
+#define UART_TX_BUF_LENGTH        1024
 
 
 typedef struct
@@ -17,6 +19,13 @@ typedef struct
   USART_T            *p_uart;
   USART_Config_T     *p_cfg;
   DMA_Channel_T      *p_hdma_rx;
+  DMA_Channel_T      *p_hdma_tx;
+  IRQn_Type           irq;
+  IRQn_Type           rx_irq;
+  IRQn_Type           tx_irq;
+  DMA_INT_FLAG_T      rx_flag_ht;
+  DMA_INT_FLAG_T      rx_flag_tc;
+  DMA_INT_FLAG_T      tx_flag_tc;
 } uart_hw_t;
 
 
@@ -29,8 +38,18 @@ typedef struct
   qbuffer_t qbuffer;
   uart_hw_t *p_hw;
 
+  //-- TX 링버퍼는 tx_in 에서 채우고 DMA 가 tx_out 부터 보낸다.
+  //
+  uint8_t           tx_buf[UART_TX_BUF_LENGTH];
+  volatile uint32_t tx_in;
+  volatile uint32_t tx_out;
+  volatile uint32_t tx_dma_len;
+
   uint32_t rx_cnt;
   uint32_t tx_cnt;
+  uint32_t rx_overrun;
+
+  void (*rx_func)(uint8_t ch, uint32_t length);
 } uart_tbl_t;
 
 
@@ -41,6 +60,12 @@ typedef struct
 static void cliUart(cli_args_t *args);
 #endif
 static bool uartInitHw(uint8_t ch);
+static void uartInitTxDma(uint8_t ch);
+static void uartTxStart(uint8_t ch);
+static void uartTxISR(uint8_t ch);
+static void uartRxISR(uint8_t ch);
+static void uartIrqISR(uint8_t ch);
+static void uartDmaRxISR(uint8_t ch);
 
 
 static bool is_init = false;
@@ -53,9 +78,9 @@ static USART_Config_T uart2_cfg;
 
 const static uart_hw_t uart_hw_tbl[UART_MAX_CH] = 
   {
-    {"USART1 SWD   ", USART1, &uart1_cfg, DMA1_Channel5},
-    {"USB CDC      ", NULL  , NULL,       NULL         },
-    {"USART2 EXT   ", USART2, &uart2_cfg, DMA1_Channel6},
+    {"USART1 SWD   ", USART1, &uart1_cfg, DMA1_Channel5, DMA1_Channel4, USART1_IRQn, DMA1_Channel5_IRQn, DMA1_Channel4_IRQn, DMA1_INT_FLAG_HT5, DMA1_INT_FLAG_TC5, DMA1_INT_FLAG_TC4},
+    {"USB CDC      ", NULL  , NULL,       NULL,          NULL,          (IRQn_Type)0, (IRQn_Type)0,     (IRQn_Type)0,     (DMA_INT_FLAG_T)0, (DMA_INT_FLAG_T)0, (DMA_INT_FLAG_T)0},
+    {"USART2 EXT   ", USART2, &uart2_cfg, DMA1_Channel6, DMA1_Channel7, USART2_IRQn, DMA1_Channel6_IRQn, DMA1_Channel7_IRQn, DMA1_INT_FLAG_HT6, DMA1_INT_FLAG_TC6, DMA1_INT_FLAG_TC7},
   };
 
 
@@ -70,7 +95,13 @@ bool uartInit(void)
     uart_tbl[i].baud = 57600;
     uart_tbl[i].rx_cnt = 0;
     uart_tbl[i].tx_cnt = 0;    
+    uart_tbl[i].tx_in  = 0;
+    uart_tbl[i].tx_out = 0;
+    uart_tbl[i].tx_dma_len = 0;
+    uart_tbl[i].rx_overrun = 0;
+    uart_tbl[i].rx_func = NULL;
   }
+  MEM_BUF_ADD("uart", uart_tbl);
 
   is_init = true;
 
@@ -127,7 +158,7 @@ bool uartOpen(uint8_t ch, uint32_t baud)
       USART_Config(uart_tbl[ch].p_hw->p_uart, uart_tbl[ch].p_hw->p_cfg);
       USART_Enable(uart_tbl[ch].p_hw->p_uart);
 
-      USART_EnableDMA(uart_tbl[ch].p_hw->p_uart, USART_DMA_RX);
+      USART_EnableDMA(uart_tbl[ch].p_hw->p_uart, USART_DMA_TX_RX);
 
       ret = true;
       uart_tbl[ch].is_open = true;
@@ -135,6 +166,13 @@ bool uartOpen(uint8_t ch, uint32_t baud)
 
       uart_tbl[ch].qbuffer.in  = uart_tbl[ch].qbuffer.len - uart_tbl[ch].p_hw->p_hdma_rx->CHNDATA_B.NDATA;
       uart_tbl[ch].qbuffer.out = uart_tbl[ch].qbuffer.in;
+
+      // 수신 위치는 IDLE, DMA HT/TC 인터럽트에서 갱신한다.
+      //
+      DMA_EnableInterrupt(uart_tbl[ch].p_hw->p_hdma_rx, DMA_INT_HT | DMA_INT_TC);
+      USART_EnableInterrupt(uart_tbl[ch].p_hw->p_uart, USART_INT_IDLE);
+      NVIC_EnableIRQRequest(uart_tbl[ch].p_hw->rx_irq, 1, 0);
+      NVIC_EnableIRQRequest(uart_tbl[ch].p_hw->irq, 1, 0);
       break;
 
     case _DEF_UART2:
@@ -202,6 +240,7 @@ bool uartInitHw(uint8_t ch)
 
       /* Enable DMA */
       DMA_Enable(uart_tbl[ch].p_hw->p_hdma_rx);
+      uartInitTxDma(ch);
       break;
 
     case _DEF_UART3:
@@ -241,6 +280,7 @@ bool uartInitHw(uint8_t ch)
 
       /* Enable DMA */
       DMA_Enable(uart_tbl[ch].p_hw->p_hdma_rx);
+      uartInitTxDma(ch);
       break;
 
     default:
@@ -251,6 +291,170 @@ bool uartInitHw(uint8_t ch)
   return ret;
 }
 
+void uartInitTxDma(uint8_t ch)
+{
+  DMA_Config_T dmaConfig;
+
+
+  uart_tbl[ch].tx_in      = 0;
+  uart_tbl[ch].tx_out     = 0;
+  uart_tbl[ch].tx_dma_len = 0;
+
+  DMA_Disable(uart_tbl[ch].p_hw->p_hdma_tx);
+
+  dmaConfig.peripheralBaseAddr = (uint32_t)&uart_tbl[ch].p_hw->p_uart->DATA;
+  dmaConfig.memoryBaseAddr     = (uint32_t)uart_tbl[ch].tx_buf;
+  dmaConfig.dir                = DMA_DIR_PERIPHERAL_DST;
+  dmaConfig.bufferSize         = 0;
+  dmaConfig.peripheralInc      = DMA_PERIPHERAL_INC_DISABLE;
+  dmaConfig.memoryInc          = DMA_MEMORY_INC_ENABLE;
+  dmaConfig.peripheralDataSize = DMA_PERIPHERAL_DATA_SIZE_BYTE;
+  dmaConfig.memoryDataSize     = DMA_MEMORY_DATA_SIZE_BYTE;
+  dmaConfig.loopMode           = DMA_MODE_NORMAL;
+  dmaConfig.priority           = DMA_PRIORITY_LOW;
+  dmaConfig.M2M                = DMA_M2MEN_DISABLE;
+  DMA_Config(uart_tbl[ch].p_hw->p_hdma_tx, &dmaConfig);
+
+  DMA_EnableInterrupt(uart_tbl[ch].p_hw->p_hdma_tx, DMA_INT_TC);
+  NVIC_EnableIRQRequest(uart_tbl[ch].p_hw->tx_irq, 1, 0);
+}
+
+void uartTxStart(uint8_t ch)
+{
+  uart_tbl_t *p_uart = &uart_tbl[ch];
+  uint32_t primask;
+  uint32_t len;
+
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (p_uart->tx_dma_len == 0 && p_uart->tx_in != p_uart->tx_out)
+  {
+    // 링버퍼 끝에서 나뉘는 경우는 TC 인터럽트에서 나머지를 이어서 보낸다.
+    if (p_uart->tx_in > p_uart->tx_out)
+      len = p_uart->tx_in - p_uart->tx_out;
+    else
+      len = UART_TX_BUF_LENGTH - p_uart->tx_out;
+
+    p_uart->tx_dma_len = len;
+
+    DMA_Disable(p_uart->p_hw->p_hdma_tx);
+    p_uart->p_hw->p_hdma_tx->CHMADDR = (uint32_t)&p_uart->tx_buf[p_uart->tx_out];
+    DMA_ConfigDataNumber(p_uart->p_hw->p_hdma_tx, len);
+    DMA_Enable(p_uart->p_hw->p_hdma_tx);
+  }
+
+  __set_PRIMASK(primask);
+}
+
+void uartTxISR(uint8_t ch)
+{
+  uart_tbl_t *p_uart = &uart_tbl[ch];
+
+  if (DMA_ReadIntFlag(p_uart->p_hw->tx_flag_tc))
+  {
+    DMA_ClearIntFlag(p_uart->p_hw->tx_flag_tc);
+
+    p_uart->tx_out     = (p_uart->tx_out + p_uart->tx_dma_len) % UART_TX_BUF_LENGTH;
+    p_uart->tx_dma_len = 0;
+
+    uartTxStart(ch);
+  }
+}
+
+void uartRxISR(uint8_t ch)
+{
+  uart_tbl_t *p_uart = &uart_tbl[ch];
+  qbuffer_t  *p_q = &p_uart->qbuffer;
+  uint32_t in;
+  uint32_t rx_len;
+  uint32_t rx_used;
+
+
+  in = (p_q->len - p_uart->p_hw->p_hdma_rx->CHNDATA_B.NDATA) % p_q->len;
+
+  rx_len = (in + p_q->len - p_q->in) % p_q->len;
+  if (rx_len == 0)
+    return;
+
+  // 읽지 않은 데이터 위에 DMA 가 덮어쓴 경우
+  rx_used = (p_q->in + p_q->len - p_q->out) % p_q->len;
+  if (rx_used + rx_len >= p_q->len)
+  {
+    p_uart->rx_overrun++;
+  }
+  p_q->in = in;
+
+  if (p_uart->rx_func != NULL)
+  {
+    p_uart->rx_func(ch, rx_len);
+  }
+}
+
+void uartIrqISR(uint8_t ch)
+{
+  USART_T *p_usart = uart_tbl[ch].p_hw->p_uart;
+  uint16_t sts;
+
+  sts = p_usart->STS;
+  if (sts & (USART_FLAG_IDLE | USART_FLAG_OVRE))
+  {
+    // STS 후 DATA 를 읽어야 IDLE/OVRE 가 지워진다.
+    (void)p_usart->DATA;
+
+    if (sts & USART_FLAG_OVRE)
+    {
+      uart_tbl[ch].rx_overrun++;
+    }
+    uartRxISR(ch);
+  }
+}
+
+void uartDmaRxISR(uint8_t ch)
+{
+  uart_hw_t *p_hw = uart_tbl[ch].p_hw;
+
+  if (DMA_ReadIntFlag(p_hw->rx_flag_ht))
+  {
+    DMA_ClearIntFlag(p_hw->rx_flag_ht);
+  }
+  if (DMA_ReadIntFlag(p_hw->rx_flag_tc))
+  {
+    DMA_ClearIntFlag(p_hw->rx_flag_tc);
+  }
+  uartRxISR(ch);
+}
+
+void USART1_IRQHandler(void)
+{
+  uartIrqISR(_DEF_UART1);
+}
+
+void USART2_IRQHandler(void)
+{
+  uartIrqISR(_DEF_UART3);
+}
+
+void DMA1_Channel5_IRQHandler(void)
+{
+  uartDmaRxISR(_DEF_UART1);
+}
+
+void DMA1_Channel6_IRQHandler(void)
+{
+  uartDmaRxISR(_DEF_UART3);
+}
+
+void DMA1_Channel4_IRQHandler(void)
+{
+  uartTxISR(_DEF_UART1);
+}
+
+void DMA1_Channel7_IRQHandler(void)
+{
+  uartTxISR(_DEF_UART3);
+}
 
 uint32_t uartAvailable(uint8_t ch)
 {
@@ -261,7 +465,6 @@ uint32_t uartAvailable(uint8_t ch)
   {
     case _DEF_UART1:
     case _DEF_UART3:
-      uart_tbl[ch].qbuffer.in = uart_tbl[ch].qbuffer.len - uart_tbl[ch].p_hw->p_hdma_rx->CHNDATA_B.NDATA;
       ret = qbufferAvailable(&uart_tbl[ch].qbuffer);      
       break;
 
@@ -316,45 +519,146 @@ uint8_t uartRead(uint8_t ch)
   return ret;
 }
 
-uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
+uint32_t uartTxFree(uint8_t ch)
 {
   uint32_t ret = 0;
-  uint32_t pre_time;
-  uint32_t index;
+  uart_tbl_t *p_uart;
 
 
-  pre_time = millis();
   switch(ch)
   {
     case _DEF_UART1:
     case _DEF_UART3:
-      index = 0;
-      while(millis()-pre_time < 100)
+      p_uart = &uart_tbl[ch];
+      ret = (p_uart->tx_out + UART_TX_BUF_LENGTH - p_uart->tx_in - 1) % UART_TX_BUF_LENGTH;
+      break;
+
+    case _DEF_UART2:
+      ret = UART_TX_BUF_LENGTH;
+      break;
+  }
+
+  return ret;
+}
+
+uint32_t uartWriteAsync(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  uint32_t ret = 0;
+  uart_tbl_t *p_uart;
+  uint32_t tx_in;
+  uint32_t primask;
+
+
+  if (ch >= UART_MAX_CH || uart_tbl[ch].is_open != true) return 0;
+
+  switch(ch)
+  {
+    case _DEF_UART1:
+    case _DEF_UART3:
+      p_uart = &uart_tbl[ch];
+
+      // ISR에서도 호출되므로 공간 확보부터 tx_in 갱신까지는 인터럽트를 막고 처리한다.
+      //
+      primask = __get_PRIMASK();
+      __disable_irq();
+
+      ret = uartTxFree(ch);
+      if (ret > length)
+        ret = length;
+
+      tx_in = p_uart->tx_in;
+      for (int i=0; i<ret; i++)
       {
-        if (USART_ReadStatusFlag(uart_tbl[ch].p_hw->p_uart, USART_FLAG_TXBE) == SET)
-        {
-          USART_TxData(uart_tbl[ch].p_hw->p_uart, p_data[index]);
-          index++;
-          if (index >= length)
-          {
-            ret = index;
-            break;
-          }
-        }
+        p_uart->tx_buf[tx_in] = p_data[i];
+        tx_in = (tx_in + 1) % UART_TX_BUF_LENGTH;
       }
+      p_uart->tx_in   = tx_in;
+      p_uart->tx_cnt += ret;
+
+      __set_PRIMASK(primask);
+
+      uartTxStart(ch);
       break;
 
     case _DEF_UART2:
       #ifdef _USE_HW_USB
       ret = cdcWrite(p_data, length);
+      uart_tbl[ch].tx_cnt += ret;
       #endif
-      break;      
+      break;
   }
-  uart_tbl[ch].tx_cnt += ret;
 
   return ret;
 }
 
+uint32_t uartWrite(uint8_t ch, uint8_t *p_data, uint32_t length)
+{
+  uint32_t ret = 0;
+  uint32_t pre_time;
+  uint32_t tx_len;
+
+
+  if (ch == _DEF_UART2)
+  {
+    return uartWriteAsync(ch, p_data, length);
+  }
+
+  // 링버퍼가 가득 찬 경우에만 공간이 생길 때까지 기다린다.
+  //
+  pre_time = millis();
+  while(ret < length)
+  {
+    tx_len = uartWriteAsync(ch, &p_data[ret], length - ret);
+    ret += tx_len;
+
+    if (tx_len > 0)
+    {
+      pre_time = millis();
+    }
+    else if (__get_IPSR() != 0 || __get_PRIMASK() != 0 || millis()-pre_time >= 100)
+    {
+      // ISR이거나 인터럽트가 막힌 상태에서는 DMA TC가 버퍼를 비울 수 없고
+      // millis()도 멈추므로 기다리지 않고 남은 데이터는 버린다.
+      //
+      break;
+    }
+  }
+
+  return ret;
+}
+
+bool uartWaitTxDone(uint8_t ch, uint32_t timeout)
+{
+  uint32_t pre_time;
+  uart_tbl_t *p_uart;
+
+
+  if (ch >= UART_MAX_CH || uart_tbl[ch].is_open != true) return false;
+
+  switch(ch)
+  {
+    case _DEF_UART1:
+    case _DEF_UART3:
+      p_uart = &uart_tbl[ch];
+
+      // 링버퍼와 DMA 전송이 끝난 뒤 마지막 바이트가 shift register 에서 나갈때까지 기다린다.
+      //
+      pre_time = millis();
+      while(p_uart->tx_in != p_uart->tx_out || p_uart->tx_dma_len > 0 ||
+            USART_ReadStatusFlag(p_uart->p_hw->p_uart, USART_FLAG_TXC) != SET)
+      {
+        if (millis()-pre_time >= timeout)
+          return false;
+      }
+      break;
+
+    case _DEF_UART2:
+      break;
+  }
+
+  return true;
+}
+
 uint32_t uartPrintf(uint8_t ch, const char *fmt, ...)
 {
   char buf[256];
@@ -392,6 +696,20 @@ uint32_t uartGetBaud(uint8_t ch)
   return ret;
 }
 
+void uartSetRxCallback(uint8_t ch, void (*func)(uint8_t ch, uint32_t length))
+{
+  if (ch >= UART_MAX_CH) return;
+
+  uart_tbl[ch].rx_func = func;
+}
+
+uint32_t uartGetRxOverrun(uint8_t ch)
+{
+  if (ch >= UART_MAX_CH) return 0;
+
+  return uart_tbl[ch].rx_overrun;
+}
+
 uint32_t uartGetRxCnt(uint8_t ch)
 {
   if (ch >= UART_MAX_CH) return 0;
@@ -417,7 +735,13 @@ void cliUart(cli_args_t *args)
   {
     for (int i=0; i<UART_MAX_CH; i++)
     {
-      cliPrintf("_DEF_UART%d : %s, %d bps\n", i+1, uart_hw_tbl[i].p_msg, uartGetBaud(i));
+      cliPrintf("_DEF_UART%d : %s, %d bps, rx %d, tx %d, overrun %d\n",
+                i+1,
+                uart_hw_tbl[i].p_msg,
+                uartGetBaud(i),
+                uartGetRxCnt(i),
+                uartGetTxCnt(i),
+                uartGetRxOverrun(i));
     }
     ret = true;
   }
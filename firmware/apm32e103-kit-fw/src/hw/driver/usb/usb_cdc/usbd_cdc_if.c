@@ -1,6 +1,7 @@
 #include "usb.h"
 #include "usbd_cdc_if.h"
 #include "qbuffer.h"
+#include "mem.h"
 
 
 #define USBD_CDC_TX_BUF_LEN         1024
@@ -247,6 +248,9 @@ bool cdcIfInit(void)
   qbufferCreate(&q_rx, q_rx_buf, 2048);
   qbufferCreate(&q_tx, q_tx_buf, 2048);
 
+  MEM_BUF_ADD("cdc rx", q_rx_buf);
+  MEM_BUF_ADD("cdc tx", q_tx_buf);
+
   return true;
 }
 
@@ -1,8 +1,10 @@
 #include "wiznet.h"
 #include "swtimer.h"
 #include "cli.h"
+#include "mem.h"
 #include "rtc.h"
 #include "event.h"
+#include "log.h"
 
 
 
@@ -61,6 +63,9 @@ bool wiznetInit(void)
   bool ret = true;
   uint8_t id_str[6] = {0,};
 
+  MEM_BUF_ADD("wiznet dhcp", dhcp_buf);
+  MEM_BUF_ADD("wiznet sntp", sntp_buf);
+
   w5500Init();
 
   if (ctlwizchip(CW_INIT_WIZCHIP, (void *)memsize) == -1)
@@ -85,18 +90,18 @@ bool wiznetInit(void)
 
   is_init = ret;
 
-  logPrintf("[%s] wiznetInit()\n", ret ? "OK":"E_");
+  logBinPrintf("[%s] wiznetInit()\n", (uint32_t)(ret ? "OK":"E_"));
   if (is_init)
   {
     logPrintf("     ID   : %s\n", id_str);
-    logPrintf("     Link : %s\n", wiznetIsLink() ? "ON":"OFF");
+    logBinPrintf("     Link : %s\n", (uint32_t)(wiznetIsLink() ? "ON":"OFF"));
     wiznetPrintInfo(&net_info);
   }
   else 
   {
     if (!is_chip_found)
     {
-      logPrintf("     Chip Not Found\n");
+      logBinPrintf("     Chip Not Found\n");
     }
   }
 
@@ -146,7 +151,7 @@ bool wiznetDHCP(void)
   }
   is_init_dhcp = true;
 
-  logPrintf("[%s] wiznetDHCP()\n", ret ? "OK":"NG");
+  logBinPrintf("[%s] wiznetDHCP()\n", (uint32_t)(ret ? "OK":"NG"));
 
   return ret;
 }
@@ -160,7 +165,7 @@ bool wiznetSNTP(void)
 
   ret = wiznetInitSNTP();
 
-  logPrintf("[%s] wiznetSNTP()\n", ret ? "OK":"NG");
+  logBinPrintf("[%s] wiznetSNTP()\n", (uint32_t)(ret ? "OK":"NG"));
 
   return ret;
 }
@@ -201,6 +206,7 @@ void wiznetPrintInfo(wiz_NetInfo *p_info)
   ctlnetwork(CN_GET_NETINFO, (void *)&net_info);
   ctlwizchip(CW_GET_ID, (void *)tmp_str);
 
+  // 칩 ID 문자열과 6바이트 MAC 은 바이너리 로그로 기록할 수 없어서 텍스트로 출력한다.
   logPrintf("[  ] wiznetInfo()\n");
 
   if (net_info.dhcp == NETINFO_DHCP)
@@ -252,7 +258,7 @@ void wiznetUpdateDHCP(void)
   {
     DHCP_init(SOCKET_DHCP, dhcp_buf);    
     dhcp_get_ip_flag = false;
-    logPrintf("[  ] DHCP_init()\n");    
+    logBinPrintf("[  ] DHCP_init()\n");    
   }
   pre_link = cur_link;
 
@@ -271,9 +277,9 @@ void wiznetUpdateDHCP(void)
       case DHCP_IP_LEASED:
         if (dhcp_get_ip_flag == false)
         {
-          logPrintf("[OK] DHCP Success\n");
+          logBinPrintf("[OK] DHCP Success\n");
           wiznetPrintInfo(&net_info);
-          logPrintf("     DHCP Leased Time : %ld Sec\n", getDHCPLeasetime());          
+          logBinPrintf("     DHCP Leased Time : %ld Sec\n", getDHCPLeasetime());          
           dhcp_get_ip_flag = true;
           eventPub(EVENT_WIZ_PHY_DHCP, 0);
         }
@@ -290,7 +296,7 @@ void wiznetUpdateDHCP(void)
 
           ctlnetwork(CN_SET_NETINFO, (void *)&net_info);
 
-          logPrintf("[NG] DHCP_FAILED\n");
+          logBinPrintf("[NG] DHCP_FAILED\n");
           eventPub(EVENT_WIZ_PHY_DHCP, 2);
         }
         else
@@ -324,7 +330,7 @@ void wiznetUpdateSNTP(void)
   {
     wiznetInitSNTP();    
     sntp_get_time_flag = false;
-    logPrintf("[  ] SNTP_init()\n");    
+    logBinPrintf("[  ] SNTP_init()\n");    
   }
   pre_link = cur_link;
 
@@ -338,9 +344,10 @@ void wiznetUpdateSNTP(void)
 
   if (SNTP_run(&sntp_time) == true)
   {
-    logPrintf("[OK] SNTP\n");
-    logPrintf("     %d-%d-%d, %02d:%02d:%02d\n", 
-        sntp_time.yy, sntp_time.mo, sntp_time.dd, sntp_time.hh, sntp_time.mm, sntp_time.ss);
+    // 바이너리 로그는 인자가 4개까지라 날짜와 시간을 나눠서 기록한다.
+    logBinPrintf("[OK] SNTP\n");
+    logBinPrintf("     %d-%d-%d\n", sntp_time.yy, sntp_time.mo, sntp_time.dd);
+    logBinPrintf("     %02d:%02d:%02d\n", sntp_time.hh, sntp_time.mm, sntp_time.ss);
 
     sntp_get_time_flag = true;
 
@@ -419,7 +426,7 @@ static void wizchip_dhcp_assign(void)
 
 static void wizchip_dhcp_conflict(void)
 {
-  logPrintf("     Conflict IP from DHCP\n");
+  logBinPrintf("     Conflict IP from DHCP\n");
 }
 
 #if CLI_USE(HW_WIZNET)
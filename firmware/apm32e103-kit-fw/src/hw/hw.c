@@ -6,6 +6,9 @@
 extern uint32_t _fw_flash_begin;
 extern uint32_t _fw_size;
 
+static bool usbInitCdc(void);
+static bool lcdInitFps(void);
+
 volatile const firm_ver_t firm_ver __attribute__((section(".version"))) = 
 {
   .magic_number = VERSION_MAGIC_NUMBER,
@@ -15,15 +18,86 @@ volatile const firm_ver_t firm_ver __attribute__((section(".version"))) =
 };
 
 
+enum
+{
+  INIT_RTC,
+  INIT_RESET,
+  INIT_GPIO,
+  INIT_BUTTON,
+  INIT_I2C,
+  INIT_EEPROM,
+  INIT_SPI,
+  INIT_SPI_FLASH,
+  INIT_FLASH,
+  INIT_I2S,
+  INIT_USB,
+  INIT_CDC,
+  INIT_CAN,
+  INIT_WS2812,
+  INIT_EVENT,
+  INIT_ADC,
+  INIT_SD,
+  INIT_FATFS,
+  INIT_LCD,
+  INIT_WIZNET,
+  INIT_DHCP,
+  INIT_SNTP,
+  INIT_IMU,
+  INIT_HDC1080,
+  INIT_ID_MAX
+};
+
+//-- cmd/cli 에 필요한 장치만 apMain() 전에 초기화하고, 
+//   느린 장치는 메인 루프에서 initUpdate()로 초기화한다.
+//   LATER 항목은 한 번에 하나씩 실행되지만 init() 자체는 끝날 때까지 
+//   블록된다. 나눠서 기다리는 것은 update 함수가 있는 DHCP 뿐이다.
+//
+static const init_tbl_t init_tbl[INIT_ID_MAX] = 
+{
+  [INIT_RTC]       = {"rtc",      INIT_MODE_NOW,   0,                                   rtcInit,      NULL},
+  [INIT_RESET]     = {"reset",    INIT_MODE_NOW,   INIT_BIT(INIT_RTC),                  resetInit,    NULL},
+  [INIT_GPIO]      = {"gpio",     INIT_MODE_NOW,   0,                                   gpioInit,     NULL},
+  [INIT_BUTTON]    = {"button",   INIT_MODE_NOW,   0,                                   buttonInit,   NULL},
+  [INIT_I2C]       = {"i2c",      INIT_MODE_NOW,   0,                                   i2cInit,      NULL},
+  [INIT_EEPROM]    = {"eeprom",   INIT_MODE_NOW,   INIT_BIT(INIT_I2C),                  eepromInit,   NULL},
+  [INIT_SPI]       = {"spi",      INIT_MODE_NOW,   INIT_BIT(INIT_GPIO),                 spiInit,      NULL},
+  [INIT_SPI_FLASH] = {"spiFlash", INIT_MODE_NOW,   INIT_BIT(INIT_SPI),                  spiFlashInit, NULL},
+  [INIT_FLASH]     = {"flash",    INIT_MODE_NOW,   INIT_BIT(INIT_SPI_FLASH),            flashInit,    NULL},
+  [INIT_I2S]       = {"i2s",      INIT_MODE_NOW,   INIT_BIT(INIT_GPIO),                 i2sInit,      NULL},
+  [INIT_USB]       = {"usb",      INIT_MODE_NOW,   0,                                   usbInitCdc,   NULL},
+  [INIT_CDC]       = {"cdc",      INIT_MODE_NOW,   INIT_BIT(INIT_USB),                  cdcInit,      NULL},
+  [INIT_CAN]       = {"can",      INIT_MODE_NOW,   0,                                   canInit,      NULL},
+  [INIT_WS2812]    = {"ws2812",   INIT_MODE_NOW,   0,                                   ws2812Init,   NULL},
+  [INIT_EVENT]     = {"event",    INIT_MODE_NOW,   0,                                   eventInit,    NULL},
+  [INIT_ADC]       = {"adc",      INIT_MODE_NOW,   0,                                   adcInit,      NULL},
+
+  [INIT_SD]        = {"sd",       INIT_MODE_LATER, INIT_BIT(INIT_GPIO),                 sdInit,       NULL},
+  [INIT_FATFS]     = {"fatfs",    INIT_MODE_LATER, INIT_BIT(INIT_SD),                   fatfsInit,    NULL},
+  [INIT_LCD]       = {"lcd",      INIT_MODE_LATER, INIT_BIT(INIT_I2C),                  lcdInitFps,   NULL},
+  [INIT_WIZNET]    = {"wiznet",   INIT_MODE_LATER, INIT_BIT(INIT_SPI)|INIT_BIT(INIT_EVENT), wiznetInit, NULL},
+  [INIT_DHCP]      = {"dhcp",     INIT_MODE_LATER, INIT_BIT(INIT_WIZNET),               wiznetDHCP,   wiznetIsGetIP},
+  [INIT_SNTP]      = {"sntp",     INIT_MODE_LATER, INIT_BIT(INIT_DHCP),                 wiznetSNTP,   NULL},
+  [INIT_IMU]       = {"imu",      INIT_MODE_LATER, INIT_BIT(INIT_I2C),                  imuInit,      NULL},
+  [INIT_HDC1080]   = {"hdc1080",  INIT_MODE_LATER, INIT_BIT(INIT_I2C),                  hdc1080Init,  NULL},
+};
+
+
 
 
 bool hwInit(void)
 {
+  bootTimeInit();
   bspInit();
+  memInit();
+  bootTimeMark("bsp");
 
   cliInit();
+  perfInit();
+  mpoolInit();
+  pbufInit();
   logInit();
   swtimerInit();
+  taskInit();
   ledInit();
   uartInit();
   for (int i=0; i<HW_UART_MAX_CH; i++)
@@ -45,36 +119,26 @@ bool hwInit(void)
 
   logPrintf("\n");
 
-  rtcInit();
-  resetInit();
-  gpioInit();
-  buttonInit();
-  i2cInit();
-  eepromInit();
-  spiInit();
-  spiFlashInit();
-  sdInit();
-  fatfsInit();
-  i2sInit();
-  flashInit();
-
-  usbInit();
-  usbBegin(USB_CDC_MODE);
-  cdcInit();
-
-  canInit();
-  ws2812Init();
-  lcdInit();
-  lcdSetFps(20);
-  
-  eventInit();
-  wiznetInit();
-  wiznetDHCP();
-  wiznetSNTP();
+  bootTimeMark("log");
 
-  imuInit();
-  hdc1080Init();
-
-  adcInit();
+  initBegin(init_tbl, INIT_ID_MAX);
   return true;
+}
+
+bool usbInitCdc(void)
+{
+  bool ret;
+
+  ret = usbInit();
+  ret &= usbBegin(USB_CDC_MODE);
+  return ret;
+}
+
+bool lcdInitFps(void)
+{
+  bool ret;
+
+  ret = lcdInit();
+  lcdSetFps(20);
+  return ret;
 }
\ No newline at end of file
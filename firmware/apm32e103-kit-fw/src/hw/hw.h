@@ -37,6 +37,13 @@ extern "C" {
 #include "flash.h"
 #include "reset.h"
 #include "cmd.h"
+#include "boot_time.h"
+#include "init.h"
+#include "task.h"
+#include "perf.h"
+#include "mem.h"
+#include "mpool.h"
+#include "pbuf.h"
 #include "util.h"
 #include "qbuffer.h"
 
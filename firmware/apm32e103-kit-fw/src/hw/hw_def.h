@@ -17,7 +17,10 @@
 #define _USE_HW_BUZZER
 #define _USE_HW_ICM42670
 #define _USE_HW_IMU
-#define _USE_HW_HDC1080 
+#define      HW_IMU_ODR_HZ          200
+#define      HW_IMU_UPDATE_MS       20      // FIFO 를 읽는 주기
+#define _USE_HW_HDC1080
+#define      HW_HDC1080_PERIOD_MS   100     // 측정 주기, telemetry 최대 10Hz
 #define _USE_HW_FLASH
 
 
@@ -38,8 +41,12 @@
 #define      HW_LOG_BOOT_BUF_MAX    2048
 #define      HW_LOG_LIST_BUF_MAX    4096
 
+#define _USE_HW_LOG_BIN
+#define      HW_LOG_BIN_Q_MAX       64    // 2의 거듭제곱
+#define      HW_LOG_BIN_ARG_MAX     4
+
 #define _USE_HW_CLI
-#define      HW_CLI_CMD_LIST_MAX    32
+#define      HW_CLI_CMD_LIST_MAX    48    // cliAdd 호출은 34개, 넘치면 cliAdd 가 로그를 남긴다.
 #define      HW_CLI_CMD_NAME_MAX    16
 #define      HW_CLI_LINE_HIS_MAX    8
 #define      HW_CLI_LINE_BUF_MAX    64
@@ -52,9 +59,11 @@
 #define      HW_I2C_CH_EEPROM       _DEF_I2C1
 #define      HW_I2C_CH_OLED         _DEF_I2C2
 #define      HW_I2C_CH_IMU          _DEF_I2C1
+#define      HW_I2C_DEV_MAX         8
 
 #define _USE_HW_EEPROM
 #define      HW_EEPROM_MAX_SIZE     (8*1024)
+#define      HW_EEPROM_PAGE_SIZE    32
 
 #define _USE_HW_SPI
 #define      HW_SPI_MAX_CH          2
@@ -85,9 +94,11 @@
 #define _USE_HW_SSD1306
 #define      HW_LCD_WIDTH           128
 #define      HW_LCD_HEIGHT          32
+#define      HW_LCD_MONO            1     // 1:프레임 버퍼 없이 1bpp 페이지 버퍼에 바로 그림
+#define      HW_LCD_GLYPH_CACHE_MAX 32
 
 #define _USE_HW_SWTIMER
-#define      HW_SWTIMER_MAX_CH      8
+#define      HW_SWTIMER_MAX_CH      16
 
 #define _USE_HW_WIZNET
 #define      HW_WIZNET_SOCKET_CMD   0
@@ -95,11 +106,14 @@
 #define      HW_WIZNET_SOCKET_SNTP  2
 
 #define _USE_HW_EVENT
-#define      HW_EVENT_Q_MAX         8
+#define      HW_EVENT_Q_MAX         32    // 2의 거듭제곱
 #define      HW_EVENT_NODE_MAX      16  
 
 #define _USE_HW_ADC                 
-#define      HW_ADC_MAX_CH          1
+#define      HW_ADC_MAX_CH          3
+#define      HW_ADC_SAMPLE_HZ       4000    // TMR2 트리거 스캔 주기, 0 = 연속 변환
+#define      HW_ADC_BLOCK_LEN       64      // DMA 반 버퍼당 스캔 수
+#define      HW_ADC_OVERSAMPLE_BITS 4       // 2^n 샘플 평균 (0~4)
 
 #define _USE_HW_RTC
 #define      HW_RTC_BOOT_MODE       BAKPR_DATA3
@@ -111,6 +125,34 @@
 #define _USE_HW_CMD
 #define      HW_CMD_MAX_DATA_LENGTH 2048
 
+#define _USE_HW_MPOOL
+#define      HW_MPOOL_DEBUG         0
+#define      HW_MPOOL_M_SIZE        576                   // FIL, FatFs LFN 버퍼
+#define      HW_MPOOL_M_CNT         10
+#define      HW_MPOOL_L_SIZE        (HW_PBUF_LENGTH + 16) // pbuf
+#define      HW_MPOOL_L_CNT         HW_PBUF_MAX
+
+#define _USE_HW_PBUF
+#define      HW_PBUF_MAX            6     // cmd 채널 3 + UDP 수신 1 + 송신 2
+#define      HW_PBUF_LENGTH         (HW_CMD_MAX_DATA_LENGTH + 10)
+
+#define _USE_HW_BOOT_TIME
+#define      HW_BOOT_TIME_MAX       48
+#define      HW_BOOT_TIME_IMAGE     1     // 0:BOOT, 1:FW
+
+#define _USE_HW_INIT
+#define      HW_INIT_MAX            28
+
+#define _USE_HW_TASK
+#define      HW_TASK_MAX_CH         16
+
+#define _USE_HW_MEM
+#define      HW_MEM_BUF_MAX         32
+
+#define _USE_HW_PERF
+#define      HW_PERF_BIN_MAX        16
+#define      HW_PERF_BIN_SHIFT      6
+
 
 
 #define FLASH_SIZE_TAG              0x400
@@ -146,6 +188,14 @@
 #define _USE_CLI_HW_ADC             1
 #define _USE_CLI_HW_FLASH           1
 #define _USE_CLI_HW_RESET           1
+#define _USE_CLI_HW_BOOT_TIME       1
+#define _USE_CLI_HW_INIT            1
+#define _USE_CLI_HW_TASK            1
+#define _USE_CLI_HW_SWTIMER         1
+#define _USE_CLI_HW_PERF            1
+#define _USE_CLI_HW_MEM             1
+#define _USE_CLI_HW_PBUF            1
+#define _USE_CLI_HW_MPOOL           1
 
 
 typedef enum
@@ -162,6 +212,8 @@ typedef enum
 typedef enum
 {
   LIGHT_ADC = 0,
+  TEMP_ADC,
+  VREF_ADC,
   ADC_PIN_MAX
 } AdcPinName_t;
 
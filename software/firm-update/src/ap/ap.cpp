@@ -9,6 +9,8 @@
 #include "ap.h"
 #include "boot/boot.h"
 #include "audio/audio.h"
+#include "log/log_bin.h"
+#include "telem/telem.h"
 
 
 enum
@@ -40,6 +42,8 @@ void apInit(void)
   arg_option.mode = MODE_DOWN;
   arg_option.is_udp = false;
   arg_option.is_audio = false;
+  arg_option.is_log = false;
+  arg_option.is_telem = false;
 }
 
 void apMain(int argc, char *argv[])
@@ -58,6 +62,14 @@ void apMain(int argc, char *argv[])
   {
     audioMain(&arg_option);
   }
+  else if (arg_option.is_log)
+  {
+    logBinMain(&arg_option);
+  }
+  else if (arg_option.is_telem)
+  {
+    telemMain(&arg_option);
+  }
   else
   {
     apDownMode();
@@ -75,10 +87,15 @@ bool apGetOption(int argc, char *argv[])
   arg_option.run_fw      = true;
   arg_option.arg_bits    = 0;
   arg_option.port_baud   = 19200;
+  arg_option.fast_baud   = 1000000;
   arg_option.tx_block_len = 256;
+  arg_option.telem_rate[0] = 200;
+  arg_option.telem_rate[1] = 1;
+  arg_option.telem_rate[2] = 10;
+  arg_option.telem_rate[3] = 100;
 
 
-  while((opt = getopt(argc, argv, "m:t:hcp:b:f:a:rv:l")) != -1)
+  while((opt = getopt(argc, argv, "m:t:hcp:b:s:f:a:rv:le:")) != -1)
   {
     switch(opt)
     {
@@ -94,6 +111,16 @@ bool apGetOption(int argc, char *argv[])
           arg_option.is_audio = true;
           logPrintf("-m audio\n");
         }
+        else if (strncmp(argv[optind-1], "log", 3) == 0)
+        {
+          arg_option.is_log = true;
+          logPrintf("-m log\n");
+        }
+        else if (strncmp(argv[optind-1], "telem", 5) == 0)
+        {
+          arg_option.is_telem = true;
+          logPrintf("-m telem\n");
+        }
         else
         {
           logPrintf("-m uart\n");
@@ -134,12 +161,35 @@ bool apGetOption(int argc, char *argv[])
         logPrintf("-b %d\n", arg_option.port_baud);
         break;
 
+      case 's':
+        arg_option.fast_baud = (uint32_t)strtoul((const char * )optarg, (char **)NULL, (int) 0);
+        logPrintf("-s %d\n", arg_option.fast_baud);
+        break;
+
       case 'f':
         arg_option.arg_bits |= ARG_OPTION_FILE;
         strncpy(arg_option.file_str, optarg, 128);
         logPrintf("-f %s\n", arg_option.file_str);
         break;
 
+      case 'e':
+        {
+          char *p_str = optarg;
+
+          for (int i=0; i<4 && *p_str != 0; i++)
+          {
+            arg_option.telem_rate[i] = (uint16_t)strtoul(p_str, &p_str, 0);
+            if (*p_str == ',')
+              p_str++;
+          }
+          logPrintf("-e %d,%d,%d,%d\n",
+                    arg_option.telem_rate[0],
+                    arg_option.telem_rate[1],
+                    arg_option.telem_rate[2],
+                    arg_option.telem_rate[3]);
+        }
+        break;
+
       case 'r':
         arg_option.run_fw = true;
         logPrintf("-r 1\n");
@@ -177,8 +227,12 @@ void apShowHelp(void)
   logPrintf("firm-update [udp] -p com1 -f fw.bin\n");
   logPrintf("            -h : help\n");
   logPrintf("            -m udp   : udp \n");
+  logPrintf("            -m log   : binary log decoder, -f fw.bin\n");
+  logPrintf("            -m telem : telemetry recorder, -f out.csv [-e imu,hdc,adc,flush]\n");
+  logPrintf("            -e 200,1,10,100 : telemetry imu/hdc/adc Hz, flush ms\n");
   logPrintf("            -p com1  : com port\n");
   logPrintf("            -b 19200 : baud\n");
+  logPrintf("            -s 1000000 : download baud, 0 = off\n");
   logPrintf("            -f fw.bin: firmware\n");
 }
 
@@ -404,6 +458,21 @@ void apDownMode(void)
     logPrintf("\n");
 
 
+    // Set Baud
+    //
+    if (arg_option.is_udp != true && arg_option.fast_baud > 0 && arg_option.fast_baud != baud)
+    {
+      logPrintf("## Set Baud \n");
+      logPrintf("##\n");
+      pre_time = millis();
+      err_code = bootCmdSetBaud(arg_option.fast_baud, 500);
+      if (err_code == CMD_OK)
+        logPrintf("OK %d bps, %d ms\n\n", arg_option.fast_baud, millis()-pre_time);
+      else
+        logPrintf("Fail 0x%04X, keep %d bps\n\n", err_code, baud);
+    }
+
+
     // Begin
     //
     logPrintf("## Begin \n");
@@ -559,6 +628,8 @@ void apExit(void)
   printf("\n");
   bootDeInit();
   audioDeInit();
+  logBinDeInit();
+  telemDeInit();
 
   for (int i=0; i<UART_MAX_CH; i++)
   {
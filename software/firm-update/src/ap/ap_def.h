@@ -18,14 +18,18 @@ typedef struct
   uint8_t mode;
   bool    is_udp;
   bool    is_audio;
+  bool    is_log;
+  bool    is_telem;
   uint32_t arg_bits;
   char     port_str[128];
   uint32_t port_baud;
+  uint32_t fast_baud;
   char     file_str[128];
   bool     run_fw;
   uint8_t  type;
 
   uint32_t tx_block_len;
+  uint16_t telem_rate[4];    // imu, hdc, adc [Hz], flush [ms]
 } arg_option_t;
 
 
@@ -20,9 +20,19 @@
 #define BOOT_CMD_FW_JUMP                0x000C
 #define BOOT_CMD_FW_BEGIN               0x000D
 #define BOOT_CMD_FW_END                 0x000E
+#define BOOT_CMD_SET_BAUD               0x0013
 
+#define BOOT_BAUD_PING_RETRY            3
+#define BOOT_BAUD_REVERT_TIME           1100    // 장치가 이전 속도로 돌아가는 시간(1000ms) + 여유
+
+
+static bool bootReopen(uint32_t baud);
+static bool bootPing(uint32_t timeout);
 
 static bool is_init = false;
+static bool is_uart = false;
+static uint8_t  uart_ch = 0;
+static uint32_t uart_baud = 0;
 static cmd_t cmd_boot;
 static cmd_driver_t cmd_driver;
 
@@ -45,6 +55,10 @@ bool bootInit(uint8_t ch, char *port_name, uint32_t baud)
 
   ret = cmdOpen(&cmd_boot);
 
+  is_uart   = true;
+  uart_ch   = ch;
+  uart_baud = baud;
+
   is_init = true;
   return ret;
 }
@@ -58,6 +72,7 @@ bool bootInitUdp(char *ip_addr, uint32_t port)
 
   ret = cmdOpen(&cmd_boot);
 
+  is_uart = false;
   is_init = true;
   return ret;
 }
@@ -333,4 +348,84 @@ uint16_t bootCmdFirmJump(uint32_t timeout)
   ret = p_cmd->packet.err_code;
 
   return ret;  
-}
\ No newline at end of file
+}
+
+bool bootReopen(uint32_t baud)
+{
+  cmdUartInitDriver(&cmd_driver, uart_ch, baud);
+  cmdInit(&cmd_boot, &cmd_driver);
+
+  return cmdOpen(&cmd_boot);
+}
+
+bool bootPing(uint32_t timeout)
+{
+  cmd_t *p_cmd = &cmd_boot;
+  uint32_t pre_time;
+
+
+  cmdSendType(p_cmd, PKT_TYPE_PING, NULL, 0);
+
+  pre_time = millis();
+  while(millis()-pre_time < timeout)
+  {
+    if (cmdReceivePacket(p_cmd) == true && p_cmd->packet.type == PKT_TYPE_PING)
+    {
+      return true;
+    }
+    delay(1);
+  }
+
+  return false;
+}
+
+uint16_t bootCmdSetBaud(uint32_t baud, uint32_t timeout)
+{
+  uint16_t ret = CMD_OK;
+  cmd_t *p_cmd = &cmd_boot;
+  bool is_ping = false;
+
+
+  if (is_uart != true || baud == uart_baud)
+    return CMD_OK;
+
+  // 장치는 현재 속도로 응답한 다음 속도를 바꾼다.
+  //
+  cmdSendCmdRxResp(p_cmd, BOOT_CMD_SET_BAUD, (uint8_t *)&baud, 4, timeout);
+  ret = p_cmd->packet.err_code;
+  if (ret != CMD_OK && ret != ERR_CMD_RX_TIMEOUT)
+  {
+    return ret;
+  }
+
+  // 응답을 놓쳤더라도 장치가 바꿨을 수 있으므로 새 속도로 ping 을 보내 확인한다.
+  //
+  if (bootReopen(baud) == true)
+  {
+    for (int i=0; i<BOOT_BAUD_PING_RETRY; i++)
+    {
+      if (bootPing(timeout) == true)
+      {
+        is_ping = true;
+        break;
+      }
+    }
+  }
+
+  if (is_ping == true)
+  {
+    uart_baud = baud;
+    return CMD_OK;
+  }
+
+  // 확인이 안되면 장치도 시간이 지나 이전 속도로 돌아가므로 같이 되돌린다.
+  //
+  bootReopen(uart_baud);
+  delay(BOOT_BAUD_REVERT_TIME);
+  p_cmd->p_driver->flush(p_cmd->p_driver->args);
+
+  if (ret == CMD_OK)
+    ret = ERR_CMD_RX_TIMEOUT;
+
+  return ret;
+}
@@ -41,6 +41,7 @@ cmd_driver_t *bootGetDriver(void);
 
 uint16_t bootCmdReadInfo(boot_info_t *info, uint32_t timeout);
 uint16_t bootCmdReadVersion(boot_version_t *version, uint32_t timeout);
+uint16_t bootCmdSetBaud(uint32_t baud, uint32_t timeout);
 
 uint16_t bootCmdFirmBegin(boot_begin_t *begin, uint32_t timeout);
 uint16_t bootCmdFirmEnd(uint32_t timeout);
@@ -0,0 +1,296 @@
+#include "log_bin.h"
+#include "boot/boot.h"
+#include "cmd/driver/cmd_uart.h"
+#include "cmd/driver/cmd_udp.h"
+
+
+#define BOOT_CMD_LOG_BIN            0x0012
+
+#define LOG_BIN_ARG_MAX             4
+#define LOG_BIN_REC_HEAD            12
+#define LOG_BIN_FIRM_ADDR           0x08020400
+
+
+typedef struct
+{
+  uint32_t fmt;
+  uint32_t time_us;
+  uint32_t argc;
+  uint32_t arg[LOG_BIN_ARG_MAX];
+} log_bin_t;
+
+
+static bool logBinLoadFile(char *file_name);
+static const char *logBinGetStr(uint32_t addr);
+static void logBinPrint(log_bin_t *p_log);
+
+static bool is_init = false;
+static cmd_t cmd;
+static cmd_driver_t cmd_driver;
+
+static uint8_t *file_buf = NULL;
+static uint32_t file_size = 0;
+static uint32_t firm_addr = LOG_BIN_FIRM_ADDR;
+static uint32_t drop_pre = 0;
+
+
+
+
+
+void logBinMain(arg_option_t *args)
+{
+  uint8_t enable = 1;
+  bool ret;
+
+
+  logPrintf("\n");
+  logPrintf("logBinMain()\n");
+
+  if ((args->arg_bits & ARG_OPTION_FILE) == 0)
+  {
+    logPrintf("-f fw.bin empty\n");
+    return;
+  }
+  if (logBinLoadFile(args->file_str) != true)
+  {
+    return;
+  }
+  logPrintf("firm addr  : 0x%X\n", firm_addr);
+
+  if (args->is_udp == true)
+  {
+    cmdUdpInitDriver(&cmd_driver, args->port_str, 5100);
+  }
+  else
+  {
+    if ((args->arg_bits & ARG_OPTION_PORT) == 0)
+    {
+      logPrintf("-p port empty\n");
+      return;
+    }
+    uartSetPortName(_USE_UART_CMD, args->port_str);
+    cmdUartInitDriver(&cmd_driver, _USE_UART_CMD, args->port_baud);
+  }
+  cmdInit(&cmd, &cmd_driver);
+  ret = cmdOpen(&cmd);
+  if (ret != true)
+  {
+    logPrintf("cmdOpen() Fail\n");
+    return;
+  }
+  is_init = true;
+
+  if (cmdSendCmdRxResp(&cmd, BOOT_CMD_LOG_BIN, &enable, 1, 500) != true || cmd.packet.err_code != CMD_OK)
+  {
+    logPrintf("BOOT_CMD_LOG_BIN Fail : 0x%04X\n", cmd.packet.err_code);
+    return;
+  }
+  logPrintf("\n[ Log Begin.. ]\n\n");
+
+  while(1)
+  {
+    if (cmdReceivePacket(&cmd) != true)
+    {
+      delay(1);
+      continue;
+    }
+
+    cmd_packet_t *p_packet = &cmd.packet;
+    uint32_t index;
+    uint32_t drop;
+
+    if (p_packet->type != PKT_TYPE_LOG || p_packet->err_code != CMD_OK || p_packet->length < 4)
+      continue;
+
+    memcpy(&drop, &p_packet->data[0], 4);
+    if (drop != drop_pre)
+    {
+      logPrintf("[ %d logs dropped ]\n", drop - drop_pre);
+      drop_pre = drop;
+    }
+
+    index = 4;
+    while(index + LOG_BIN_REC_HEAD <= p_packet->length)
+    {
+      log_bin_t log;
+      uint32_t  rec_len;
+
+      memset(&log, 0, sizeof(log));
+      memcpy(&log, &p_packet->data[index], LOG_BIN_REC_HEAD);
+      if (log.argc > LOG_BIN_ARG_MAX)
+        break;
+
+      rec_len = LOG_BIN_REC_HEAD + log.argc * 4;
+      if (index + rec_len > p_packet->length)
+        break;
+
+      memcpy(log.arg, &p_packet->data[index + LOG_BIN_REC_HEAD], log.argc * 4);
+      logBinPrint(&log);
+      index += rec_len;
+    }
+  }
+}
+
+void logBinDeInit(void)
+{
+  uint8_t enable = 0;
+
+  if (is_init)
+  {
+    cmdSendCmdRxResp(&cmd, BOOT_CMD_LOG_BIN, &enable, 1, 100);
+    cmdClose(&cmd);
+    is_init = false;
+  }
+  if (file_buf != NULL)
+  {
+    free(file_buf);
+    file_buf = NULL;
+  }
+}
+
+bool logBinLoadFile(char *file_name)
+{
+  FILE *fp;
+  long len;
+  firm_ver_t firm_ver;
+
+
+  if ((fp = fopen(file_name, "rb")) == NULL)
+  {
+    logPrintf("Unable to open %s\n", file_name);
+    return false;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  len = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  if (len <= 0)
+  {
+    fclose(fp);
+    return false;
+  }
+
+  file_buf  = (uint8_t *)malloc(len + 1);
+  file_size = fread(file_buf, 1, len, fp);
+  file_buf[file_size] = 0;
+  fclose(fp);
+
+  // 포맷 문자열 주소는 펌웨어 이미지의 시작 주소 기준으로 찾는다.
+  //
+  if (file_size >= BOOT_SIZE_VER + sizeof(firm_ver_t))
+  {
+    memcpy(&firm_ver, &file_buf[BOOT_SIZE_VER], sizeof(firm_ver_t));
+    if (firm_ver.magic_number == VERSION_MAGIC_NUMBER)
+    {
+      firm_addr = firm_ver.firm_addr;
+    }
+  }
+
+  return true;
+}
+
+const char *logBinGetStr(uint32_t addr)
+{
+  if (addr < firm_addr || addr >= firm_addr + file_size)
+    return NULL;
+
+  return (const char *)&file_buf[addr - firm_addr];
+}
+
+void logBinPrint(log_bin_t *p_log)
+{
+  static bool is_line_start = true;
+  const char *p_fmt;
+  uint32_t arg_i = 0;
+  char spec[32];
+  char out[256];
+
+
+  p_fmt = logBinGetStr(p_log->fmt);
+  if (p_fmt == NULL)
+  {
+    printf("[ unknown fmt 0x%08X ]\n", p_log->fmt);
+    is_line_start = true;
+    return;
+  }
+
+  while(*p_fmt != 0)
+  {
+    if (is_line_start)
+    {
+      printf("%6d.%03d  ", p_log->time_us/1000000, (p_log->time_us/1000)%1000);
+      is_line_start = false;
+    }
+
+    if (*p_fmt != '%')
+    {
+      putchar(*p_fmt);
+      if (*p_fmt == '\n')
+        is_line_start = true;
+      p_fmt++;
+      continue;
+    }
+
+    if (p_fmt[1] == '%')
+    {
+      putchar('%');
+      p_fmt += 2;
+      continue;
+    }
+
+    // 길이 지정자(l, h 등)는 빼고 플래그/폭/정밀도만 남긴다.
+    //
+    uint32_t spec_i = 0;
+    spec[spec_i++] = *p_fmt++;
+    while(*p_fmt != 0 && strchr("-+ #0123456789.", *p_fmt) != NULL && spec_i < sizeof(spec) - 2)
+    {
+      spec[spec_i++] = *p_fmt++;
+    }
+    while(*p_fmt != 0 && strchr("hlzjt", *p_fmt) != NULL)
+    {
+      p_fmt++;
+    }
+    if (*p_fmt == 0)
+      break;
+
+    char     conv = *p_fmt++;
+    uint32_t arg  = arg_i < p_log->argc ? p_log->arg[arg_i] : 0;
+    arg_i++;
+
+    spec[spec_i++] = conv;
+    spec[spec_i]   = 0;
+
+    switch(conv)
+    {
+      case 'd':
+      case 'i':
+        snprintf(out, sizeof(out), spec, (int)arg);
+        break;
+
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+      case 'c':
+        snprintf(out, sizeof(out), spec, (unsigned int)arg);
+        break;
+
+      case 's':
+        {
+          const char *p_str = logBinGetStr(arg);
+          snprintf(out, sizeof(out), spec, p_str != NULL ? p_str:"(?)");
+        }
+        break;
+
+      case 'p':
+        snprintf(out, sizeof(out), "0x%08X", arg);
+        break;
+
+      default:
+        snprintf(out, sizeof(out), "?");
+        break;
+    }
+    printf("%s", out);
+  }
+}
@@ -0,0 +1,13 @@
+#ifndef LOG_BIN_H_
+#define LOG_BIN_H_
+
+#include "ap_def.h"
+
+
+
+
+
+void logBinMain(arg_option_t *args);
+void logBinDeInit(void);
+
+#endif
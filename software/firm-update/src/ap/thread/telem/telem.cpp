@@ -0,0 +1,301 @@
+#include "telem.h"
+#include "cmd/driver/cmd_uart.h"
+#include "cmd/driver/cmd_udp.h"
+
+
+#define TELEM_CMD_CONFIG            0x0100
+#define TELEM_EVT_DATA              0x0100
+
+#define TELEM_HEAD_SIZE             8
+#define TELEM_REC_HEAD              5
+
+#define TELEM_TYPE_IMU              0x01
+#define TELEM_TYPE_HDC              0x02
+#define TELEM_TYPE_ADC              0x03
+
+#define TELEM_REC_IMU               18
+#define TELEM_REC_HDC               4
+
+
+typedef struct
+{
+  uint16_t imu_hz;
+  uint16_t hdc_hz;
+  uint16_t adc_hz;
+  uint16_t flush_ms;
+} telem_config_t;
+
+
+static bool telemSendConfig(telem_config_t *p_config, uint32_t timeout);
+static void telemWriteRecord(uint8_t type, uint32_t time_us, uint8_t *p_data, uint32_t length);
+static void telemShowStat(void);
+
+static bool  is_init = false;
+static cmd_t cmd;
+static cmd_driver_t cmd_driver;
+static FILE *fp = NULL;
+
+static bool     is_seq     = false;
+static uint32_t seq_next   = 0;
+static uint32_t seq_lost   = 0;
+static uint32_t drop_pre   = 0;
+static uint32_t rx_packets = 0;
+static uint32_t rx_records[4];
+
+
+
+
+
+void telemMain(arg_option_t *args)
+{
+  telem_config_t config;
+  uint32_t pre_time;
+
+
+  logPrintf("\n");
+  logPrintf("telemMain()\n");
+
+  if ((args->arg_bits & ARG_OPTION_FILE) == 0)
+  {
+    logPrintf("-f out.csv empty\n");
+    return;
+  }
+
+  if (args->is_udp == true)
+  {
+    cmdUdpInitDriver(&cmd_driver, args->port_str, 5100);
+  }
+  else
+  {
+    if ((args->arg_bits & ARG_OPTION_PORT) == 0)
+    {
+      logPrintf("-p port empty\n");
+      return;
+    }
+    uartSetPortName(_USE_UART_CMD, args->port_str);
+    cmdUartInitDriver(&cmd_driver, _USE_UART_CMD, args->port_baud);
+  }
+  cmdInit(&cmd, &cmd_driver);
+  if (cmdOpen(&cmd) != true)
+  {
+    logPrintf("cmdOpen() Fail\n");
+    return;
+  }
+  is_init = true;
+
+  if ((fp = fopen(args->file_str, "w")) == NULL)
+  {
+    logPrintf("Unable to open %s\n", args->file_str);
+    return;
+  }
+  fprintf(fp, "type,time_us,d0,d1,d2,d3,d4,d5,d6,d7,d8\n");
+
+  config.imu_hz   = args->telem_rate[0];
+  config.hdc_hz   = args->telem_rate[1];
+  config.adc_hz   = args->telem_rate[2];
+  config.flush_ms = args->telem_rate[3];
+  if (telemSendConfig(&config, 500) != true)
+  {
+    logPrintf("TELEM_CMD_CONFIG Fail : 0x%04X\n", cmd.packet.err_code);
+    return;
+  }
+  logPrintf("imu        : %d Hz\n", config.imu_hz);
+  logPrintf("hdc        : %d Hz\n", config.hdc_hz);
+  logPrintf("adc        : %d Hz\n", config.adc_hz);
+  logPrintf("flush      : %d ms\n", config.flush_ms);
+  logPrintf("\n[ Telemetry Begin.. ]\n\n");
+
+  pre_time = millis();
+  while(1)
+  {
+    if (millis()-pre_time >= 1000)
+    {
+      pre_time = millis();
+      telemShowStat();
+    }
+
+    if (cmdReceivePacket(&cmd) != true)
+    {
+      delay(1);
+      continue;
+    }
+
+    cmd_packet_t *p_packet = &cmd.packet;
+    uint32_t seq;
+    uint32_t drop;
+    uint32_t index;
+
+    if (p_packet->type != PKT_TYPE_EVENT || p_packet->cmd != TELEM_EVT_DATA || p_packet->length < TELEM_HEAD_SIZE)
+      continue;
+
+    memcpy(&seq,  &p_packet->data[0], 4);
+    memcpy(&drop, &p_packet->data[4], 4);
+
+    // seq 가 건너뛰면 그 사이 패킷이 빠진 것이다.
+    //
+    if (is_seq == true && seq != seq_next)
+    {
+      if (seq > seq_next)
+      {
+        printf("[ seq %u ~ %u dropped ]\n", seq_next, seq - 1);
+        seq_lost += seq - seq_next;
+      }
+      else
+      {
+        printf("[ seq %u restart ]\n", seq);
+      }
+    }
+    is_seq   = true;
+    seq_next = seq + 1;
+    rx_packets++;
+
+    if (drop != drop_pre)
+    {
+      if (drop > drop_pre)
+        printf("[ %u samples dropped on device ]\n", drop - drop_pre);
+      drop_pre = drop;
+    }
+
+    index = TELEM_HEAD_SIZE;
+    while(index + TELEM_REC_HEAD <= p_packet->length)
+    {
+      uint8_t  type;
+      uint32_t time_us;
+      uint32_t rec_len;
+
+      type = p_packet->data[index];
+      memcpy(&time_us, &p_packet->data[index + 1], 4);
+
+      switch(type)
+      {
+        case TELEM_TYPE_IMU:
+          rec_len = TELEM_REC_IMU;
+          break;
+
+        case TELEM_TYPE_HDC:
+          rec_len = TELEM_REC_HDC;
+          break;
+
+        case TELEM_TYPE_ADC:
+          rec_len = 1 + 2 * p_packet->data[index + TELEM_REC_HEAD];
+          break;
+
+        default:
+          rec_len = 0;
+          break;
+      }
+      if (rec_len == 0 || index + TELEM_REC_HEAD + rec_len > p_packet->length)
+        break;
+
+      telemWriteRecord(type, time_us, &p_packet->data[index + TELEM_REC_HEAD], rec_len);
+      rx_records[type]++;
+      index += TELEM_REC_HEAD + rec_len;
+    }
+  }
+}
+
+void telemDeInit(void)
+{
+  telem_config_t config;
+
+  if (is_init)
+  {
+    memset(&config, 0, sizeof(config));
+    telemSendConfig(&config, 100);
+    cmdClose(&cmd);
+    is_init = false;
+
+    printf("\n");
+    printf("packets    : %u\n", rx_packets);
+    printf("lost       : %u\n", seq_lost);
+    printf("drop       : %u\n", drop_pre);
+  }
+  if (fp != NULL)
+  {
+    fclose(fp);
+    fp = NULL;
+  }
+}
+
+// 스트림 중에는 이벤트 패킷이 섞여 오므로 설정 응답이 올 때까지 기다린다.
+//
+bool telemSendConfig(telem_config_t *p_config, uint32_t timeout)
+{
+  uint32_t pre_time;
+
+
+  cmdSendCmd(&cmd, TELEM_CMD_CONFIG, (uint8_t *)p_config, sizeof(telem_config_t));
+
+  pre_time = millis();
+  while(millis()-pre_time < timeout)
+  {
+    if (cmdReceivePacket(&cmd) != true)
+      continue;
+
+    if (cmd.packet.type == PKT_TYPE_RESP && cmd.packet.cmd == TELEM_CMD_CONFIG)
+    {
+      if (cmd.packet.err_code != CMD_OK)
+        return false;
+
+      if (cmd.packet.length >= sizeof(telem_config_t))
+        memcpy(p_config, cmd.packet.data, sizeof(telem_config_t));
+      return true;
+    }
+  }
+  cmd.packet.err_code = ERR_CMD_RX_TIMEOUT;
+
+  return false;
+}
+
+void telemWriteRecord(uint8_t type, uint32_t time_us, uint8_t *p_data, uint32_t length)
+{
+  int16_t  data[9];
+  uint16_t adc_data;
+
+
+  switch(type)
+  {
+    case TELEM_TYPE_IMU:
+      // ax,ay,az,gx,gy,gz (raw), roll,pitch,yaw (x100)
+      memcpy(data, p_data, TELEM_REC_IMU);
+      fprintf(fp, "imu,%u", time_us);
+      for (int i=0; i<9; i++)
+        fprintf(fp, ",%d", data[i]);
+      fprintf(fp, "\n");
+      break;
+
+    case TELEM_TYPE_HDC:
+      // temp, humidity (x100)
+      memcpy(data, p_data, TELEM_REC_HDC);
+      fprintf(fp, "hdc,%u,%d,%d\n", time_us, data[0], data[1]);
+      break;
+
+    case TELEM_TYPE_ADC:
+      fprintf(fp, "adc,%u", time_us);
+      for (int i=0; i<p_data[0]; i++)
+      {
+        memcpy(&adc_data, &p_data[1 + i*2], 2);
+        fprintf(fp, ",%u", adc_data);
+      }
+      fprintf(fp, "\n");
+      break;
+  }
+}
+
+void telemShowStat(void)
+{
+  static uint32_t pre_packets = 0;
+  static uint32_t pre_records[4] = {0, };
+
+  printf("pkt %4u/s  imu %4u/s  hdc %3u/s  adc %4u/s  lost %u  drop %u\n",
+         rx_packets - pre_packets,
+         rx_records[TELEM_TYPE_IMU] - pre_records[TELEM_TYPE_IMU],
+         rx_records[TELEM_TYPE_HDC] - pre_records[TELEM_TYPE_HDC],
+         rx_records[TELEM_TYPE_ADC] - pre_records[TELEM_TYPE_ADC],
+         seq_lost,
+         drop_pre);
+
+  pre_packets = rx_packets;
+  memcpy(pre_records, rx_records, sizeof(pre_records));
+  fflush(fp);
+}
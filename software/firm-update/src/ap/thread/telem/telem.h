@@ -0,0 +1,13 @@
+#ifndef TELEM_H_
+#define TELEM_H_
+
+#include "ap_def.h"
+
+
+
+
+
+void telemMain(arg_option_t *args);
+void telemDeInit(void);
+
+#endif
@@ -0,0 +1,293 @@
+#include "lcd.h"
+#include "lcd/ssd1306.h"
+#include "lcd/lcd_fonts.h"
+#include "hangul/han.h"
+#include <stdlib.h>
+
+
+//-- lcdPrintf 글자 캐시, 구간 그리기 검증과 비용 측정
+//
+//   이전 lcdPrintf(글자마다 hanFontLoad 로 조합하고 lcdDrawPixel 로 점을 찍음)를
+//   기준으로 같은 문자열을 임의 위치에 그려서 16bit 프레임 버퍼를 비교한다.
+//   화면 밖으로 걸친 위치와 캐시 항목보다 많은 글자 종류를 포함한다.
+//
+#define CHECK_CNT         5000
+#define BENCH_CNT         20000
+
+
+static void refPrintf(int x, int y, uint16_t color, const char *p_str);
+static void refHanFont(int x, int y, han_font_t *FontPtr, uint16_t textcolor);
+static void refEngFont(int x, int y, char ch, lcd_font_t *font, uint16_t textcolor);
+static void testCheckPrint(LcdFont font, const char **p_lines, int line_cnt);
+static void testBench(const char *p_name, const char **p_lines, int line_cnt);
+
+static lcd_font_t *font_tbl[LCD_FONT_MAX] = { &font_07x10, &font_11x18, &font_16x26, &font_hangul};
+static uint16_t    ref_buf[LCD_WIDTH * LCD_HEIGHT];
+
+// 첫 두 줄이 128x32 한 화면, 네 줄은 39 종류로 캐시 32 개를 넘는다.
+static const char *str_tbl[] =
+{
+  "[LCD 테스트] 12 fps",
+  "IP 192.168.0.10",
+  "온도 23.5C 습도 41%",
+  "연결 안됨 Getting_IP..",
+};
+
+// 영문 폰트는 ASCII 만 그린다.
+static const char *eng_tbl[] =
+{
+  "[LCD TEST] 12 fps",
+  "IP 192.168.0.10",
+  "Temp 23.5C Humi 41%",
+  "Getting_IP.. ~{|}",
+};
+
+static void (*p_frame_func)(void) = NULL;
+
+
+
+
+
+int main(void)
+{
+  lcdInit();
+
+  testCheckPrint(LCD_FONT_HAN,   str_tbl, 4);
+  testCheckPrint(LCD_FONT_07x10, eng_tbl, 4);
+  testCheckPrint(LCD_FONT_11x18, eng_tbl, 4);
+  testCheckPrint(LCD_FONT_16x26, eng_tbl, 4);
+
+  printf("\n");
+  printf("                        ref(us/frame)  cache(us/frame)\n");
+  lcdSetFont(LCD_FONT_HAN);
+  testBench("2 lines, 1 screen ", str_tbl, 2);
+  testBench("4 lines, 39 glyphs", str_tbl, 4);
+  lcdSetFont(LCD_FONT_07x10);
+  testBench("4 lines, 07x10    ", eng_tbl, 4);
+  printf("\n");
+
+  return testResult("glyph");
+}
+
+// 이전 lcdPrintf 와 같은 방식
+//
+void refPrintf(int x, int y, uint16_t color, const char *p_str)
+{
+  char print_buffer[256];
+  int32_t len;
+  int Size_Char;
+  int i, x_Pre = x;
+  han_font_t FontBuf;
+  uint8_t font_width;
+  uint8_t font_height;
+  lcd_font_t *p_font = font_tbl[lcdGetFont()];
+
+
+  len = snprintf(print_buffer, 255, "%s", p_str);
+
+  if (p_font->data != NULL)
+  {
+    for( i=0; i<len; i+=Size_Char )
+    {
+      refEngFont(x, y, print_buffer[i], p_font, color);
+
+      Size_Char = 1;
+      font_width = p_font->width;
+      font_height = p_font->height;
+      x += font_width;
+
+      if ((x+font_width) > HW_LCD_WIDTH)
+      {
+        x  = x_Pre;
+        y += font_height;
+      }
+    }
+  }
+  else
+  {
+    for( i=0; i<len; i+=Size_Char )
+    {
+      hanFontLoad( &print_buffer[i], &FontBuf );
+
+      refHanFont( x, y, &FontBuf, color);
+
+      Size_Char = FontBuf.Size_Char;
+      if (Size_Char >= 2)
+      {
+        font_width = 16;
+        x += 2*8;
+      }
+      else
+      {
+        font_width = 8;
+        x += 1*8;
+      }
+
+      if ((x+font_width) > HW_LCD_WIDTH)
+      {
+        x  = x_Pre;
+        y += 16;
+      }
+
+      if( FontBuf.Code_Type == PHAN_END_CODE ) break;
+    }
+  }
+}
+
+void refHanFont(int x, int y, han_font_t *FontPtr, uint16_t textcolor)
+{
+  uint16_t i, j, Loop;
+  uint16_t FontSize = FontPtr->Size_Char;
+  uint16_t index_x;
+
+
+  if (FontSize > 2)
+    FontSize = 2;
+
+  for ( i = 0 ; i < 16 ; i++ )
+  {
+    index_x = 0;
+    for ( j = 0 ; j < FontSize ; j++ )
+    {
+      uint8_t font_data;
+
+      font_data = FontPtr->FontBuffer[i*FontSize +j];
+      for( Loop=0; Loop<8; Loop++ )
+      {
+        if( (font_data<<Loop) & (0x80))
+        {
+          lcdDrawPixel(x + index_x, y + i, textcolor);
+        }
+        index_x++;
+      }
+    }
+  }
+}
+
+void refEngFont(int x, int y, char ch, lcd_font_t *font, uint16_t textcolor)
+{
+  uint32_t i, b, j;
+
+
+  for (i = 0; i < font->height; i++)
+  {
+    b = font->data[(ch - 32) * font->height + i];
+    for (j = 0; j < font->width; j++)
+    {
+      if ((b << j) & 0x8000)
+      {
+        lcdDrawPixel(x + j, (y + i), textcolor);
+      }
+    }
+  }
+}
+
+// 위치는 화면 양쪽 밖까지 걸치게 하고, 문자열을 섞어서 캐시 교체가 일어나게 한다.
+//
+void testCheckPrint(LcdFont font, const char **p_lines, int line_cnt)
+{
+  uint16_t *p_buf = lcdGetFrameBuffer();
+  uint32_t  miss_cnt = 0;
+
+
+  srand(1);
+  lcdSetFont(font);
+
+  for (int t=0; t<CHECK_CNT; t++)
+  {
+    const char *p_str = p_lines[rand() % line_cnt];
+    int x = rand() % 160 - 24;
+    int y = rand() % 64 - 20;
+    uint16_t color = rand() | 1;
+
+    lcdClearBuffer(black);
+    refPrintf(x, y, color, p_str);
+    memcpy(ref_buf, p_buf, sizeof(ref_buf));
+
+    lcdClearBuffer(black);
+    lcdPrintf(x, y, color, "%s", p_str);
+    if (memcmp(ref_buf, p_buf, sizeof(ref_buf)) != 0)
+      miss_cnt++;
+  }
+
+  printf("font %d : %d prints, %d mismatch\n", font, CHECK_CNT, miss_cnt);
+  TEST_CHECK(miss_cnt == 0);
+}
+
+void testBench(const char *p_name, const char **p_lines, int line_cnt)
+{
+  uint64_t pre_ns;
+  double   ref_us;
+  double   new_us;
+
+
+  pre_ns = benchNs();
+  for (int n=0; n<BENCH_CNT; n++)
+    for (int i=0; i<line_cnt; i++)
+      refPrintf(0, (i%2)*16, white, p_lines[i]);
+  ref_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+  pre_ns = benchNs();
+  for (int n=0; n<BENCH_CNT; n++)
+    for (int i=0; i<line_cnt; i++)
+      lcdPrintf(0, (i%2)*16, white, "%s", p_lines[i]);
+  new_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+  printf("%s  %13.2f  %15.2f\n", p_name, ref_us, new_us);
+}
+
+
+//-- ssd1306 대신 전송 즉시 완료하는 드라이버
+//
+static bool testDrvInit(void)
+{
+  return true;
+}
+
+static void testDrvSetWindow(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+}
+
+static uint16_t testDrvGetWidth(void)
+{
+  return LCD_WIDTH;
+}
+
+static uint16_t testDrvGetHeight(void)
+{
+  return LCD_HEIGHT;
+}
+
+static bool testDrvSetCallBack(void (*p_func)(void))
+{
+  p_frame_func = p_func;
+  return true;
+}
+
+static bool testDrvSendBuffer(uint8_t *p_data, uint32_t length, uint32_t timeout_ms)
+{
+  if (p_frame_func != NULL)
+    p_frame_func();
+  return true;
+}
+
+bool ssd1306Init(void)
+{
+  return true;
+}
+
+bool ssd1306InitDriver(lcd_driver_t *p_driver)
+{
+  p_driver->init        = testDrvInit;
+  p_driver->reset       = testDrvInit;
+  p_driver->setWindow   = testDrvSetWindow;
+  p_driver->getWidth    = testDrvGetWidth;
+  p_driver->getHeight   = testDrvGetHeight;
+  p_driver->setCallBack = testDrvSetCallBack;
+  p_driver->sendBuffer  = testDrvSendBuffer;
+  return true;
+}
+
+void gpioPinWrite(uint8_t ch, uint8_t value)
+{
+}
@@ -0,0 +1,89 @@
+//-- 이전 float Madgwick 필터를 실수형만 바꿔서 쓰기 위한 템플릿
+//
+//   포함하기 전에 정의한다.
+//     REF_T                  : float, double
+//     REF_NAME(x)            : 함수/타입 이름
+//     REF_INV_SQRT(x)        : 1/sqrt(x)
+//
+//   gyro 는 dps, acc 는 크기와 상관없고, 각도는 degree 이다.
+//
+
+
+typedef struct
+{
+  REF_T q[4];
+  REF_T beta;
+} REF_NAME(t);
+
+
+static void REF_NAME(init)(REF_NAME(t) *p_ref)
+{
+  p_ref->q[0] = 1;
+  p_ref->q[1] = 0;
+  p_ref->q[2] = 0;
+  p_ref->q[3] = 0;
+  p_ref->beta = (REF_T)0.1;
+}
+
+static void REF_NAME(update)(REF_NAME(t) *p_ref, REF_T gx, REF_T gy, REF_T gz, REF_T ax, REF_T ay, REF_T az, REF_T dt)
+{
+  REF_T q0 = p_ref->q[0];
+  REF_T q1 = p_ref->q[1];
+  REF_T q2 = p_ref->q[2];
+  REF_T q3 = p_ref->q[3];
+  REF_T recip_norm;
+  REF_T s0, s1, s2, s3;
+  REF_T q_dot1, q_dot2, q_dot3, q_dot4;
+
+
+  gx *= (REF_T)0.0174533;
+  gy *= (REF_T)0.0174533;
+  gz *= (REF_T)0.0174533;
+
+  q_dot1 = (REF_T)0.5 * (-q1 * gx - q2 * gy - q3 * gz);
+  q_dot2 = (REF_T)0.5 * ( q0 * gx + q2 * gz - q3 * gy);
+  q_dot3 = (REF_T)0.5 * ( q0 * gy - q1 * gz + q3 * gx);
+  q_dot4 = (REF_T)0.5 * ( q0 * gz + q1 * gy - q2 * gx);
+
+  if (!(ax == 0 && ay == 0 && az == 0))
+  {
+    recip_norm = REF_INV_SQRT(ax * ax + ay * ay + az * az);
+    ax *= recip_norm;
+    ay *= recip_norm;
+    az *= recip_norm;
+
+    s0 = 4*q0*q2*q2 + 2*q2*ax + 4*q0*q1*q1 - 2*q1*ay;
+    s1 = 4*q1*q3*q3 - 2*q3*ax + 4*q0*q0*q1 - 2*q0*ay - 4*q1 + 8*q1*q1*q1 + 8*q1*q2*q2 + 4*q1*az;
+    s2 = 4*q0*q0*q2 + 2*q0*ax + 4*q2*q3*q3 - 2*q3*ay - 4*q2 + 8*q2*q1*q1 + 8*q2*q2*q2 + 4*q2*az;
+    s3 = 4*q1*q1*q3 - 2*q1*ax + 4*q2*q2*q3 - 2*q2*ay;
+    recip_norm = REF_INV_SQRT(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+
+    q_dot1 -= p_ref->beta * s0 * recip_norm;
+    q_dot2 -= p_ref->beta * s1 * recip_norm;
+    q_dot3 -= p_ref->beta * s2 * recip_norm;
+    q_dot4 -= p_ref->beta * s3 * recip_norm;
+  }
+
+  q0 += q_dot1 * dt;
+  q1 += q_dot2 * dt;
+  q2 += q_dot3 * dt;
+  q3 += q_dot4 * dt;
+
+  recip_norm = REF_INV_SQRT(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+  p_ref->q[0] = q0 * recip_norm;
+  p_ref->q[1] = q1 * recip_norm;
+  p_ref->q[2] = q2 * recip_norm;
+  p_ref->q[3] = q3 * recip_norm;
+}
+
+static inline void REF_NAME(angles)(REF_NAME(t) *p_ref, double deg[3])
+{
+  REF_T q0 = p_ref->q[0];
+  REF_T q1 = p_ref->q[1];
+  REF_T q2 = p_ref->q[2];
+  REF_T q3 = p_ref->q[3];
+
+  deg[0] = atan2(q0 * q1 + q2 * q3, 0.5 - q1 * q1 - q2 * q2) * 57.29578;
+  deg[1] = asin(-2.0 * (q1 * q3 - q0 * q2)) * 57.29578;
+  deg[2] = atan2(q1 * q2 + q0 * q3, 0.5 - q2 * q2 - q3 * q3) * 57.29578;
+}
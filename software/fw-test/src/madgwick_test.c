@@ -0,0 +1,175 @@
+#include "imu/madgwick.h"
+#include <math.h>
+#include <stdlib.h>
+
+
+//-- 고정소수점 Madgwick 필터 정확도 확인
+//
+//   회전하면서 중력 방향이 바뀌는 신호에 잡음과 가끔 0 인 가속도를 넣고
+//   같은 입력을 double 필터와 이전 float 필터에도 넣어서 자세 차이를 본다.
+//   PC 의 시간은 soft-float 인 Cortex-M3 와 관계가 없으므로 재지 않는다.
+//   (타겟에서 "imu bench")
+//
+#define STEP_CNT          200000
+#define STEP_US           (1000000 / HW_IMU_ODR_HZ)
+#define GYRO_RES          (2000.0 / 32768.0)
+#define ACC_RES           (2.0 / 32768.0)
+
+#define QUAT_ERR_MAX      0.1         // degree, double 필터 대비
+#define ANGLE_ERR_MAX     0.2         // degree, |pitch| < 80
+
+
+#define REF_T             float
+#define REF_NAME(x)       ref_f_##x
+#define REF_INV_SQRT(x)   refInvSqrtF(x)
+static float refInvSqrtF(float x);
+#include "madgwick_ref.h"
+#undef  REF_T
+#undef  REF_NAME
+#undef  REF_INV_SQRT
+
+#define REF_T             double
+#define REF_NAME(x)       ref_d_##x
+#define REF_INV_SQRT(x)   (1.0 / sqrt(x))
+#include "madgwick_ref.h"
+
+
+static double quatAngle(const double a[4], const double b[4]);
+static double angleDiff(double a, double b);
+
+
+
+
+
+int main(void)
+{
+  ref_f_t ref_f;
+  ref_d_t ref_d;
+  madgwick_info_t info;
+  int16_t  gyro[3];
+  int16_t  acc[3];
+  int32_t  gyro_q16[3];
+  int32_t  acc_in[3];
+  uint32_t dt_us;
+  double   t = 0;
+  double   q_fix[4];
+  double   q_f[4];
+  double   q_d[4];
+  double   deg_fix[3];
+  double   deg_d[3];
+  double   err_fix = 0;
+  double   err_f = 0;
+  double   err_angle[3] = {0, };
+
+
+  srand(1);
+  madgwickInit();
+  ref_f_init(&ref_f);
+  ref_d_init(&ref_d);
+
+  for (int n=0; n<STEP_CNT; n++)
+  {
+    t += STEP_US / 1e6;
+
+    // 200~300dps 회전, 가속도 잡음, 5000 번마다 가속도 0
+    gyro[0] = 200 * sin(t * 0.7)     / GYRO_RES;
+    gyro[1] = 150 * sin(t * 1.3 + 1) / GYRO_RES;
+    gyro[2] = 300 * sin(t * 0.4 + 2) / GYRO_RES;
+    acc[0]  = 16384 * sin(t * 0.5)       + rand() % 200 - 100;
+    acc[1]  = 16384 * 0.5 * cos(t * 0.3) + rand() % 200 - 100;
+    acc[2]  = 16384 * cos(t * 0.5)       + rand() % 200 - 100;
+    if (n % 5000 == 0)
+      acc[0] = acc[1] = acc[2] = 0;
+    dt_us = STEP_US + rand() % 200 - 100;
+
+    for (int i=0; i<3; i++)
+    {
+      gyro_q16[i] = (gyro[i] * IMU_GYRO_RAD_Q24) >> 8;
+      acc_in[i]   = acc[i];
+    }
+    madgwickUpdate(gyro_q16, acc_in, dt_us);
+
+    ref_f_update(&ref_f, gyro[0] * GYRO_RES, gyro[1] * GYRO_RES, gyro[2] * GYRO_RES,
+                 acc[0] * ACC_RES, acc[1] * ACC_RES, acc[2] * ACC_RES, dt_us / 1e6);
+    ref_d_update(&ref_d, gyro[0] * GYRO_RES, gyro[1] * GYRO_RES, gyro[2] * GYRO_RES,
+                 acc[0] * ACC_RES, acc[1] * ACC_RES, acc[2] * ACC_RES, dt_us / 1e6);
+
+    madgwickGetInfo(&info);
+    for (int i=0; i<4; i++)
+    {
+      q_fix[i] = (double)info.quat[i] / (1 << MADGWICK_Q);
+      q_f[i]   = ref_f.q[i];
+      q_d[i]   = ref_d.q[i];
+    }
+    err_fix = fmax(err_fix, quatAngle(q_fix, q_d));
+    err_f   = fmax(err_f,   quatAngle(q_f,   q_d));
+
+    // pitch 가 ±90 근처이면 roll/yaw 가 정해지지 않으므로 제외한다.
+    ref_d_angles(&ref_d, deg_d);
+    deg_fix[0] = (double)info.deg_roll  / (1 << MADGWICK_DEG_Q);
+    deg_fix[1] = (double)info.deg_pitch / (1 << MADGWICK_DEG_Q);
+    deg_fix[2] = (double)info.deg_yaw   / (1 << MADGWICK_DEG_Q);
+    if (fabs(deg_d[1]) < 80)
+    {
+      for (int i=0; i<3; i++)
+        err_angle[i] = fmax(err_angle[i], angleDiff(deg_fix[i], deg_d[i]));
+    }
+  }
+
+  printf("%d steps, max attitude error vs double\n", STEP_CNT);
+  printf("  fixed  : %.4f deg\n", err_fix);
+  printf("  float  : %.4f deg\n", err_f);
+  printf("  angles : roll %.4f pitch %.4f yaw %.4f deg (|pitch| < 80)\n", err_angle[0], err_angle[1], err_angle[2]);
+
+  TEST_CHECK(err_fix < QUAT_ERR_MAX);
+  for (int i=0; i<3; i++)
+  {
+    TEST_CHECK(err_angle[i] < ANGLE_ERR_MAX);
+  }
+
+  // dt 0 은 다시 정규화하면서 생기는 LSB 차이 외에는 자세를 바꾸지 않는다. ("imu bench" 가 사용)
+  {
+    madgwick_info_t pre_info;
+
+    madgwickGetInfo(&pre_info);
+    madgwickUpdate(gyro_q16, acc_in, 0);
+    madgwickGetInfo(&info);
+    for (int i=0; i<4; i++)
+      TEST_CHECK(abs(info.quat[i] - pre_info.quat[i]) <= 2);
+  }
+
+  return testResult("madgwick");
+}
+
+// 이전 필터가 쓰던 fast inverse square root
+float refInvSqrtF(float x)
+{
+  float   half_x = 0.5f * x;
+  float   y = x;
+  int32_t i;
+
+  memcpy(&i, &y, 4);
+  i = 0x5f3759df - (i >> 1);
+  memcpy(&y, &i, 4);
+  y = y * (1.5f - (half_x * y * y));
+  y = y * (1.5f - (half_x * y * y));
+  return y;
+}
+
+double quatAngle(const double a[4], const double b[4])
+{
+  double dot = fabs(a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3]);
+
+  if (dot > 1)
+    dot = 1;
+  return 2 * acos(dot) * 180 / M_PI;
+}
+
+double angleDiff(double a, double b)
+{
+  double d = a - b;
+
+  while (d >  180) d -= 360;
+  while (d < -180) d += 360;
+  return fabs(d);
+}
@@ -0,0 +1,214 @@
+#include "mixer.h"
+#include <stdlib.h>
+
+
+//-- mixer 블록 믹싱 검증과 mixerRead 비용 측정
+//
+//   채널 링버퍼에 임의 길이로 쓰고 읽으면서 채널별 합 * Q15 gain 을 한번 포화한
+//   기준값과 비교한다. 벤치마크는 이전 방식(샘플마다 채널을 읽어
+//   mixerSamples 로 합치고 volume / 100)과 비교한다.
+//
+#define CHECK_ROUND     2000
+#define REF_BUF_LEN     8192
+#define BENCH_LEN       256
+#define BENCH_ROUND     20000
+
+
+static void    testCheckMix(void);
+static void    testBench(uint32_t ch_cnt);
+static int16_t refBufRead(mixer_t *p_mixer, uint8_t ch);
+static void    refRead(mixer_t *p_mixer, int16_t *p_data, uint32_t length);
+
+static mixer_t mixer;
+static mixer_t mixer_ref;
+
+
+
+
+
+int main(void)
+{
+  testCheckMix();
+
+  printf("\n");
+  printf("channels  block(ns/sample)  ref(ns/sample)\n");
+  for (uint32_t ch_cnt=1; ch_cnt<=MIXER_MAX_CH; ch_cnt++)
+  {
+    testBench(ch_cnt);
+  }
+  printf("\n");
+
+  return testResult("mixer");
+}
+
+// 이전 mixerBufRead, mixerRead 와 같은 방식
+//
+int16_t refBufRead(mixer_t *p_mixer, uint8_t ch)
+{
+  int16_t ret = 0;
+  uint32_t index;
+  uint32_t next_index;
+
+
+  index      = p_mixer->buf[ch].out;
+  next_index = p_mixer->buf[ch].out + 1;
+
+  if (next_index == p_mixer->buf[ch].length)
+  {
+    next_index = 0;
+  }
+
+  if (index != p_mixer->buf[ch].in)
+  {
+    ret = p_mixer->buf[ch].buf[index];
+    p_mixer->buf[ch].out = next_index;
+  }
+
+  return ret;
+}
+
+void refRead(mixer_t *p_mixer, int16_t *p_data, uint32_t length)
+{
+  int16_t mixer_out;
+  int16_t sample;
+
+
+  for (int i=0; i<length; i++)
+  {
+    mixer_out = refBufRead(p_mixer, 0);
+    for (int ch=1; ch<MIXER_MAX_CH; ch++)
+    {
+      sample = refBufRead(p_mixer, ch);
+      mixer_out = mixerSamples(mixer_out, sample);
+    }
+
+    p_data[i] = mixer_out * p_mixer->volume / 100;
+  }
+}
+
+// 볼륨, 쓰기/읽기 길이를 임의로 바꿔서 링버퍼 끝이 여러 위치에서 나뉘게 한다.
+// 비어있는 채널은 0 으로 더해져야 한다.
+//
+void testCheckMix(void)
+{
+  static int16_t ref_buf[MIXER_MAX_CH][REF_BUF_LEN];
+  uint32_t ref_in[MIXER_MAX_CH]  = {0, };
+  uint32_t ref_out[MIXER_MAX_CH] = {0, };
+  int16_t  data[300];
+  int16_t  out[300];
+  uint32_t err_cnt = 0;
+  uint32_t sample_cnt = 0;
+  int32_t  volume;
+  int32_t  acc;
+  int64_t  value;
+
+
+  srand(1);
+  mixerInit(&mixer);
+
+  for (int r=0; r<CHECK_ROUND; r++)
+  {
+    volume = rand() % 101;
+    mixerSetVolume(&mixer, volume);
+
+    for (int ch=0; ch<MIXER_MAX_CH; ch++)
+    {
+      uint32_t length = rand() % 200;
+
+      if (length > mixerAvailableForWrite(&mixer, ch))
+        length = mixerAvailableForWrite(&mixer, ch);
+
+      for (int i=0; i<length; i++)
+      {
+        data[i] = (rand() % 65536) - 32768;
+        ref_buf[ch][ref_in[ch]++ % REF_BUF_LEN] = data[i];
+      }
+      mixerWrite(&mixer, ch, data, length);
+    }
+
+    uint32_t length = rand() % 300;
+
+    mixerRead(&mixer, out, length);
+    for (int i=0; i<length; i++)
+    {
+      acc = 0;
+      for (int ch=0; ch<MIXER_MAX_CH; ch++)
+      {
+        if (ref_out[ch] < ref_in[ch])
+          acc += ref_buf[ch][ref_out[ch]++ % REF_BUF_LEN];
+      }
+      value = ((int64_t)acc * ((volume << 15) / 100)) >> 15;
+      value = constrain(value, INT16_MIN, INT16_MAX);
+
+      if (out[i] != value)
+        err_cnt++;
+      sample_cnt++;
+    }
+  }
+
+  printf("mix check : %d rounds, %d samples, %d mismatch\n", CHECK_ROUND, sample_cnt, err_cnt);
+  TEST_CHECK(err_cnt == 0);
+  TEST_CHECK(sample_cnt > 0);
+
+  // 볼륨 0 은 무음, 100 은 곱셈 없이 합만 포화한다.
+  mixerInit(&mixer);
+  data[0] = 30000;
+  data[1] = -30000;
+  mixerWrite(&mixer, 0, data, 2);
+  mixerWrite(&mixer, 1, data, 2);
+  mixerRead(&mixer, out, 3);
+  TEST_CHECK(out[0] == INT16_MAX);
+  TEST_CHECK(out[1] == INT16_MIN);
+  TEST_CHECK(out[2] == 0);
+
+  mixerSetVolume(&mixer, 0);
+  mixerWrite(&mixer, 0, data, 2);
+  mixerRead(&mixer, out, 2);
+  TEST_CHECK(out[0] == 0 && out[1] == 0);
+}
+
+void testBench(uint32_t ch_cnt)
+{
+  static int16_t data[MIXER_MAX_BUF_LEN];
+  int16_t  out[BENCH_LEN];
+  uint64_t pre_ns;
+  uint64_t block_ns = 0;
+  uint64_t ref_ns = 0;
+  int32_t  check = 0;
+
+
+  for (int i=0; i<MIXER_MAX_BUF_LEN; i++)
+  {
+    data[i] = (rand() % 65536) - 32768;
+  }
+
+  mixerInit(&mixer);
+  mixerInit(&mixer_ref);
+  mixerSetVolume(&mixer, 80);
+  mixerSetVolume(&mixer_ref, 80);
+
+  for (int r=0; r<BENCH_ROUND; r++)
+  {
+    for (int ch=0; ch<ch_cnt; ch++)
+    {
+      mixerWrite(&mixer, ch, data, BENCH_LEN);
+      mixerWrite(&mixer_ref, ch, data, BENCH_LEN);
+    }
+
+    pre_ns = benchNs();
+    mixerRead(&mixer, out, BENCH_LEN);
+    block_ns += benchNs() - pre_ns;
+    check += out[r % BENCH_LEN];
+
+    pre_ns = benchNs();
+    refRead(&mixer_ref, out, BENCH_LEN);
+    ref_ns += benchNs() - pre_ns;
+    check += out[r % BENCH_LEN];
+  }
+
+  printf("%8d  %16.2f  %14.2f  (%d)\n",
+         ch_cnt,
+         (double)block_ns / (BENCH_ROUND * BENCH_LEN),
+         (double)ref_ns / (BENCH_ROUND * BENCH_LEN),
+         check & 0xFF);
+}
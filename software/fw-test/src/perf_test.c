@@ -0,0 +1,109 @@
+#include "perf.h"
+#include "mixer.h"
+
+
+//-- PERF_SCOPE 가 PC 에서 clock_gettime 으로 측정되고 히스토그램에 쌓이는지 확인
+//
+//   펌웨어의 mixerRead 범위와 시간을 알고 있는 테스트 범위를 같이 본다.
+//   PC 에서는 cycle 대신 ns 가 쌓인다.
+//
+#define SCOPE_CNT         100
+#define SCOPE_WAIT_NS     20000
+
+
+static void     testScopeWait(void);
+static perf_t  *testFind(const char *p_name);
+static void     testCheckPerf(perf_t *p_perf, uint32_t count);
+
+static mixer_t mixer;
+
+
+
+
+
+int main(void)
+{
+  int16_t data[64] = {0, };
+  perf_t *p_perf;
+
+
+  perfInit();
+  mixerInit(&mixer);
+
+  for (int i=0; i<SCOPE_CNT; i++)
+  {
+    mixerWrite(&mixer, 0, data, 64);
+    mixerRead(&mixer, data, 64);
+    testScopeWait();
+  }
+
+  p_perf = testFind("mixerRead");
+  TEST_CHECK(p_perf != NULL);
+  testCheckPerf(p_perf, SCOPE_CNT);
+
+  // 기다린 시간보다 짧게 잴 수 없고, 그 값이 들어갈 구간이 가장 낮은 구간이다.
+  p_perf = testFind("testScopeWait");
+  TEST_CHECK(p_perf != NULL);
+  testCheckPerf(p_perf, SCOPE_CNT);
+  if (p_perf != NULL)
+  {
+    int first_bin = -1;
+
+    for (int i=0; i<PERF_BIN_MAX && first_bin < 0; i++)
+    {
+      if (p_perf->bin[i] > 0)
+        first_bin = i;
+    }
+    TEST_CHECK(p_perf->min >= SCOPE_WAIT_NS);
+    TEST_CHECK(perfGetBinCycle(first_bin) > SCOPE_WAIT_NS);
+  }
+
+  perfClear();
+  p_perf = testFind("mixerRead");
+  TEST_CHECK(p_perf != NULL && p_perf->count == 0 && p_perf->bin[0] == 0);
+
+  return testResult("perf");
+}
+
+void testScopeWait(void)
+{
+  PERF_SCOPE("testScopeWait");
+  uint64_t pre_ns = benchNs();
+
+  while(benchNs() - pre_ns < SCOPE_WAIT_NS);
+}
+
+perf_t *testFind(const char *p_name)
+{
+  for (perf_t *p_perf = perfGetList(); p_perf != NULL; p_perf = p_perf->next)
+  {
+    if (strcmp(p_perf->name, p_name) == 0)
+      return p_perf;
+  }
+  return NULL;
+}
+
+void testCheckPerf(perf_t *p_perf, uint32_t count)
+{
+  uint32_t bin_sum = 0;
+
+
+  if (p_perf == NULL)
+    return;
+
+  for (int i=0; i<PERF_BIN_MAX; i++)
+  {
+    bin_sum += p_perf->bin[i];
+  }
+
+  printf("%-16s count %d, min %d ns, avg %d ns, max %d ns\n",
+         p_perf->name,
+         p_perf->count,
+         p_perf->min,
+         (uint32_t)(p_perf->sum / cmax(p_perf->count, 1)),
+         p_perf->max);
+
+  TEST_CHECK(p_perf->count == count);
+  TEST_CHECK(bin_sum == count);
+  TEST_CHECK(p_perf->min <= p_perf->max);
+}
@@ -0,0 +1,318 @@
+#include "hw_def.h"
+#include "resize.h"
+#include <stdlib.h>
+
+
+//-- Q16 resize 커널 검증과 비용 측정
+//
+//   이전 float 방식의 bilinear, nearest 를 기준으로 같은 크기에서 결과를 비교한다.
+//   PC 는 FPU 가 있어서 float 기준이 타겟(soft-float)보다 유리하게 나온다.
+//
+#define CHECK_RGB_CNT     2000
+#define CHECK_GRAY_CNT    500
+#define CHECK_NEAR_CNT    500
+#define BENCH_CNT         20000
+#define GLYPH_SIZE        16
+#define GLYPH_LINE        8         // lcdPrintfResize 한 줄의 글자 수
+
+
+static void refResize(resize_image_t *src, resize_image_t *dest);
+static void refGray(resize_image_t *src, resize_image_t *dest);
+static void refNearest(resize_image_t *src, resize_image_t *dest);
+static void testCheckRgb(void);
+static void testCheckGray(void);
+static void testCheckNearest(void);
+static void testBench(void);
+
+static uint16_t src_buf[64*64];
+static uint16_t ref_buf[128*128];
+static uint16_t out_buf[128*128];
+
+
+
+
+
+int main(void)
+{
+  srand(1);
+
+  testCheckRgb();
+  testCheckGray();
+  testCheckNearest();
+  testBench();
+
+  return testResult("resize");
+}
+
+// 이전 resizeImage (float, stride 는 w)
+//
+void refResize(resize_image_t *src, resize_image_t *dest)
+{
+  float step_w = (float)(src->w-1)/(float)(dest->w-1);
+  float step_h = (float)(src->h-1)/(float)(dest->h-1);
+  float ci, cj;
+  float xoff, yoff;
+  int   x1, y1, x2, y2;
+  uint16_t *line1, *line2;
+  uint16_t c[4];
+  unsigned rgb[3];
+
+
+  cj = 0;
+  for (int j=0; j<dest->h; j++)
+  {
+    y1 = cj;
+    y2 = y1 < src->h-1 ? y1+1 : src->h-1;
+    yoff = cj-y1;
+    line1 = &src->p_data[y1*src->w];
+    line2 = &src->p_data[y2*src->w];
+
+    ci = 0;
+    for (int i=0; i<dest->w; i++)
+    {
+      x1 = ci;
+      x2 = x1 < src->w-1 ? x1+1 : src->w-1;
+      xoff = ci-x1;
+      c[0] = line1[x1];
+      c[1] = line1[x2];
+      c[2] = line2[x1];
+      c[3] = line2[x2];
+
+      for (int k=0; k<3; k++)
+      {
+        int shift = k == 0 ? 11 : (k == 1 ? 5 : 0);
+        int mask  = k == 1 ? 0x3F : 0x1F;
+        float v1 = ((c[0]>>shift)&mask)*(1-xoff) + ((c[1]>>shift)&mask)*xoff;
+        float v2 = ((c[2]>>shift)&mask)*(1-xoff) + ((c[3]>>shift)&mask)*xoff;
+
+        rgb[k] = v1*(1-yoff) + v2*yoff;
+      }
+      dest->p_data[j*dest->w + i] = (rgb[0]<<11) | (rgb[1]<<5) | rgb[2];
+      ci += step_w;
+    }
+    cj += step_h;
+  }
+}
+
+// 가장자리를 넘지 않는 float bilinear (8bit gray)
+//
+void refGray(resize_image_t *src, resize_image_t *dest)
+{
+  float step_w = dest->w > 1 ? (float)(src->w-1)/(dest->w-1) : 0;
+  float step_h = dest->h > 1 ? (float)(src->h-1)/(dest->h-1) : 0;
+
+
+  for (int j=0; j<dest->h; j++)
+  {
+    float cj = j*step_h;
+    int   y1 = cj;
+    int   y2 = y1 < src->h-1 ? y1+1 : src->h-1;
+    float yo = cj-y1;
+
+    for (int i=0; i<dest->w; i++)
+    {
+      float ci = i*step_w;
+      int   x1 = ci;
+      int   x2 = x1 < src->w-1 ? x1+1 : src->w-1;
+      float xo = ci-x1;
+      float v1 = src->p_data[y1*src->stride+x1]*(1-xo) + src->p_data[y1*src->stride+x2]*xo;
+      float v2 = src->p_data[y2*src->stride+x1]*(1-xo) + src->p_data[y2*src->stride+x2]*xo;
+
+      dest->p_data[j*dest->stride+i] = (unsigned)(v1*(1-yo) + v2*yo);
+    }
+  }
+}
+
+// 이전 resizeImageNearest
+//
+void refNearest(resize_image_t *src, resize_image_t *dest)
+{
+  int x_ratio = (int)((src->w<<16)/dest->w) +1;
+  int y_ratio = (int)((src->h<<16)/dest->h) +1;
+  int stride_src = src->stride > 0 ? src->stride : src->w;
+  int stride_dst = dest->stride > 0 ? dest->stride : dest->w;
+
+
+  for (int i=0; i<dest->h; i++)
+  {
+    for (int j=0; j<dest->w; j++)
+    {
+      int x2 = ((j*x_ratio)>>16);
+      int y2 = ((i*y_ratio)>>16);
+
+      dest->p_data[((i+dest->y)*stride_dst)+j+dest->x] = src->p_data[(y2*stride_src)+x2];
+    }
+  }
+}
+
+// RGB565 는 채널마다 1 LSB 까지 차이를 허용한다.
+//
+void testCheckRgb(void)
+{
+  uint32_t err_max = 0;
+  uint32_t pixel_cnt = 0;
+  uint32_t err;
+
+
+  for (int t=0; t<CHECK_RGB_CNT; t++)
+  {
+    int sw = 2 + rand()%40;
+    int sh = 2 + rand()%40;
+    int dw = 2 + rand()%120;
+    int dh = 2 + rand()%120;
+
+    for (int i=0; i<sw*sh; i++)
+      src_buf[i] = rand();
+
+    resize_image_t src = {sw, sh, 0, 0, 0, src_buf};
+    resize_image_t ref = {dw, dh, 0, 0, 0, ref_buf};
+    resize_image_t out = {dw, dh, 0, 0, 0, out_buf};
+
+    refResize(&src, &ref);
+    resizeImage(&src, &out);
+
+    for (int i=0; i<dw*dh; i++)
+    {
+      err = abs((ref_buf[i]>>11) - (out_buf[i]>>11));
+      err_max = cmax(err_max, err);
+      err = abs(((ref_buf[i]>>5)&0x3F) - ((out_buf[i]>>5)&0x3F));
+      err_max = cmax(err_max, err);
+      err = abs((ref_buf[i]&0x1F) - (out_buf[i]&0x1F));
+      err_max = cmax(err_max, err);
+    }
+    pixel_cnt += dw*dh;
+  }
+
+  printf("rgb bilinear : %d sizes, %d px, max err %d LSB\n", CHECK_RGB_CNT, pixel_cnt, err_max);
+  TEST_CHECK(err_max <= 1);
+}
+
+// 16x16 글자를 여러 크기로 늘리고 줄여서 float 기준과 비교한다.
+//
+void testCheckGray(void)
+{
+  uint32_t err_max = 0;
+  uint32_t err;
+
+
+  for (int t=0; t<CHECK_GRAY_CNT; t++)
+  {
+    int dw = 1 + rand()%64;
+
+    for (int i=0; i<GLYPH_SIZE*GLYPH_SIZE; i++)
+      src_buf[i] = (rand() & 1) ? 0xFF : 0;
+
+    resize_image_t src = {GLYPH_SIZE, GLYPH_SIZE, 0, 0, GLYPH_SIZE, src_buf};
+    resize_image_t ref = {dw, dw, 0, 0, 64, ref_buf};
+    resize_image_t out = {dw, dw, 0, 0, 64, out_buf};
+
+    refGray(&src, &ref);
+    resizeImageFastGray(&src, &out);
+
+    for (int y=0; y<dw; y++)
+    {
+      for (int x=0; x<dw; x++)
+      {
+        err = abs(ref_buf[y*64+x] - out_buf[y*64+x]);
+        err_max = cmax(err_max, err);
+      }
+    }
+  }
+
+  printf("gray bilinear: %d sizes, max err %d\n", CHECK_GRAY_CNT, err_max);
+  TEST_CHECK(err_max <= 1);
+}
+
+void testCheckNearest(void)
+{
+  uint32_t miss_cnt = 0;
+
+
+  for (int t=0; t<CHECK_NEAR_CNT; t++)
+  {
+    int sw = 1 + rand()%64;
+    int sh = 1 + rand()%64;
+    int dw = 1 + rand()%128;
+    int dh = 1 + rand()%128;
+
+    for (int i=0; i<sw*sh; i++)
+      src_buf[i] = rand();
+
+    resize_image_t src = {sw, sh, 0, 0, 0, src_buf};
+    resize_image_t ref = {dw, dh, 0, 0, 0, ref_buf};
+    resize_image_t out = {dw, dh, 0, 0, 0, out_buf};
+
+    refNearest(&src, &ref);
+    resizeImageNearest(&src, &out);
+    if (memcmp(ref_buf, out_buf, dw*dh*2) != 0)
+      miss_cnt++;
+  }
+
+  printf("nearest      : %d sizes, %d mismatch\n", CHECK_NEAR_CNT, miss_cnt);
+  TEST_CHECK(miss_cnt == 0);
+}
+
+void testBench(void)
+{
+  uint64_t pre_ns;
+  double   ref_us;
+  double   new_us;
+
+
+  for (int i=0; i<64*64; i++)
+    src_buf[i] = rand();
+
+  printf("\n");
+  printf("                               ref(us)    q16(us)\n");
+
+  {
+    resize_image_t src = {64, 32, 0, 0, 0, src_buf};
+    resize_image_t dst = {128, 64, 0, 0, 0, out_buf};
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT/10; n++)
+      refResize(&src, &dst);
+    ref_us = (benchNs() - pre_ns) / 1000.0 / (BENCH_CNT/10);
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT/10; n++)
+      resizeImage(&src, &dst);
+    new_us = (benchNs() - pre_ns) / 1000.0 / (BENCH_CNT/10);
+
+    printf("rgb 64x32 -> 128x64 bilinear  %8.2f  %9.2f\n", ref_us, new_us);
+  }
+
+  {
+    resize_image_t src = {GLYPH_SIZE, GLYPH_SIZE, 0, 0, GLYPH_SIZE, src_buf};
+    resize_image_t dst = {24, 24, 0, 0, 64, out_buf};
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT; n++)
+      for (int k=0; k<GLYPH_LINE; k++)
+        refGray(&src, &dst);
+    ref_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT; n++)
+      for (int k=0; k<GLYPH_LINE; k++)
+        resizeImageFastGray(&src, &dst);
+    new_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+    printf("8 glyphs 16x16 -> 24x24 gray  %8.2f  %9.2f\n", ref_us, new_us);
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT; n++)
+      for (int k=0; k<GLYPH_LINE; k++)
+        refNearest(&src, &dst);
+    ref_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+    pre_ns = benchNs();
+    for (int n=0; n<BENCH_CNT; n++)
+      for (int k=0; k<GLYPH_LINE; k++)
+        resizeImageNearest(&src, &dst);
+    new_us = (benchNs() - pre_ns) / 1000.0 / BENCH_CNT;
+
+    printf("8 glyphs 16x16 -> 24x24 near  %8.2f  %9.2f\n", ref_us, new_us);
+  }
+  printf("\n");
+}
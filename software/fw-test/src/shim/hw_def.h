@@ -0,0 +1,39 @@
+#ifndef HW_DEF_H_
+#define HW_DEF_H_
+
+
+//-- PC 에서 펌웨어 드라이버를 빌드하기 위한 hw_def.h
+//   필요한 모듈만 켜고 Cortex-M 내장 함수는 shim.h 에서 대신한다.
+//
+#include "def.h"
+#include "shim.h"
+
+
+// 짧은 구간을 비교하는 벤치마크는 FW_TEST_NO_PERF 로 측정 비용을 뺀다.
+#ifndef FW_TEST_NO_PERF
+#define _USE_HW_PERF
+#endif
+#define      HW_PERF_BIN_MAX        16
+#define      HW_PERF_BIN_SHIFT      6
+#define      HW_PERF_HOST           1     // cycle 대신 clock_gettime 의 ns
+
+#define _USE_HW_SWTIMER
+#define      HW_SWTIMER_MAX_CH      16
+
+#define _USE_HW_MIXER
+#define      HW_MIXER_MAX_CH        4
+#define      HW_MIXER_MAX_BUF_LEN   (48*2*4*4)
+
+#define      HW_IMU_ODR_HZ          200   // madgwick_test 의 샘플 간격, 펌웨어와 같게 둔다.
+
+#define _USE_HW_GPIO                      // 백라이트 핀, 테스트에서 대신한다.
+
+#define _USE_HW_LCD
+#define _USE_HW_SSD1306                   // lcdInit 이 사용, 드라이버는 테스트에서 대신한다.
+#define      HW_LCD_WIDTH           128
+#define      HW_LCD_HEIGHT          32
+#define      HW_LCD_MONO            0     // 16bit 프레임 버퍼에 그려서 비교한다.
+#define      HW_LCD_GLYPH_CACHE_MAX 32
+
+
+#endif
@@ -0,0 +1,80 @@
+#include "hw_def.h"
+#include <time.h>
+
+
+static uint32_t primask   = 0;
+static uint32_t fail_cnt  = 0;
+static uint32_t check_cnt = 0;
+
+
+
+
+uint32_t __get_PRIMASK(void)
+{
+  return primask;
+}
+
+void __set_PRIMASK(uint32_t value)
+{
+  primask = value;
+}
+
+void __disable_irq(void)
+{
+  primask = 1;
+}
+
+void __enable_irq(void)
+{
+  primask = 0;
+}
+
+uint64_t benchNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint32_t millis(void)
+{
+  return (uint32_t)(benchNs() / 1000000);
+}
+
+uint32_t micros(void)
+{
+  return (uint32_t)(benchNs() / 1000);
+}
+
+void delay(uint32_t ms)
+{
+  uint32_t pre_time = millis();
+
+  while(millis()-pre_time < ms);
+}
+
+void logPrintf(const char *fmt, ...)
+{
+  va_list args;
+
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+}
+
+void testCheck(bool cond, const char *p_name, int line)
+{
+  check_cnt++;
+  if (cond != true)
+  {
+    fail_cnt++;
+    printf("  FAIL line %d : %s\n", line, p_name);
+  }
+}
+
+int testResult(const char *p_name)
+{
+  printf("[%s] %s : %d checks, %d fail\n", fail_cnt == 0 ? "OK":"NG", p_name, check_cnt, fail_cnt);
+  return fail_cnt == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#ifndef SHIM_H_
+#define SHIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+//-- CMSIS 내장 함수
+//
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t primask);
+void     __disable_irq(void);
+void     __enable_irq(void);
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+  return value == 0 ? 32 : (uint8_t)__builtin_clz(value);
+}
+
+static inline int32_t __SSAT(int32_t value, uint32_t sat)
+{
+  int32_t max = (1 << (sat - 1)) - 1;
+  int32_t min = -(1 << (sat - 1));
+
+  if (value > max) return max;
+  if (value < min) return min;
+  return value;
+}
+
+
+//-- bsp
+//
+uint32_t millis(void);
+uint32_t micros(void);
+void     delay(uint32_t ms);
+void     logPrintf(const char *fmt, ...);
+
+
+//-- 테스트
+//
+uint64_t benchNs(void);
+void     testCheck(bool cond, const char *p_name, int line);
+int      testResult(const char *p_name);
+
+#define TEST_CHECK(cond)    testCheck((cond), #cond, __LINE__)
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
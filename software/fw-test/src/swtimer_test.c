@@ -0,0 +1,178 @@
+#include "swtimer.h"
+
+
+//-- swtimer delta list 검증과 tick 비용 측정
+//
+//   같은 타이머 구성으로 이전 방식(모든 타이머를 매 tick 감소)과 비교한다.
+//   PC 시간이므로 절대값보다 타이머 개수에 따른 변화를 본다.
+//
+#define TICK_CHECK      10000
+#define TICK_BENCH      2000000
+
+
+typedef struct
+{
+  bool          timer_en;
+  SwtimerMode_t timer_mode;
+  uint32_t      timer_cnt;
+  uint32_t      timer_init;
+  void (*tmr_func)(void *);
+  void *tmr_func_arg;
+} ref_timer_t;
+
+
+static void testFunc(void *arg);
+static void refISR(uint32_t count);
+static void testCheckExpire(void);
+static void testBench(uint32_t count, uint32_t period_base);
+
+static uint32_t    expire_cnt[_HW_DEF_SW_TIMER_MAX];
+static ref_timer_t ref_tbl[_HW_DEF_SW_TIMER_MAX];
+
+
+
+
+
+int main(void)
+{
+  swtimerInit();
+
+  testCheckExpire();
+
+  printf("\n");
+  printf("timers  period   delta(ns/tick)  ref(ns/tick)\n");
+  for (uint32_t count=1; count<=_HW_DEF_SW_TIMER_MAX; count*=2)
+  {
+    testBench(count, 100);
+  }
+  for (uint32_t count=1; count<=_HW_DEF_SW_TIMER_MAX; count*=2)
+  {
+    testBench(count, 1);
+  }
+  printf("\n");
+
+  return testResult("swtimer");
+}
+
+void testFunc(void *arg)
+{
+  expire_cnt[(intptr_t)arg]++;
+}
+
+void refISR(uint32_t count)
+{
+  for (int i=0; i<count; i++)
+  {
+    if (ref_tbl[i].timer_en == true)
+    {
+      ref_tbl[i].timer_cnt--;
+      if (ref_tbl[i].timer_cnt == 0)
+      {
+        if (ref_tbl[i].timer_mode == ONE_TIME)
+          ref_tbl[i].timer_en = false;
+
+        ref_tbl[i].timer_cnt = ref_tbl[i].timer_init;
+        (*ref_tbl[i].tmr_func)(ref_tbl[i].tmr_func_arg);
+      }
+    }
+  }
+}
+
+// 주기가 겹치는 LOOP/ONE 타이머를 섞어서 만료 횟수를 확인한다.
+//
+void testCheckExpire(void)
+{
+  swtimer_handle_t handle[_HW_DEF_SW_TIMER_MAX];
+  uint32_t period[_HW_DEF_SW_TIMER_MAX];
+
+
+  memset(expire_cnt, 0, sizeof(expire_cnt));
+
+  for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+  {
+    handle[i] = swtimerGetHandle();
+    TEST_CHECK(handle[i] == i);
+
+    period[i] = 1 + (i * 7) % 13;
+    swtimerSet(handle[i], period[i], (i % 4) == 3 ? ONE_TIME:LOOP_TIME, testFunc, (void *)(intptr_t)i);
+    swtimerStart(handle[i]);
+  }
+  TEST_CHECK(swtimerGetHandle() == -1);
+
+  for (int t=0; t<TICK_CHECK; t++)
+  {
+    swtimerISR();
+  }
+
+  for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+  {
+    if ((i % 4) == 3)
+      TEST_CHECK(expire_cnt[i] == 1);
+    else
+      TEST_CHECK(expire_cnt[i] == TICK_CHECK / period[i]);
+  }
+
+  // 중간에 멈춘 타이머는 더 이상 만료되지 않아야 한다.
+  swtimerStop(handle[0]);
+  expire_cnt[0] = 0;
+  for (int t=0; t<100; t++)
+  {
+    swtimerISR();
+  }
+  TEST_CHECK(expire_cnt[0] == 0);
+
+  for (int i=0; i<_HW_DEF_SW_TIMER_MAX; i++)
+  {
+    TEST_CHECK(swtimerReleaseHandle(handle[i]) == true);
+  }
+}
+
+void testBench(uint32_t count, uint32_t period_base)
+{
+  swtimer_handle_t handle[_HW_DEF_SW_TIMER_MAX];
+  uint64_t pre_ns;
+  uint64_t delta_ns;
+  uint64_t ref_ns;
+
+
+  for (int i=0; i<count; i++)
+  {
+    uint32_t period = period_base + i;
+
+    handle[i] = swtimerGetHandle();
+    swtimerSet(handle[i], period, LOOP_TIME, testFunc, (void *)(intptr_t)i);
+    swtimerStart(handle[i]);
+
+    ref_tbl[i].timer_en     = true;
+    ref_tbl[i].timer_mode   = LOOP_TIME;
+    ref_tbl[i].timer_cnt    = period;
+    ref_tbl[i].timer_init   = period;
+    ref_tbl[i].tmr_func     = testFunc;
+    ref_tbl[i].tmr_func_arg = (void *)(intptr_t)i;
+  }
+
+  pre_ns = benchNs();
+  for (int t=0; t<TICK_BENCH; t++)
+  {
+    swtimerISR();
+  }
+  delta_ns = benchNs() - pre_ns;
+
+  pre_ns = benchNs();
+  for (int t=0; t<TICK_BENCH; t++)
+  {
+    refISR(count);
+  }
+  ref_ns = benchNs() - pre_ns;
+
+  printf("%6d  %6d   %14.2f  %12.2f\n",
+         count,
+         period_base,
+         (double)delta_ns / TICK_BENCH,
+         (double)ref_ns / TICK_BENCH);
+
+  for (int i=0; i<count; i++)
+  {
+    swtimerReleaseHandle(handle[i]);
+  }
+}